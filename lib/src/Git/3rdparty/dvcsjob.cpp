@@ -39,7 +39,7 @@ void DvcsJob::clear()
     m_output.clear();
     m_comm = KProcess::SeparateChannels;
     m_directory = QDir::temp();
-    m_isRunning = m_failed = m_wasStarted = false;
+    m_isRunning = m_failed = m_wasStarted = m_cancelled = false;
 }
 
 
@@ -124,9 +124,17 @@ void DvcsJob::start()
     m_process->setOutputChannelMode(m_comm);
     m_process->setProgram(m_command);
     m_process->setEnvironment(QProcess::systemEnvironment());
-    //the started() and error() signals may be delayed! It causes crash with deferred deletion!!!
     m_process->start();
-    m_process->waitForFinished(-1);
+}
+
+bool DvcsJob::waitForFinished(int msecs)
+{
+    if (m_isRunning) {
+        // the finished() and error() signals are delivered from within
+        m_process->waitForFinished(msecs);
+    }
+
+    return !m_isRunning;
 }
 
 void DvcsJob::setCommunicationMode(KProcess::OutputChannelMode m_comm)
@@ -136,7 +144,22 @@ void DvcsJob::setCommunicationMode(KProcess::OutputChannelMode m_comm)
 
 void DvcsJob::cancel()
 {
-    m_process->kill();
+    if (m_isRunning)
+        kill(KJob::EmitResult);
+}
+
+bool DvcsJob::doKill()
+{
+    // we don't want to hear about the dying process, KJob emits the result
+    m_process->disconnect(this);
+    if (m_isRunning) {
+        m_process->kill();
+        m_process->waitForFinished(-1);
+    }
+
+    m_isRunning = false;
+    m_cancelled = true;
+    return true;
 }
 
 void DvcsJob::slotProcessError(QProcess::ProcessError error)
@@ -189,8 +212,10 @@ void DvcsJob::slotProcessExited(int exitCode, QProcess::ExitStatus exitStatus)
 
     m_isRunning = false;
 
-    if (exitStatus != QProcess::NormalExit || exitCode != 0)
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
         slotProcessError(QProcess::UnknownError);
+        return;
+    }
 
     kDebug() << "process has finished with no errors";
     jobIsReady();
@@ -199,7 +224,10 @@ void DvcsJob::slotProcessExited(int exitCode, QProcess::ExitStatus exitStatus)
 void DvcsJob::slotReceivedStdout()
 {
     // accumulate output
-    m_output.append(m_process->readAllStandardOutput());
+    QByteArray chunk = m_process->readAllStandardOutput();
+    m_output.append(chunk);
+
+    emit receivedOutput(this, chunk);
 }
 
 void DvcsJob::slotReceivedStderr()
@@ -215,6 +243,8 @@ void DvcsJob::setCommandArguments(const QStringList &args)
 
 DvcsJob::JobStatus DvcsJob::status() const
 {
+    if (m_cancelled)
+        return JobCancelled;
     if (!m_wasStarted)
         return JobNotStarted;
     if (m_failed)
@@ -230,8 +260,7 @@ void DvcsJob::jobIsReady()
     //emit readyForParsing(this); //let parsers to set status
     emitResult(); //KJob
     //emit resultsReady(this); //VcsJob
-    //reset stases;
-    m_isRunning = m_failed = false;
+    //keep the states, so status() can be checked after the job has finished
 }
 
 KProcess* DvcsJob::getChildproc()
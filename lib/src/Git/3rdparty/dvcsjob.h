@@ -43,6 +43,7 @@
   *
   *     job << "git" << "init";
   *     job->start();
+  *     job->waitForFinished();
   *
   *     QString result;
   *     QString error;
@@ -61,9 +62,9 @@
   *
   * @author Diego [Po]lentino Casella <polentino911@gmail.com>
   *
-  * @note There is no need to cycle until the process has finished, since the main
-  * thread is blocked until start() has finished. For particular implementations,
-  * consider putting the job in a separate KThread and query isRunning().
+  * @note start() does not block. Either connect to result() (and receivedOutput()
+  * if you want to process the output while it arrives) and return to the event
+  * loop, or call waitForFinished() to block until the process has exited.
   */
 class DvcsJob : public KJob
 {
@@ -89,9 +90,18 @@ public:
 
     /**
       * Starts the process with the previously defined arguments.
+      * It returns immediately, result() is emitted once the process has exited.
       */
     void start();
 
+    /**
+      * Blocks until the process has exited or @p msecs milliseconds have passed.
+      * result() will have been emitted when this returns true.
+      * @param msecs The time to wait for, -1 waits forever.
+      * @return True if the job has finished, false if it timed out.
+      */
+    bool waitForFinished(int msecs = -1);
+
     /**
       * Call this method to clean the job, for example before setting a new one.
       */
@@ -173,9 +183,26 @@ public:
 
     /**
       * Cancels the current process.
+      * result() is emitted with KJob::KilledJobError and status() will be
+      * JobCancelled. Does nothing if the job is not running.
       */
     void cancel();
 
+Q_SIGNALS:
+    /**
+      * Emitted whenever the process has written a chunk of data to its standard output.
+      * The chunk is also appended to the accumulated output.
+      * @param job The job that received the data.
+      * @param chunk The data just received.
+      */
+    void receivedOutput(DvcsJob *job, const QByteArray &chunk);
+
+protected:
+    /**
+      * Kills the process, see KJob::kill().
+      */
+    bool doKill();
+
 private Q_SLOTS:
 
     /**
@@ -216,6 +243,7 @@ private:
     bool        m_isRunning;
     bool        m_wasStarted;
     bool        m_failed;
+    bool        m_cancelled;
     QByteArray  m_output;
     KProcess::OutputChannelMode m_comm;
 
@@ -35,6 +35,8 @@ GitRunner::GitRunner()
 	m_lastRepoRoot = new KUrl();
 	m_result = QString();
 	m_isRunning = false;
+	m_isAsynchronous = false;
+	m_pendingJob = 0;
 	m_jobStatus = DvcsJob::JobNotStarted;
 }
 
@@ -42,6 +44,7 @@ GitRunner::~GitRunner()
 {
 	/*if( m_job )
 		delete m_job;*/
+	delete m_pendingJob;
 	delete m_lastRepoRoot;
 }
 
@@ -55,15 +58,41 @@ void GitRunner::initJob(DvcsJob &job)
 void GitRunner::startJob(DvcsJob &job)
 {
 	m_result.clear();
+
+	if (m_isAsynchronous) {
+		delete m_pendingJob;        // It has not been taken
+		m_pendingJob = &job;
+		m_jobStatus = job.status();
+		return;
+	}
+
 	m_isRunning = true;
 	job.start();
+	job.waitForFinished();
 	m_result.append(job.output());  // Save the result
 	m_isRunning = false;
 	m_jobStatus = job.status();     // Save job status
-	job.cancel();                   // Kill the job
 	delete &job;
 }
 
+DvcsJob* GitRunner::takeJob()
+{
+	DvcsJob *job = m_pendingJob;
+	m_pendingJob = 0;
+
+	return job;
+}
+
+bool GitRunner::isAsynchronous() const
+{
+	return m_isAsynchronous;
+}
+
+void GitRunner::setAsynchronous(bool async)
+{
+	m_isAsynchronous = async;
+}
+
 void GitRunner::setCommunicationMode(KProcess::OutputChannelMode comm)
 {
 	m_commMode = comm;
@@ -503,6 +532,17 @@ DvcsJob::JobStatus GitRunner::commits(const QString &branch)
 	return m_jobStatus;
 }
 
+DvcsJob::JobStatus GitRunner::config(const QStringList &options)
+{
+	DvcsJob *job = new DvcsJob();
+	initJob(*job);
+	*job << "config";
+	*job << options;
+
+	startJob(*job);
+	return m_jobStatus;
+}
+
 DvcsJob::JobStatus GitRunner::diff(const QStringList &commits, const QStringList &options, const QStringList &paths)
 {
 	DvcsJob *job = new DvcsJob();
@@ -676,3 +716,14 @@ DvcsJob::JobStatus GitRunner::rm(const QStringList &paths, const QStringList &op
 	startJob(*job);
 	return m_jobStatus;
 }
+
+DvcsJob::JobStatus GitRunner::var(const QString &variable)
+{
+	DvcsJob *job = new DvcsJob();
+	initJob(*job);
+	*job << "var";
+	*job << variable;
+
+	startJob(*job);
+	return m_jobStatus;
+}
@@ -113,6 +113,31 @@ class GitRunner
 		 */
 		bool isRunning();
 
+		/**
+		 * @return True if commands are only prepared instead of being run.
+		 * @see setAsynchronous()
+		 */
+		bool isAsynchronous() const;
+
+		/**
+		 * Sets whether commands are run right away (the default) or only prepared.
+		 * In asynchronous mode every command returns DvcsJob::JobNotStarted and keeps
+		 * its job until you take it with takeJob(). You can then start() it yourself
+		 * or enqueue it in a Git::JobQueue.
+		 * @note Commands interpreting their own output (e.g. isValidDirectory()) need
+		 * the synchronous mode.
+		 * @param async True to only prepare commands.
+		 */
+		void setAsynchronous(bool async);
+
+		/**
+		 * Hands over the job prepared by the last command in asynchronous mode.
+		 * The caller is responsible for it from now on (it will delete itself after
+		 * having emitted its result, see KJob::setAutoDelete()).
+		 * @return The job or 0 if there is none.
+		 */
+		DvcsJob* takeJob();
+
 		/**
 		 * Sets the working directory for our class.
 		 * @param dir A KUrl with the <b>absolute</b> path of the working directory.
@@ -300,6 +325,12 @@ class GitRunner
 		 * @return The status of the performed operation.
 		 */
 		DvcsJob::JobStatus commits(const QString &branch = QString());
+		/**
+		 * Queries or changes the configuration.
+		 * @param options The options and arguments passed to "git config" (e.g. "--get", "core.bare").
+		 * @return The status of the performed operation.
+		 */
+		DvcsJob::JobStatus config(const QStringList &options);
 		DvcsJob::JobStatus diff(const QStringList &commits, const QStringList &options = QStringList(), const QStringList &paths = QStringList());
 		/**
 		 * Get the diff between the given commits.
@@ -314,6 +345,12 @@ class GitRunner
 		DvcsJob::JobStatus revList(const QStringList &options = QStringList(), const QStringList &commits = QStringList(), const QStringList &paths = QStringList());
 		DvcsJob::JobStatus reset(const QStringList &paths, const QStringList &options = QStringList(), const QString &commit = QString());
 		DvcsJob::JobStatus rm(const QStringList &paths, const QStringList &options = QStringList());
+		/**
+		 * Gets a logical Git variable (e.g. "GIT_COMMITTER_IDENT").
+		 * @param variable The name of the variable.
+		 * @return The status of the performed operation.
+		 */
+		DvcsJob::JobStatus var(const QString &variable);
 
 	private:
 
@@ -334,6 +371,8 @@ class GitRunner
 		DvcsJob::JobStatus          m_jobStatus;
 		KProcess::OutputChannelMode m_commMode;
 		volatile bool               m_isRunning;
+		bool                        m_isAsynchronous;
+		DvcsJob                     *m_pendingJob;
 };
 
 #endif
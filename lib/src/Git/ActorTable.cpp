@@ -0,0 +1,150 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ActorTable.h"
+
+#include <QtAlgorithms>
+
+using namespace Git;
+
+
+
+#define Sha1Size  20
+
+
+
+ActorTable::ActorTable(QObject *parent)
+	: QObject(parent)
+	, m_actors()
+	, m_authoredCommits()
+	, m_ids()
+	, m_unsortedCommits()
+{
+}
+
+
+
+const QStringList ActorTable::actors() const
+{
+	return m_actors.toList();
+}
+
+int ActorTable::commitCountBy(int actorId) const
+{
+	if (actorId < 0 || actorId >= m_authoredCommits.size()) {
+		return 0;
+	}
+
+	sortCommitsBy(actorId);
+
+	return m_authoredCommits[actorId].size() / Sha1Size;
+}
+
+QStringList ActorTable::commitsAuthoredBy(int actorId) const
+{
+	if (actorId < 0 || actorId >= m_authoredCommits.size()) {
+		return QStringList();
+	}
+
+	sortCommitsBy(actorId);
+
+	const QByteArray &ids = m_authoredCommits[actorId];
+	QStringList commits;
+	commits.reserve(ids.size() / Sha1Size);
+	for (int i = 0; i < ids.size(); i += Sha1Size) {
+		commits << QString::fromLatin1(QByteArray::fromRawData(ids.constData() + i, Sha1Size).toHex());
+	}
+
+	return commits;
+}
+
+int ActorTable::count() const
+{
+	return m_actors.size();
+}
+
+int ActorTable::idFor(const QString &actor)
+{
+	if (actor.isEmpty()) {
+		return -1;
+	}
+
+	QHash<QString, int>::const_iterator found = m_ids.constFind(actor);
+	if (found != m_ids.constEnd()) {
+		return found.value();
+	}
+
+	int actorId = m_actors.size();
+	m_actors << actor;
+	m_authoredCommits.resize(m_actors.size());
+	m_unsortedCommits.resize(m_actors.size());
+	m_ids.insert(actor, actorId);
+
+	return actorId;
+}
+
+const QString ActorTable::nameFor(int actorId) const
+{
+	if (actorId < 0 || actorId >= m_actors.size()) {
+		return QString();
+	}
+
+	return m_actors[actorId];
+}
+
+void ActorTable::recordAuthorOf(const QString &commitId, int actorId)
+{
+	if (actorId < 0 || actorId >= m_authoredCommits.size() || commitId.isEmpty()) {
+		return;
+	}
+
+	// duplicates are only removed when the commits are asked for
+	m_authoredCommits[actorId] += QByteArray::fromHex(commitId.toLatin1());
+	m_unsortedCommits.setBit(actorId);
+}
+
+void ActorTable::sortCommitsBy(int actorId) const
+{
+	if (!m_unsortedCommits.testBit(actorId)) {
+		return;
+	}
+
+	QByteArray &ids = m_authoredCommits[actorId];
+
+	QVector<QByteArray> sortedIds;
+	sortedIds.reserve(ids.size() / Sha1Size);
+	for (int i = 0; i + Sha1Size <= ids.size(); i += Sha1Size) {
+		sortedIds << QByteArray::fromRawData(ids.constData() + i, Sha1Size);
+	}
+	qSort(sortedIds);
+
+	QByteArray uniqueIds;
+	uniqueIds.reserve(ids.size());
+	for (int i = 0; i < sortedIds.size(); ++i) {
+		if (i == 0 || sortedIds[i] != sortedIds[i-1]) {
+			uniqueIds += sortedIds[i];
+		}
+	}
+
+	// the raw data of sortedIds points into ids
+	sortedIds.clear();
+	ids = uniqueIds;
+	m_unsortedCommits.clearBit(actorId);
+}
+
+#include "ActorTable.moc"
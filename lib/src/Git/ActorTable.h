@@ -0,0 +1,134 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Interns the authors and committers of a repo's commits.
+ */
+
+#ifndef ACTORTABLE_H
+#define ACTORTABLE_H
+
+#include <QObject>
+
+#include <kdemacros.h>
+
+#include <QBitArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+
+
+class ActorTableTest;
+
+namespace Git {
+
+/**
+ * @brief Interns the authors and committers of a repo's commits.
+ *
+ * Every distinct actor string (e.g. "Me <me@some.tld>") is stored only once.
+ * Commits only keep the compact id the table hands out for it.
+ *
+ * The table also remembers which commits an actor has authored, so you can
+ * group commits by their author without loading them again. Only the
+ * binary SHA1s are kept (20 bytes per commit) and they are sorted and
+ * deduplicated when they are asked for.
+ */
+class KDE_EXPORT ActorTable : public QObject
+{
+	Q_OBJECT
+
+	public:
+		explicit ActorTable(QObject *parent = 0);
+
+		/**
+		 * @brief Returns all interned actors in the order of their ids.
+		 */
+		const QStringList actors() const;
+
+		/**
+		 * @brief Returns the number of loaded commits authored by the given actor.
+		 *
+		 * @param actorId The actor's id.
+		 * @return The number of authored commits.
+		 */
+		int commitCountBy(int actorId) const;
+
+		/**
+		 * @brief Returns the ids of all loaded commits authored by the given actor.
+		 *
+		 * @param actorId The actor's id.
+		 * @return The SHA1s of the authored commits.
+		 */
+		QStringList commitsAuthoredBy(int actorId) const;
+
+		/**
+		 * @brief Returns the number of interned actors.
+		 */
+		int count() const;
+
+		/**
+		 * @brief Returns the id for the given actor.
+		 *
+		 * The actor will be interned if it has not been seen before.
+		 *
+		 * @param actor The actor string as found in the commit.
+		 * @return The actor's id or -1 if @a actor is empty.
+		 */
+		int idFor(const QString &actor);
+
+		/**
+		 * @brief Returns the actor string for the given id.
+		 *
+		 * @param actorId The actor's id.
+		 * @return The actor or a null string if @a actorId is unknown.
+		 */
+		const QString nameFor(int actorId) const;
+
+		/**
+		 * @brief Records that @a commitId has been authored by the given actor.
+		 *
+		 * Recording a commit more than once has no effect.
+		 *
+		 * @param actorId The author's id.
+		 * @param commitId The commit's SHA1.
+		 */
+		void recordAuthorOf(const QString &commitId, int actorId);
+
+	private:
+		/**
+		 * @brief Sorts the commits of the given actor and removes duplicates.
+		 */
+		void sortCommitsBy(int actorId) const;
+
+	private:
+		QVector<QString> m_actors;
+		/** The binary SHA1s of the authored commits of each actor one after another. */
+		mutable QVector<QByteArray> m_authoredCommits;
+		QHash<QString, int> m_ids;
+		/** Which actors have commits recorded since they have been sorted. */
+		mutable QBitArray m_unsortedCommits;
+
+		friend class ::ActorTableTest;
+};
+
+}
+
+#endif // ACTORTABLE_H
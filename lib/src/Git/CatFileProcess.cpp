@@ -0,0 +1,199 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CatFileProcess.h"
+
+#include <KDebug>
+
+using namespace Git;
+
+
+
+#define ResponseTimeout  30000
+
+
+
+CatFileProcess::CatFileProcess(const QString &workingDir, QObject *parent)
+	: KProcess(parent)
+	, m_buffer()
+{
+	setWorkingDirectory(workingDir);
+	setOutputChannelMode(KProcess::SeparateChannels);
+	setEnvironment(QProcess::systemEnvironment());
+
+	setProgram("git", QStringList() << "cat-file" << "--batch");
+}
+
+CatFileProcess::~CatFileProcess()
+{
+	if (state() != QProcess::NotRunning) {
+		// Git exits on EOF
+		closeWriteChannel();
+		if (!waitForFinished(1000)) {
+			kill();
+			waitForFinished();
+		}
+	}
+}
+
+
+
+bool CatFileProcess::ensureRunning()
+{
+	if (state() == QProcess::Running) {
+		return true;
+	}
+
+	m_buffer.clear();
+	start();
+
+	if (!waitForStarted()) {
+		kWarning() << "Could not start" << program().join(" ");
+		return false;
+	}
+
+	return true;
+}
+
+bool CatFileProcess::readData(int size, QByteArray &data)
+{
+	while (m_buffer.size() < size) {
+		if (!waitForReadyRead(ResponseTimeout)) {
+			return false;
+		}
+		m_buffer.append(readAllStandardOutput());
+	}
+
+	data = m_buffer.left(size);
+	m_buffer.remove(0, size);
+
+	return true;
+}
+
+bool CatFileProcess::readLine(QByteArray &line)
+{
+	int newline = m_buffer.indexOf('\n');
+	while (newline < 0) {
+		if (!waitForReadyRead(ResponseTimeout)) {
+			return false;
+		}
+
+		int searchFrom = m_buffer.size();
+		m_buffer.append(readAllStandardOutput());
+		newline = m_buffer.indexOf('\n', searchFrom);
+	}
+
+	line = m_buffer.left(newline);
+	m_buffer.remove(0, newline + 1);
+
+	return true;
+}
+
+QByteArray CatFileProcess::readObject(const QString &id, QByteArray *type)
+{
+	if (!ensureRunning()) {
+		return QByteArray();
+	}
+
+	write(id.toLatin1() + '\n');
+
+	QByteArray objectType;
+	QByteArray data;
+	if (!readResponse(objectType, data)) {
+		// we can not tell where the next response starts
+		kill();
+		waitForFinished();
+		return QByteArray();
+	}
+
+	if (type) {
+		*type = objectType;
+	}
+
+	return data;
+}
+
+QList<QByteArray> CatFileProcess::readObjects(const QStringList &ids)
+{
+	QList<QByteArray> objects;
+
+	if (!ensureRunning()) {
+		while (objects.size() < ids.size()) {
+			objects << QByteArray();
+		}
+		return objects;
+	}
+
+	// write all requests before reading the first response
+	// waiting for the responses keeps writing the remaining requests
+	QByteArray requests;
+	foreach (const QString &id, ids) {
+		requests.append(id.toLatin1());
+		requests.append('\n');
+	}
+	write(requests);
+
+	foreach (const QString &id, ids) {
+		QByteArray type;
+		QByteArray data;
+		if (!readResponse(type, data)) {
+			kWarning() << "No response for" << id;
+			kill();
+			waitForFinished();
+			break;
+		}
+
+		objects << data;
+	}
+
+	// the ones without a response are missing, too
+	while (objects.size() < ids.size()) {
+		objects << QByteArray();
+	}
+
+	return objects;
+}
+
+bool CatFileProcess::readResponse(QByteArray &type, QByteArray &data)
+{
+	// "<sha1> <type> <size>\n<data>\n" or "<request> missing\n"
+	QByteArray header;
+	if (!readLine(header)) {
+		return false;
+	}
+
+	QList<QByteArray> fields = header.split(' ');
+	if (fields.size() != 3) {
+		type.clear();
+		data.clear();
+		return true;
+	}
+
+	bool ok;
+	int size = fields[2].toInt(&ok);
+	if (!ok || !readData(size + 1, data)) {
+		return false;
+	}
+	data.chop(1); // the newline after the data
+
+	type = fields[1];
+
+	return true;
+}
+
+#include "CatFileProcess.moc"
@@ -0,0 +1,108 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief A long-lived "git cat-file --batch" process.
+ */
+
+#ifndef CATFILEPROCESS_H
+#define CATFILEPROCESS_H
+
+#include <KProcess>
+
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+
+
+
+class CatFileProcessTest;
+
+namespace Git {
+
+/**
+ * @brief A long-lived "git cat-file --batch" process.
+ *
+ * Use it for reading objects that can not be read natively (e.g. objects in
+ * alternate object databases). Instead of forking Git for every object, the
+ * process is started on the first request and kept running. Requests for
+ * several objects are written at once and the responses are read in the
+ * same order, so they are pipelined.
+ *
+ * If the process dies or does not answer it is started again on the next
+ * request.
+ */
+class KDE_EXPORT CatFileProcess : public KProcess
+{
+	Q_OBJECT
+
+	public:
+		/**
+		 * @brief Prepares reading objects from the repo in @a workingDir.
+		 *
+		 * Git will not be started until the first object is read.
+		 */
+		explicit CatFileProcess(const QString &workingDir, QObject *parent = 0);
+		~CatFileProcess();
+
+		/**
+		 * @brief Reads a single object.
+		 *
+		 * @param id The object's SHA1 (or anything else Git understands).
+		 * @param type The object's type (e.g. "blob") will be stored there if given.
+		 * @return The object's data or a null array if it is missing.
+		 */
+		QByteArray readObject(const QString &id, QByteArray *type = 0);
+
+		/**
+		 * @brief Reads several objects at once.
+		 *
+		 * @param ids The objects' SHA1s.
+		 * @return The objects' data in the same order. Missing objects have null data.
+		 */
+		QList<QByteArray> readObjects(const QStringList &ids);
+
+	private:
+		/**
+		 * @brief Starts Git if it is not running.
+		 */
+		bool ensureRunning();
+		/**
+		 * @brief Reads exactly @a size bytes of the response.
+		 */
+		bool readData(int size, QByteArray &data);
+		/**
+		 * @brief Reads the next line of the response without the newline.
+		 */
+		bool readLine(QByteArray &line);
+		/**
+		 * @brief Reads the response to a single request.
+		 */
+		bool readResponse(QByteArray &type, QByteArray &data);
+
+	private:
+		QByteArray m_buffer;
+
+		friend class ::CatFileProcessTest;
+};
+
+}
+
+#endif // CATFILEPROCESS_H
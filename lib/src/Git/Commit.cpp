@@ -21,10 +21,14 @@
 
 #include "gitrunner.h"
 
+#include "ActorTable.h"
+#include "CommitCache.h"
 #include "ObjectStorage.h"
 #include "Ref.h"
 #include "Repo.h"
+#include "RevisionWalker.h"
 #include "Tree.h"
+#include "TreeDiff.h"
 
 #include <QStringList>
 
@@ -63,11 +67,11 @@ Commit::~Commit()
 
 
 
-const QString& Commit::author()
+const QString Commit::author()
 {
 	lazyLoad();
 
-	return d->author;
+	return repo().actors()->nameFor(d->authorId);
 }
 
 const KDateTime& Commit::authoredAt()
@@ -77,6 +81,13 @@ const KDateTime& Commit::authoredAt()
 	return d->authoredAt;
 }
 
+int Commit::authorId()
+{
+	lazyLoad();
+
+	return d->authorId;
+}
+
 QStringList Commit::childrenOf(const Commit &commit, const QStringList &refs)
 {
 	if (!commit.isValid()) {
@@ -93,6 +104,7 @@ QStringList Commit::childrenOf(const Commit &commit, const QStringList &refs)
 	commits << refs;
 	commits << QString("^%1^@").arg(commit.id().toSha1String());
 
+	// rev-list only prints ids, so there are no paths to be quoted
 	runner.revList(opts, commits);
 
 	QStringList revList = runner.getResult().split("\n");
@@ -133,11 +145,11 @@ QList<Commit> Commit::childrenOn(const QStringList &refs) const
 	return childrenByRefs[refKey];
 }
 
-const QString& Commit::committer()
+const QString Commit::committer()
 {
 	lazyLoad();
 
-	return d->committer;
+	return repo().actors()->nameFor(d->committerId);
 }
 
 const KDateTime& Commit::committedAt()
@@ -147,12 +159,28 @@ const KDateTime& Commit::committedAt()
 	return d->committedAt;
 }
 
+int Commit::committerId()
+{
+	lazyLoad();
+
+	return d->committerId;
+}
+
 const QString Commit::diff() const
 {
-	GitRunner runner;
-	runner.setDirectory(repo().workingDir());
-	runner.commitDiff(id().toSha1String());
-	return runner.getResult();
+	((Commit*)this)->lazyLoad(); // non-const access
+
+	// the first commit is compared with an empty tree
+	QString parentTreeId;
+	if (!d->parentIds.isEmpty()) {
+		parentTreeId = d->parentIds.first().object().toCommit().tree().id().toSha1String();
+	}
+
+	TreeDiff treeDiff(repo(), parentTreeId, d->treeId.toSha1String());
+	treeDiff.detectRenames();
+	treeDiff.setFullIndex(true);
+
+	return treeDiff.unifiedDiff();
 }
 
 void Commit::fillFromString(const QString &raw)
@@ -197,8 +225,10 @@ void Commit::fillFromString(const QString &raw)
 			}
 		}
 	}
-	d->author = author;
+	ActorTable *actors = repo().actors();
+	d->authorId = actors->idFor(author);
 	d->authoredAt = authoredAt;
+	actors->recordAuthorOf(id().toSha1String(), d->authorId);
 
 	QString committer;
 	KDateTime committedAt;
@@ -216,7 +246,7 @@ void Commit::fillFromString(const QString &raw)
 			}
 		}
 	}
-	d->committer = committer;
+	d->committerId = actors->idFor(committer);
 	d->committedAt = committedAt;
 
 	while (!lines.isEmpty() && lines.first().isEmpty()) {
@@ -241,28 +271,18 @@ void Commit::fillFromString(const QString &raw)
 	}
 }
 
-QList<Commit> Commit::allReachableFrom(const Ref &ref)
+bool Commit::findPath(const QString &path, TreeEntry &result)
 {
-	QList<Commit> commits;
-
-	QList<Commit> fringe;
-	fringe << ref.commit();
-
-	while (!fringe.isEmpty()) {
-		// find next commit in list
-		Commit commit = latestIn(fringe);
+	return tree().findPath(path, result);
+}
 
-		// add parents to fringe
-		foreach (Commit parent, commit.parents()) {
-			if (!fringe.contains(parent)) {
-				fringe << commit.parents();
-			}
-		}
+QList<Commit> Commit::allReachableFrom(const Ref &ref)
+{
+	RevisionWalker walker(ref);
 
-		// remove the commit from the fringe
-		fringe.removeOne(commit);
-		// and sort in it in
-		commits << commit;
+	QList<Commit> commits;
+	while (!walker.atEnd()) {
+		commits << walker.next();
 	}
 
 	return commits;
@@ -284,18 +304,6 @@ bool Commit::isMerge()
 	return parents().size() > 1;
 }
 
-Commit Commit::latestIn(const QList<Commit> &commits)
-{
-	Commit latest = commits.first();
-	foreach (Commit commit, commits) {
-		if (commit.committedAt() > latest.committedAt()) {
-			latest = commit;
-		}
-	}
-
-	return latest;
-}
-
 void Commit::lazyLoad()
 {
 	// if commit has already been filled
@@ -303,7 +311,16 @@ void Commit::lazyLoad()
 		return;
 	}
 
+	CommitCache *cache = repo().commitCache();
+	if (cache->fill(*this)) {
+		return;
+	}
+
 	fillFromString(data());
+
+	if (d->treeId.isValid() || !d->message.isEmpty()) {
+		cache->insert(*this);
+	}
 }
 
 const QString& Commit::message()
@@ -313,6 +330,11 @@ const QString& Commit::message()
 	return d->message;
 }
 
+RawObject& Commit::objectAt(const QString &path)
+{
+	return tree().objectAt(path);
+}
+
 Commit& Commit::operator=(const Commit &other)
 {
 	Q_ASSERT(&other != this);
@@ -40,9 +40,11 @@ class CommitPopulationErrorsTest;
 
 namespace Git {
 
+class CommitCache;
 class CommitPrivate;
 class Ref;
 class Tree;
+class TreeEntry;
 
 
 
@@ -90,22 +92,55 @@ class KDE_EXPORT Commit : public RawObject
 
 
 
-		const QString&     author();
+		const QString      author();
 		const KDateTime&   authoredAt();
-		const QString&     committer();
+
+		/**
+		 * @brief Returns the id of the commit's author in the repo's actor table.
+		 *
+		 * @return The author's id or -1 if the commit has no author.
+		 *
+		 * @see Repo::actors()
+		 */
+		int                authorId();
+
+		const QString      committer();
 		const KDateTime&   committedAt();
 
+		/**
+		 * @brief Returns the id of the commit's committer in the repo's actor table.
+		 *
+		 * @return The committer's id or -1 if the commit has no committer.
+		 *
+		 * @see Repo::actors()
+		 */
+		int                committerId();
+
 		/**
 		 * @brief Returns the diff to the parent commit.
 		 *
 		 * @return The diff output.
 		 *
-		 * @note It will only  rpoduce the diff to the first parent.
+		 * @note It will only produce the diff to the first parent.
+		 * The first commit is compared with an empty tree. Renames are
+		 * detected by comparing the files' contents, so this should not be
+		 * called on the GUI thread.
 		 *
-		 * @todo Does fail on the first commit.
+		 * @see TreeDiff
 		 */
 		const QString diff() const;
 
+		/**
+		 * @brief Looks up the entry for a path in the commit's tree.
+		 *
+		 * @param path The entry's path (e.g. "dir/file.txt").
+		 * @param result Is set to the entry if it has been found.
+		 * @return Whether the commit contains @a path.
+		 *
+		 * @see objectAt(), Tree::findPath()
+		 */
+		bool findPath(const QString &path, TreeEntry &result);
+
 		/**
 		 * @brief Find the children of this commit on the given branches.
 		 *
@@ -165,6 +200,16 @@ class KDE_EXPORT Commit : public RawObject
 		 */
 		const QString& message();
 
+		/**
+		 * @brief Returns the object for a path in the commit's tree.
+		 *
+		 * @param path The entry's path (e.g. "dir/file.txt").
+		 * @return The blob or tree at @a path or an invalid object if there is none.
+		 *
+		 * @see findPath(), Tree::objectAt()
+		 */
+		RawObject& objectAt(const QString &path);
+
 		/**
 		 * @brief Returns the first line of the commit message.
 		 *
@@ -190,7 +235,7 @@ class KDE_EXPORT Commit : public RawObject
 		 * @param branch The ref to start from.
 		 * @return Returns all reachable Commits sorted by date.
 		 *
-		 * @see latestIn()
+		 * @see RevisionWalker
 		 */
 		static QList<Commit> allReachableFrom(const Ref &branch);
 
@@ -230,16 +275,6 @@ class KDE_EXPORT Commit : public RawObject
 		 */
 		static QStringList childrenOf(const Commit &commit, const QStringList &refs);
 
-		/**
-		 * @brief Selects the latest Commit form a list of Commits.
-		 *
-		 * @param commits The list of commits.
-		 * @return The latest commit.
-		 *
-		 * @see Commit::committedAt()
-		 */
-		static Commit latestIn(const QList<Commit> &commits);
-
 		/**
 		 * @short Parses zone offsets from string and returns the offset in seconds.
 		 *
@@ -258,6 +293,7 @@ class KDE_EXPORT Commit : public RawObject
 	private:
 		QExplicitlySharedDataPointer<CommitPrivate> d;
 
+	friend class CommitCache;
 	friend class ::CommitListingTest;
 	friend class ::CommitMergeDetectionTest;
 	friend class ::CommitPopulationTest;
@@ -0,0 +1,437 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CommitCache.h"
+
+#include "ActorTable.h"
+#include "Commit.h"
+#include "Commit_p.h"
+#include "Id.h"
+#include "Repo.h"
+
+#include <KDebug>
+#include <KSaveFile>
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QVector>
+#include <QWeakPointer>
+
+using namespace Git;
+
+
+
+#define CacheMagic    "CocoonCommitCache"
+#define CacheVersion  2
+#define MaxFileSize   (32*1024*1024)
+
+
+
+/**
+ * Returns the index of the actor @a index in the actors of a block,
+ * adding it to @a blockActors if needed.
+ */
+static qint32 blockIndexFor(qint32 index, const QStringList &actors, QHash<qint32, qint32> &blockIndexes, QStringList &blockActors)
+{
+	if (index < 0) {
+		return -1;
+	}
+
+	QHash<qint32, qint32>::const_iterator found = blockIndexes.constFind(index);
+	if (found != blockIndexes.constEnd()) {
+		return found.value();
+	}
+
+	qint32 blockIndex = blockActors.size();
+	blockActors << actors[index];
+	blockIndexes.insert(index, blockIndex);
+
+	return blockIndex;
+}
+
+/**
+ * Returns the Id for a packed SHA1 read from the cache.
+ */
+static Id idFor(const QByteArray &sha1, Repo &repo)
+{
+	if (sha1.isEmpty()) {
+		return Id();
+	}
+
+	return Id(QString::fromLatin1(sha1.toHex()), repo);
+}
+
+/**
+ * Returns the packed SHA1 of @a id as it is kept in the cache.
+ */
+static QByteArray packedIdFor(const Id &id)
+{
+	return QByteArray::fromHex(id.toSha1String().toLatin1());
+}
+
+
+
+CommitCache::CommitCache(const QString &gitDir)
+	: m_actors()
+	, m_actorIndexes()
+	, m_fileName(gitDir + "/cocoon/commits")
+	, m_isLoaded(false)
+	, m_maxFileSize(MaxFileSize)
+	, m_mutex()
+	, m_needsRewrite(false)
+	, m_newIds()
+	, m_records()
+{
+}
+
+CommitCache::~CommitCache()
+{
+	save();
+}
+
+
+
+QByteArray CommitCache::blockFor(const QList<QByteArray> &ids) const
+{
+	// every block interns its own actors, so blocks don't depend on each other
+	QStringList blockActors;
+	QHash<qint32, qint32> blockIndexes;
+
+	QByteArray block;
+	QDataStream stream(&block, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+
+	QList<CommitRecord> records;
+	foreach (const QByteArray &id, ids) {
+		CommitRecord record = m_records.value(id);
+		record.authorIndex = blockIndexFor(record.authorIndex, m_actors, blockIndexes, blockActors);
+		record.committerIndex = blockIndexFor(record.committerIndex, m_actors, blockIndexes, blockActors);
+		records << record;
+	}
+
+	stream << blockActors << quint32(records.size());
+
+	for (int i = 0; i < records.size(); ++i) {
+		stream << ids[i]
+			<< records[i].treeId
+			<< records[i].parentIds
+			<< records[i].authorIndex
+			<< records[i].authoredAt
+			<< records[i].committerIndex
+			<< records[i].committedAt
+			<< records[i].message;
+	}
+
+	return block;
+}
+
+int CommitCache::count() const
+{
+	QMutexLocker locker(&m_mutex);
+
+	((CommitCache*)this)->load(); // non-const access
+
+	return m_records.size();
+}
+
+const QString& CommitCache::fileName() const
+{
+	return m_fileName;
+}
+
+bool CommitCache::fill(Commit &commit)
+{
+	QByteArray id = packedIdFor(commit.id());
+	CommitRecord record;
+	QString author;
+	QString committer;
+
+	{
+		QMutexLocker locker(&m_mutex);
+
+		load();
+
+		QHash<QByteArray, CommitRecord>::iterator found = m_records.find(id);
+		if (found == m_records.end()) {
+			return false;
+		}
+
+		found.value().isUsed = true;
+		record = found.value();
+		author = record.authorIndex < 0 ? QString() : m_actors[record.authorIndex];
+		committer = record.committerIndex < 0 ? QString() : m_actors[record.committerIndex];
+	}
+
+	Repo &repo = commit.repo();
+
+	commit.d->treeId = idFor(record.treeId, repo);
+
+	QList<Id> parentIds;
+	foreach (const QByteArray &parentId, record.parentIds) {
+		parentIds << idFor(parentId, repo);
+	}
+	commit.d->parentIds = parentIds;
+
+	// the repo's actor table has its own ids
+	ActorTable *actors = repo.actors();
+	commit.d->authorId = record.authorIndex < 0 ? -1 : actors->idFor(author);
+	commit.d->authoredAt = record.authoredAt;
+	actors->recordAuthorOf(commit.id().toSha1String(), commit.d->authorId);
+	commit.d->committerId = record.committerIndex < 0 ? -1 : actors->idFor(committer);
+	commit.d->committedAt = record.committedAt;
+
+	commit.d->message = record.message;
+	commit.d->summary = record.message.section('\n', 0, 0);
+
+	return true;
+}
+
+QSharedPointer<CommitCache> CommitCache::forGitDir(const QString &gitDir)
+{
+	static QMutex cachesMutex;
+	static QHash<QString, QWeakPointer<CommitCache> > caches;
+
+	QMutexLocker locker(&cachesMutex);
+
+	QSharedPointer<CommitCache> cache = caches.value(gitDir).toStrongRef();
+	if (!cache) {
+		cache = QSharedPointer<CommitCache>(new CommitCache(gitDir));
+		caches.insert(gitDir, cache.toWeakRef());
+	}
+
+	return cache;
+}
+
+qint32 CommitCache::indexOfActor(const QString &actor)
+{
+	if (actor.isEmpty()) {
+		return -1;
+	}
+
+	QHash<QString, qint32>::const_iterator found = m_actorIndexes.constFind(actor);
+	if (found != m_actorIndexes.constEnd()) {
+		return found.value();
+	}
+
+	qint32 index = m_actors.size();
+	m_actors << actor;
+	m_actorIndexes.insert(actor, index);
+
+	return index;
+}
+
+void CommitCache::insert(Commit &commit)
+{
+	QByteArray id = packedIdFor(commit.id());
+	if (id.isEmpty()) {
+		return;
+	}
+
+	ActorTable *actors = commit.repo().actors();
+	QString author = actors->nameFor(commit.d->authorId);
+	QString committer = actors->nameFor(commit.d->committerId);
+
+	QMutexLocker locker(&m_mutex);
+
+	load();
+
+	if (m_records.contains(id)) {
+		return;
+	}
+
+	CommitRecord record;
+	record.treeId = packedIdFor(commit.d->treeId);
+	foreach (const Id &parentId, commit.d->parentIds) {
+		record.parentIds << packedIdFor(parentId);
+	}
+
+	record.authorIndex = indexOfActor(author);
+	record.authoredAt = commit.d->authoredAt;
+	record.committerIndex = indexOfActor(committer);
+	record.committedAt = commit.d->committedAt;
+	record.message = commit.d->message;
+	record.isUsed = true;
+
+	m_records.insert(id, record);
+	m_newIds << id;
+}
+
+bool CommitCache::isDirty() const
+{
+	QMutexLocker locker(&m_mutex);
+
+	return !m_newIds.isEmpty();
+}
+
+void CommitCache::load()
+{
+	if (m_isLoaded) {
+		return;
+	}
+	m_isLoaded = true;
+
+	QFile file(m_fileName);
+	if (!file.open(QFile::ReadOnly)) {
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_4_6);
+
+	QByteArray magic;
+	quint32 version;
+	stream >> magic >> version;
+	if (stream.status() != QDataStream::Ok || magic != CacheMagic || version != CacheVersion) {
+		kDebug() << "Ignoring commit cache of another version:" << m_fileName;
+		m_needsRewrite = true;
+		return;
+	}
+
+	while (!stream.atEnd()) {
+		QStringList actors;
+		quint32 count;
+		stream >> actors >> count;
+
+		QHash<QByteArray, CommitRecord> records;
+		for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+			QByteArray id;
+			CommitRecord record;
+			stream >> id
+				>> record.treeId
+				>> record.parentIds
+				>> record.authorIndex
+				>> record.authoredAt
+				>> record.committerIndex
+				>> record.committedAt
+				>> record.message;
+
+			records.insert(id, record);
+		}
+
+		// e.g. the last block has not been written completely
+		if (stream.status() != QDataStream::Ok) {
+			kWarning() << "Ignoring broken end of commit cache:" << m_fileName;
+			m_needsRewrite = true;
+			break;
+		}
+
+		// every block has its own actors
+		QVector<qint32> actorIndexes(actors.size());
+		for (int i = 0; i < actors.size(); ++i) {
+			actorIndexes[i] = indexOfActor(actors[i]);
+		}
+
+		QHashIterator<QByteArray, CommitRecord> record(records);
+		while (record.hasNext()) {
+			record.next();
+
+			CommitRecord cached = record.value();
+			if (cached.authorIndex >= actors.size() || cached.committerIndex >= actors.size()) {
+				kWarning() << "Ignoring broken cache record for" << record.key().toHex();
+				m_needsRewrite = true;
+				continue;
+			}
+
+			cached.authorIndex = cached.authorIndex < 0 ? -1 : actorIndexes[cached.authorIndex];
+			cached.committerIndex = cached.committerIndex < 0 ? -1 : actorIndexes[cached.committerIndex];
+			cached.isUsed = false;
+
+			m_records.insert(record.key(), cached);
+		}
+	}
+}
+
+qint64 CommitCache::maxFileSize() const
+{
+	return m_maxFileSize;
+}
+
+bool CommitCache::rewrite(bool prune)
+{
+	QList<QByteArray> ids;
+	QMutableHashIterator<QByteArray, CommitRecord> record(m_records);
+	while (record.hasNext()) {
+		record.next();
+
+		if (prune && !record.value().isUsed) {
+			record.remove();
+		} else {
+			ids << record.key();
+		}
+	}
+
+	QDir().mkpath(QFileInfo(m_fileName).path());
+
+	KSaveFile file(m_fileName);
+	if (!file.open()) {
+		kWarning() << "Could not write commit cache:" << m_fileName << file.errorString();
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_4_6);
+
+	stream << QByteArray(CacheMagic) << quint32(CacheVersion);
+	file.write(blockFor(ids));
+
+	if (!file.finalize()) {
+		kWarning() << "Could not write commit cache:" << m_fileName << file.errorString();
+		return false;
+	}
+
+	m_needsRewrite = false;
+	m_newIds.clear();
+
+	return true;
+}
+
+bool CommitCache::save()
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (m_newIds.isEmpty() && !m_needsRewrite) {
+		return true;
+	}
+
+	QFileInfo fileInfo(m_fileName);
+	if (m_needsRewrite || !fileInfo.exists()) {
+		return rewrite(false);
+	} else if (fileInfo.size() > m_maxFileSize) {
+		return rewrite(true);
+	}
+
+	QFile file(m_fileName);
+	if (!file.open(QFile::WriteOnly | QFile::Append)) {
+		kWarning() << "Could not write commit cache:" << m_fileName << file.errorString();
+		return false;
+	}
+
+	// written at once, so an interrupted save only breaks the last block
+	QByteArray block = blockFor(m_newIds);
+	if (file.write(block) != block.size()) {
+		kWarning() << "Could not write commit cache:" << m_fileName << file.errorString();
+		return false;
+	}
+
+	m_newIds.clear();
+
+	return true;
+}
@@ -0,0 +1,191 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Keeps parsed commits across sessions.
+ */
+
+#ifndef COMMITCACHE_H
+#define COMMITCACHE_H
+
+#include <kdemacros.h>
+
+#include <KDateTime>
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+
+
+
+class CommitCacheTest;
+
+namespace Git {
+
+class Commit;
+
+
+
+/**
+ * @brief The parsed data of a single commit as it is kept in the cache.
+ */
+struct CommitRecord {
+	/** The tree's SHA1 as packed 20 bytes. */
+	QByteArray treeId;
+	/** The parents' SHA1s as packed 20 bytes. */
+	QList<QByteArray> parentIds;
+	/** The author's index in the cache's actors. */
+	qint32 authorIndex;
+	KDateTime authoredAt;
+	/** The committer's index in the cache's actors. */
+	qint32 committerIndex;
+	KDateTime committedAt;
+	QString message;
+	/** Whether the commit has been filled or inserted in this session (see CommitCache::save()). */
+	bool isUsed;
+};
+
+
+
+/**
+ * @brief Keeps parsed commits across sessions.
+ *
+ * Commits never change, so once a commit has been parsed its data can be
+ * kept by its SHA1 forever. The cache is read from the file in the repo's
+ * "cocoon" directory on first use. Commits added later are appended to the
+ * file when the cache is saved, so the records that are already there are
+ * never written again. Reopening a repo thus does not need to inflate and
+ * parse the commits of the history again.
+ *
+ * The file starts with a version number. It is ignored if it has been
+ * written with another version. Every save appends a block with the actors
+ * of its commits (interned just like in the ActorTable) and the commits.
+ *
+ * Once the file has grown beyond maxFileSize() it is rewritten with only
+ * the commits used in this session, so commits that are not looked at any
+ * more are dropped eventually.
+ *
+ * The cache is shared by all repo objects of a repository (e.g. the ones
+ * used for loading the history in the background) and can be used from
+ * several threads.
+ *
+ * @see Repo::commitCache()
+ */
+class KDE_EXPORT CommitCache
+{
+	public:
+		/**
+		 * @brief Returns the cache of the repository in @a gitDir.
+		 *
+		 * It lives as long as any repo object of the repository and is
+		 * saved when the last one is gone.
+		 */
+		static QSharedPointer<CommitCache> forGitDir(const QString &gitDir);
+
+		~CommitCache();
+
+		/**
+		 * @brief Returns the number of cached commits.
+		 */
+		int count() const;
+
+		/**
+		 * @brief Returns the path of the file the cache is kept in.
+		 */
+		const QString& fileName() const;
+
+		/**
+		 * @brief Fills @a commit with the cached data.
+		 *
+		 * @return Whether the commit has been cached.
+		 */
+		bool fill(Commit &commit);
+
+		/**
+		 * @brief Adds the data of the parsed @a commit to the cache.
+		 */
+		void insert(Commit &commit);
+
+		/**
+		 * @brief Checks whether commits have been added since the cache has been saved.
+		 */
+		bool isDirty() const;
+
+		/**
+		 * @brief The size the file may grow to before it is pruned.
+		 */
+		qint64 maxFileSize() const;
+
+		/**
+		 * @brief Writes the added commits to the cache's file.
+		 *
+		 * They are appended to the file. It is only replaced (atomically)
+		 * if it could not be read or if it is larger than maxFileSize().
+		 *
+		 * @return Whether the cache is saved.
+		 */
+		bool save();
+
+	private:
+		explicit CommitCache(const QString &gitDir);
+
+		/**
+		 * @brief Serializes the block of the given commits with their actors.
+		 */
+		QByteArray blockFor(const QList<QByteArray> &ids) const;
+
+		/**
+		 * @brief Returns the index of @a actor in m_actors, adding it if needed.
+		 */
+		qint32 indexOfActor(const QString &actor);
+
+		/**
+		 * @brief Reads the cache file once.
+		 */
+		void load();
+
+		/**
+		 * @brief Replaces the file with the used commits (or all of them).
+		 *
+		 * @param prune Whether to drop the commits not used in this session.
+		 */
+		bool rewrite(bool prune);
+
+	private:
+		QStringList m_actors;
+		QHash<QString, qint32> m_actorIndexes;
+		QString m_fileName;
+		bool m_isLoaded;
+		qint64 m_maxFileSize;
+		mutable QMutex m_mutex;
+		/** Whether the file could not be read and has to be written anew */
+		bool m_needsRewrite;
+		/** The commits inserted since the cache has been saved */
+		QList<QByteArray> m_newIds;
+		QHash<QByteArray, CommitRecord> m_records;
+
+		friend class ::CommitCacheTest;
+};
+
+}
+
+#endif // COMMITCACHE_H
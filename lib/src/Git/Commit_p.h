@@ -37,9 +37,9 @@ class CommitPrivate : public RawObjectPrivate {
 public:
 	CommitPrivate()
 		: RawObjectPrivate()
-		, author()
+		, authorId(-1)
 		, authoredAt()
-		, committer()
+		, committerId(-1)
 		, committedAt()
 		, message()
 		, parentIds()
@@ -48,9 +48,9 @@ public:
 	{}
 	CommitPrivate(const RawObjectPrivate &other)
 		: RawObjectPrivate(other)
-		, author()
+		, authorId(-1)
 		, authoredAt()
-		, committer()
+		, committerId(-1)
 		, committedAt()
 		, message()
 		, parentIds()
@@ -59,9 +59,9 @@ public:
 	{}
 	CommitPrivate(const CommitPrivate &other)
 		: RawObjectPrivate(other)
-		, author(other.author)
+		, authorId(other.authorId)
 		, authoredAt(other.authoredAt)
-		, committer(other.committer)
+		, committerId(other.committerId)
 		, committedAt(other.committedAt)
 		, message(other.message)
 		, parentIds(other.parentIds)
@@ -70,9 +70,9 @@ public:
 	{}
 	~CommitPrivate() {}
 
-	QString   author;
+	int       authorId;
 	KDateTime authoredAt;
-	QString   committer;
+	int       committerId;
 	KDateTime committedAt;
 	QString   message;
 	QList<Id> parentIds;
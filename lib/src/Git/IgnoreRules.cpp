@@ -0,0 +1,391 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IgnoreRules.h"
+
+#include "Repo.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <string.h>
+
+using namespace Git;
+
+
+
+#define IgnoreFileName  ".gitignore"
+
+#define PatternNegated       0x01
+#define PatternMustBeDir     0x02
+#define PatternNoDir         0x04
+#define PatternLiteral       0x08
+#define PatternEndsWith      0x10
+
+#define WildMatch            0
+#define WildNoMatch          1
+#define WildAbortAll         2
+#define WildAbortToStarStar  3
+
+
+
+/**
+ * The matcher is a port of Git's wildmatch() with WM_PATHNAME.
+ */
+static int doWildcardMatch(const uchar *pattern, const uchar *p, const uchar *text)
+{
+	for (; *p; ++text, ++p) {
+		uchar t = *text;
+		uchar c = *p;
+
+		if (t == 0 && c != '*') {
+			return WildAbortAll;
+		}
+
+		switch (c) {
+			case '\\':
+				// literal match with the following character
+				c = *++p;
+				if (t != c) {
+					return WildNoMatch;
+				}
+				continue;
+			case '?':
+				if (t == '/') {
+					return WildNoMatch;
+				}
+				continue;
+			case '*': {
+				bool matchSlash = false;
+				if (*++p == '*') {
+					const uchar *previous = p - 2;
+					while (*++p == '*') {}
+					// "**" only matches directories if it is a whole path component
+					if ((previous < pattern || *previous == '/') && (*p == '\0' || *p == '/' || (p[0] == '\\' && p[1] == '/'))) {
+						if (p[0] == '/' && doWildcardMatch(pattern, p + 1, text) == WildMatch) {
+							return WildMatch;
+						}
+						matchSlash = true;
+					}
+				}
+
+				if (*p == '\0') {
+					// a trailing "*" matches the rest of the component
+					if (!matchSlash && strchr((const char*)text, '/')) {
+						return WildNoMatch;
+					}
+					return WildMatch;
+				} else if (!matchSlash && *p == '/') {
+					const uchar *slash = (const uchar*)strchr((const char*)text, '/');
+					if (!slash) {
+						return WildNoMatch;
+					}
+					text = slash;
+					break;
+				}
+
+				while (true) {
+					if (t == '\0') {
+						break;
+					}
+
+					int matched = doWildcardMatch(pattern, p, text);
+					if (matched != WildNoMatch) {
+						if (!matchSlash || matched != WildAbortToStarStar) {
+							return matched;
+						}
+					} else if (!matchSlash && t == '/') {
+						return WildAbortToStarStar;
+					}
+
+					t = *++text;
+				}
+				return WildAbortAll;
+			}
+			case '[': {
+				uchar patternChar = *++p;
+				if (patternChar == '^') {
+					patternChar = '!';
+				}
+				bool negated = patternChar == '!';
+				if (negated) {
+					patternChar = *++p;
+				}
+
+				uchar previousChar = 0;
+				bool matched = false;
+				do {
+					if (!patternChar) {
+						return WildAbortAll;
+					}
+
+					if (patternChar == '\\') {
+						patternChar = *++p;
+						if (!patternChar) {
+							return WildAbortAll;
+						}
+						if (t == patternChar) {
+							matched = true;
+						}
+					} else if (patternChar == '-' && previousChar && p[1] && p[1] != ']') {
+						patternChar = *++p;
+						if (patternChar == '\\') {
+							patternChar = *++p;
+							if (!patternChar) {
+								return WildAbortAll;
+							}
+						}
+						if (t <= patternChar && t >= previousChar) {
+							matched = true;
+						}
+						patternChar = 0; // a range can not start a new range
+					} else if (t == patternChar) {
+						matched = true;
+					}
+
+					previousChar = patternChar;
+					patternChar = *++p;
+				} while (patternChar != ']');
+
+				if (matched == negated || t == '/') {
+					return WildNoMatch;
+				}
+				continue;
+			}
+			default:
+				if (t != c) {
+					return WildNoMatch;
+				}
+				continue;
+		}
+	}
+
+	return *text ? WildNoMatch : WildMatch;
+}
+
+static bool hasWildcards(const char *pattern)
+{
+	return strpbrk(pattern, "*?[\\") != 0;
+}
+
+/**
+ * Looks up core.excludesFile in a Git config file.
+ */
+static QString excludesFileFrom(const QString &configFilePath)
+{
+	QFile configFile(configFilePath);
+	if (!configFile.open(QFile::ReadOnly)) {
+		return QString();
+	}
+
+	bool inCoreSection = false;
+	while (!configFile.atEnd()) {
+		QByteArray line = configFile.readLine().trimmed();
+		if (line.startsWith('[')) {
+			inCoreSection = line.toLower() == "[core]";
+		} else if (inCoreSection && line.toLower().startsWith("excludesfile")) {
+			int equals = line.indexOf('=');
+			if (equals < 0) {
+				continue;
+			}
+
+			QString path = QFile::decodeName(line.mid(equals + 1).trimmed());
+			if (path.startsWith("~/")) {
+				path = QDir::homePath() + path.mid(1);
+			}
+			return path;
+		}
+	}
+
+	return QString();
+}
+
+
+
+IgnorePattern::IgnorePattern()
+	: m_baseDirectory()
+	, m_flags(0)
+	, m_pattern()
+{
+}
+
+IgnorePattern::IgnorePattern(const QByteArray &line, const QByteArray &baseDirectory)
+	: m_baseDirectory(baseDirectory)
+	, m_flags(0)
+	, m_pattern(line)
+{
+	if (m_pattern.endsWith('\r')) {
+		m_pattern.chop(1);
+	}
+
+	// trailing spaces are ignored unless they are escaped
+	while (m_pattern.endsWith(' ') && !m_pattern.endsWith("\\ ")) {
+		m_pattern.chop(1);
+	}
+
+	if (m_pattern.isEmpty() || m_pattern.startsWith('#')) {
+		m_pattern.clear();
+		return;
+	}
+
+	if (m_pattern.startsWith('!')) {
+		m_flags |= PatternNegated;
+		m_pattern.remove(0, 1);
+	}
+
+	if (m_pattern.endsWith('/')) {
+		m_flags |= PatternMustBeDir;
+		m_pattern.chop(1);
+	}
+
+	if (!m_pattern.contains('/')) {
+		// patterns without a slash match the name at any depth
+		m_flags |= PatternNoDir;
+	} else if (m_pattern.startsWith('/')) {
+		m_pattern.remove(0, 1);
+	}
+
+	if (!hasWildcards(m_pattern.constData())) {
+		m_flags |= PatternLiteral;
+	} else if (m_pattern.startsWith('*') && !hasWildcards(m_pattern.constData() + 1)) {
+		m_flags |= PatternEndsWith;
+	}
+}
+
+bool IgnorePattern::isNegated() const
+{
+	return m_flags & PatternNegated;
+}
+
+bool IgnorePattern::isValid() const
+{
+	return !m_pattern.isEmpty();
+}
+
+bool IgnorePattern::matches(const QByteArray &path, bool isDirectory) const
+{
+	if ((m_flags & PatternMustBeDir) && !isDirectory) {
+		return false;
+	}
+
+	if (m_flags & PatternNoDir) {
+		const char *name = path.constData() + path.lastIndexOf('/') + 1;
+
+		if (m_flags & PatternLiteral) {
+			return qstrcmp(name, m_pattern.constData()) == 0;
+		} else if (m_flags & PatternEndsWith) {
+			int nameSize = path.size() - (name - path.constData());
+			int suffixSize = m_pattern.size() - 1;
+			return nameSize >= suffixSize && memcmp(name + nameSize - suffixSize, m_pattern.constData() + 1, suffixSize) == 0;
+		}
+		return wildcardMatch(m_pattern.constData(), name);
+	}
+
+	// other patterns match relative to the ignore file's directory
+	if (!path.startsWith(m_baseDirectory)) {
+		return false;
+	}
+
+	const char *relativePath = path.constData() + m_baseDirectory.size();
+	if (m_flags & PatternLiteral) {
+		return qstrcmp(relativePath, m_pattern.constData()) == 0;
+	}
+	return wildcardMatch(m_pattern.constData(), relativePath);
+}
+
+bool IgnorePattern::wildcardMatch(const char *pattern, const char *text)
+{
+	return doWildcardMatch((const uchar*)pattern, (const uchar*)pattern, (const uchar*)text) == WildMatch;
+}
+
+
+
+IgnoreRules::IgnoreRules(const Repo &repo)
+	: m_patterns()
+	, m_repoWideFiles()
+	, m_workingDir(repo.workingDir())
+{
+	QString excludesFile = excludesFileFrom(repo.gitDir() + "/config");
+	if (excludesFile.isEmpty()) {
+		excludesFile = excludesFileFrom(QDir::homePath() + "/.gitconfig");
+	}
+	if (excludesFile.isEmpty()) {
+		QString configHome = QFile::decodeName(qgetenv("XDG_CONFIG_HOME"));
+		if (configHome.isEmpty()) {
+			configHome = QDir::homePath() + "/.config";
+		}
+		excludesFile = configHome + "/git/ignore";
+	}
+
+	m_repoWideFiles << excludesFile << repo.gitDir() + "/info/exclude";
+	foreach (const QString &file, m_repoWideFiles) {
+		addPatterns(file, QByteArray());
+	}
+}
+
+
+
+void IgnoreRules::addPatterns(const QString &filePath, const QByteArray &baseDirectory)
+{
+	QVector<IgnorePattern> patterns;
+
+	QFile file(filePath);
+	if (file.open(QFile::ReadOnly)) {
+		foreach (const QByteArray &line, file.readAll().split('\n')) {
+			IgnorePattern pattern(line, baseDirectory);
+			if (pattern.isValid()) {
+				patterns << pattern;
+			}
+		}
+	}
+
+	// empty lists are kept, so leaveDirectory() removes the right one
+	m_patterns << patterns;
+}
+
+void IgnoreRules::enterDirectory(const QByteArray &directory)
+{
+	addPatterns(m_workingDir + '/' + QFile::decodeName(directory) + IgnoreFileName, directory);
+}
+
+bool IgnoreRules::isIgnored(const QByteArray &path, bool isDirectory) const
+{
+	// the last matching pattern of the most specific file decides
+	for (int list = m_patterns.size() - 1; list >= 0; --list) {
+		const QVector<IgnorePattern> &patterns = m_patterns[list];
+		for (int i = patterns.size() - 1; i >= 0; --i) {
+			if (patterns[i].matches(path, isDirectory)) {
+				return !patterns[i].isNegated();
+			}
+		}
+	}
+
+	return false;
+}
+
+void IgnoreRules::leaveDirectory()
+{
+	if (m_patterns.size() > m_repoWideFiles.size()) {
+		m_patterns.pop_back();
+	}
+}
+
+const QStringList& IgnoreRules::repoWideFiles() const
+{
+	return m_repoWideFiles;
+}
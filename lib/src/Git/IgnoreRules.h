@@ -0,0 +1,177 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Decides which files in the working directory are ignored.
+ */
+
+#ifndef IGNORERULES_H
+#define IGNORERULES_H
+
+#include <kdemacros.h>
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+
+
+class IgnoreRulesTest;
+
+namespace Git {
+
+class Repo;
+
+
+
+/**
+ * @brief A single pattern of a .gitignore file.
+ *
+ * It is compiled once when it is read, so that the common cases (plain
+ * names and "*.ext" suffixes) do not need the full wildcard matcher.
+ *
+ * @see gitignore(5)
+ */
+class KDE_EXPORT IgnorePattern
+{
+	public:
+		/**
+		 * @brief Constructs an invalid pattern.
+		 */
+		IgnorePattern();
+
+		/**
+		 * @brief Compiles a line of an ignore file.
+		 *
+		 * @param line The line without the line break.
+		 * @param baseDirectory The directory of the ignore file relative to the
+		 *        working directory ("" for the root, otherwise with a trailing "/").
+		 */
+		explicit IgnorePattern(const QByteArray &line, const QByteArray &baseDirectory = QByteArray());
+
+		/**
+		 * @brief Does the pattern re-include what other patterns ignore (i.e. it starts with "!")?
+		 */
+		bool isNegated() const;
+
+		/**
+		 * @brief Is this a pattern at all?
+		 *
+		 * @return false for blank lines and comments.
+		 */
+		bool isValid() const;
+
+		/**
+		 * @brief Checks whether the pattern matches the given path.
+		 *
+		 * @param path The path relative to the working directory.
+		 * @param isDirectory Whether @a path is a directory.
+		 */
+		bool matches(const QByteArray &path, bool isDirectory) const;
+
+	// static
+		/**
+		 * @brief Matches @a text against the wildcard @a pattern like Git does.
+		 *
+		 * "*", "?" and "[...]" do not match "/". "**" between slashes matches
+		 * any number of directories.
+		 */
+		static bool wildcardMatch(const char *pattern, const char *text);
+
+	private:
+		QByteArray m_baseDirectory;
+		int m_flags;
+		QByteArray m_pattern;
+};
+
+
+
+/**
+ * @brief Decides which files in the working directory are ignored.
+ *
+ * The rules are read from the core.excludesFile, the repo's info/exclude
+ * file and the .gitignore files of the directories. The later ones take
+ * precedence over the earlier ones.
+ *
+ * Directories are entered and left while walking the working directory,
+ * so only the .gitignore files on the current path are kept.
+ *
+ * @code
+ *   IgnoreRules rules(repo);
+ *   rules.enterDirectory("");
+ *   rules.isIgnored("build", true);
+ *   rules.enterDirectory("src/");
+ *   rules.isIgnored("src/main.o", false);
+ *   rules.leaveDirectory();
+ *   rules.leaveDirectory();
+ * @endcode
+ */
+class KDE_EXPORT IgnoreRules
+{
+	public:
+		/**
+		 * @brief Reads the global and repo wide rules of @a repo.
+		 */
+		explicit IgnoreRules(const Repo &repo);
+
+		/**
+		 * @brief Adds the patterns of the directory's .gitignore file.
+		 *
+		 * @param directory The directory relative to the working directory
+		 *        ("" for the root, otherwise with a trailing "/").
+		 */
+		void enterDirectory(const QByteArray &directory);
+
+		/**
+		 * @brief Checks whether @a path is ignored.
+		 *
+		 * All the directories on the path have to be entered.
+		 *
+		 * @param path The path relative to the working directory.
+		 * @param isDirectory Whether @a path is a directory.
+		 */
+		bool isIgnored(const QByteArray &path, bool isDirectory) const;
+
+		/**
+		 * @brief Removes the patterns of the directory entered last.
+		 */
+		void leaveDirectory();
+
+		/**
+		 * @brief Returns the files the global and repo wide rules are read from.
+		 *
+		 * They may not exist.
+		 */
+		const QStringList& repoWideFiles() const;
+
+	private:
+		void addPatterns(const QString &filePath, const QByteArray &baseDirectory);
+
+	private:
+		QVector<QVector<IgnorePattern> > m_patterns;
+		QStringList m_repoWideFiles;
+		QString m_workingDir;
+
+		friend class ::IgnoreRulesTest;
+};
+
+}
+
+#endif // IGNORERULES_H
@@ -0,0 +1,464 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Index.h"
+#include "Index_p.h"
+
+#include "Repo.h"
+
+#include <KDebug>
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <string.h>
+
+using namespace Git;
+
+
+
+#define IndexSignature      "DIRC"
+#define SignatureSize        4
+#define HeaderSize          12
+#define Sha1Size            20
+#define EntryFixedSize      62
+#define ExtendedFlagsSize    2
+#define ExtensionHeaderSize  8
+#define CacheTreeSignature  "TREE"
+
+#define FlagAssumeValid       0x8000
+#define FlagExtended          0x4000
+#define FlagStageMask         0x3000
+#define FlagStageShift        12
+#define ExtFlagSkipWorktree   0x4000
+#define ExtFlagIntentToAdd    0x2000
+
+
+
+static inline quint16 readUInt16(const uchar *data)
+{
+	return (data[0] << 8) | data[1];
+}
+
+static inline quint32 readUInt32(const uchar *data)
+{
+	return (quint32(data[0]) << 24) | (quint32(data[1]) << 16) | (quint32(data[2]) << 8) | quint32(data[3]);
+}
+
+/**
+ * Reads the variable length integers used by index version 4.
+ * It advances @a data past the integer.
+ */
+static inline bool readVarInt(const uchar *&data, const uchar *end, quint64 &value)
+{
+	if (data >= end) {
+		return false;
+	}
+
+	uchar c = *data++;
+	value = c & 0x7f;
+	while (c & 0x80) {
+		if (data >= end) {
+			return false;
+		}
+		c = *data++;
+		value = ((value + 1) << 7) | (c & 0x7f);
+	}
+
+	return true;
+}
+
+
+
+IndexEntry::IndexEntry()
+	: ctimeSeconds(0)
+	, ctimeNanoseconds(0)
+	, mtimeSeconds(0)
+	, mtimeNanoseconds(0)
+	, dev(0)
+	, ino(0)
+	, mode(0)
+	, uid(0)
+	, gid(0)
+	, size(0)
+	, flags(0)
+	, extendedFlags(0)
+	, path()
+{
+	memset(sha1, 0, Sha1Size);
+}
+
+bool IndexEntry::isAssumeValid() const
+{
+	return flags & FlagAssumeValid;
+}
+
+bool IndexEntry::isIntentToAdd() const
+{
+	return extendedFlags & ExtFlagIntentToAdd;
+}
+
+bool IndexEntry::isSkipWorktree() const
+{
+	return extendedFlags & ExtFlagSkipWorktree;
+}
+
+QString IndexEntry::modeString() const
+{
+	return QString::number(mode, 8).rightJustified(6, '0');
+}
+
+QString IndexEntry::sha1String() const
+{
+	for (int i=0; i < Sha1Size; ++i) {
+		if (sha1[i] != 0) {
+			return QString::fromLatin1(QByteArray::fromRawData((const char*)sha1, Sha1Size).toHex());
+		}
+	}
+
+	return QString();
+}
+
+int IndexEntry::stage() const
+{
+	return (flags & FlagStageMask) >> FlagStageShift;
+}
+
+
+
+Index::Index(const Repo &repo, QObject *parent)
+	: QObject(parent)
+	, d(new IndexPrivate)
+{
+	read(repo.gitDir() + "/index");
+}
+
+Index::Index(const QString &indexFilePath, QObject *parent)
+	: QObject(parent)
+	, d(new IndexPrivate)
+{
+	read(indexFilePath);
+}
+
+Index::~Index()
+{
+}
+
+
+
+int Index::cachedTreeEntryCount(const QString &directory) const
+{
+	return d->cachedTrees.value(directory).entryCount;
+}
+
+QString Index::cachedTreeId(const QString &directory) const
+{
+	IndexCachedTree cachedTree = d->cachedTrees.value(directory);
+	if (cachedTree.entryCount < 0) {
+		return QString();
+	}
+
+	return QString::fromLatin1(cachedTree.sha1.toHex());
+}
+
+int Index::comparePaths(const QString &a, const QString &b)
+{
+	const QChar *charA = a.constData();
+	const QChar *charB = b.constData();
+	int length = qMin(a.size(), b.size());
+
+	for (int i=0; i < length; ++i) {
+		ushort unitA = charA[i].unicode();
+		ushort unitB = charB[i].unicode();
+		if (unitA == unitB) {
+			continue;
+		}
+
+		// surrogates encode code points above all others in the BMP
+		bool surrogateA = QChar::isHighSurrogate(unitA) || QChar::isLowSurrogate(unitA);
+		bool surrogateB = QChar::isHighSurrogate(unitB) || QChar::isLowSurrogate(unitB);
+		if (surrogateA != surrogateB) {
+			return surrogateA ? 1 : -1;
+		}
+
+		return unitA < unitB ? -1 : 1;
+	}
+
+	return a.size() - b.size();
+}
+
+const QVector<IndexEntry>& Index::entries() const
+{
+	return d->entries;
+}
+
+int Index::indexOf(const QString &path) const
+{
+	int position = lowerBound(path);
+	if (position < d->entries.size() && d->entries[position].path == path) {
+		return position;
+	}
+
+	return -1;
+}
+
+bool Index::isValid() const
+{
+	return d->valid;
+}
+
+int Index::lowerBound(const QString &path) const
+{
+	int low = 0;
+	int high = d->entries.size();
+
+	// find the first entry not less than path
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if (comparePaths(d->entries[middle].path, path) < 0) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+void Index::read(const QString &indexFilePath)
+{
+	d->filePath = indexFilePath;
+
+	QFile indexFile(indexFilePath);
+	if (!indexFile.open(QFile::ReadOnly)) {
+		kDebug() << "could not open index" << indexFilePath;
+		return;
+	}
+
+	d->timestamp = QFileInfo(indexFile).lastModified().toTime_t();
+
+	qint64 size = indexFile.size();
+	uchar *data = indexFile.map(0, size);
+	if (data) {
+		d->valid = readEntries(data, size);
+		indexFile.unmap(data);
+	} else {
+		QByteArray content = indexFile.readAll();
+		d->valid = readEntries((const uchar*)content.constData(), content.size());
+	}
+	indexFile.close();
+
+	if (!d->valid) {
+		d->cachedTrees.clear();
+		d->entries.clear();
+	}
+}
+
+bool Index::readEntries(const uchar *data, qint64 size)
+{
+	if (size < HeaderSize + Sha1Size || memcmp(data, IndexSignature, SignatureSize) != 0) {
+		kWarning() << "index has an invalid header" << d->filePath;
+		return false;
+	}
+
+	d->version = readUInt32(data + SignatureSize);
+	if (d->version < 2 || d->version > 4) {
+		kWarning() << "index has unsupported version" << d->version << d->filePath;
+		return false;
+	}
+
+	quint32 count = readUInt32(data + SignatureSize + 4);
+
+	// the index ends with the SHA1 of its content
+	const uchar *end = data + size - Sha1Size;
+	const uchar *pos = data + HeaderSize;
+
+	// don't trust the count before we know the entries can be there
+	if (quint64(count) * EntryFixedSize > quint64(end - pos)) {
+		kWarning() << "index is truncated" << d->filePath;
+		return false;
+	}
+
+	d->entries.resize(count);
+	QByteArray previousPath;
+	for (quint32 i=0; i < count; ++i) {
+		if (end - pos < EntryFixedSize) {
+			kWarning() << "index is truncated" << d->filePath;
+			return false;
+		}
+
+		IndexEntry &entry = d->entries[i];
+		entry.ctimeSeconds     = readUInt32(pos);
+		entry.ctimeNanoseconds = readUInt32(pos +  4);
+		entry.mtimeSeconds     = readUInt32(pos +  8);
+		entry.mtimeNanoseconds = readUInt32(pos + 12);
+		entry.dev              = readUInt32(pos + 16);
+		entry.ino              = readUInt32(pos + 20);
+		entry.mode             = readUInt32(pos + 24);
+		entry.uid              = readUInt32(pos + 28);
+		entry.gid              = readUInt32(pos + 32);
+		entry.size             = readUInt32(pos + 36);
+		memcpy(entry.sha1, pos + 40, Sha1Size);
+		entry.flags            = readUInt16(pos + 40 + Sha1Size);
+
+		const uchar *name = pos + EntryFixedSize;
+		if (entry.flags & FlagExtended) {
+			if (d->version < 3 || end - name < ExtendedFlagsSize) {
+				kWarning() << "index has invalid extended flags" << d->filePath;
+				return false;
+			}
+			entry.extendedFlags = readUInt16(name);
+			name += ExtendedFlagsSize;
+		}
+
+		if (d->version == 4) {
+			// the path is stored as the number of bytes to remove from the
+			// end of the previous path followed by the NUL terminated suffix
+			quint64 strip = 0;
+			if (!readVarInt(name, end, strip) || strip > quint64(previousPath.size())) {
+				kWarning() << "index has invalid path compression" << d->filePath;
+				return false;
+			}
+			const uchar *nul = (const uchar*)memchr(name, 0, end - name);
+			if (!nul) {
+				kWarning() << "index is truncated" << d->filePath;
+				return false;
+			}
+
+			previousPath.truncate(previousPath.size() - strip);
+			previousPath.append((const char*)name, nul - name);
+			entry.path = QString::fromUtf8(previousPath.constData(), previousPath.size());
+
+			pos = nul + 1;
+		} else {
+			const uchar *nul = (const uchar*)memchr(name, 0, end - name);
+			if (!nul) {
+				kWarning() << "index is truncated" << d->filePath;
+				return false;
+			}
+
+			entry.path = QString::fromUtf8((const char*)name, nul - name);
+
+			// entries are padded with NULs to a multiple of 8 bytes
+			pos += ((name - pos) + (nul - name) + 8) & ~7;
+		}
+	}
+
+	// read the cached trees and skip the other extensions
+	while (pos < end) {
+		if (end - pos < ExtensionHeaderSize) {
+			kWarning() << "index has a truncated extension" << d->filePath;
+			return false;
+		}
+
+		// extensions starting with an upper case letter are optional
+		if (pos[0] < 'A' || pos[0] > 'Z') {
+			kDebug() << "index has unsupported extension" << QByteArray((const char*)pos, SignatureSize) << d->filePath;
+			return false;
+		}
+
+		quint32 extensionSize = readUInt32(pos + SignatureSize);
+		if (end - pos - ExtensionHeaderSize < extensionSize) {
+			kWarning() << "index has a truncated extension" << d->filePath;
+			return false;
+		}
+
+		if (memcmp(pos, CacheTreeSignature, SignatureSize) == 0) {
+			const uchar *tree = pos + ExtensionHeaderSize;
+			const uchar *treeEnd = tree + extensionSize;
+			while (tree < treeEnd) {
+				if (!readCachedTrees(tree, treeEnd, QString())) {
+					// the cache is only an optimization, so don't give up on the index
+					kWarning() << "index has an invalid tree cache" << d->filePath;
+					d->cachedTrees.clear();
+					break;
+				}
+			}
+		}
+
+		pos += ExtensionHeaderSize + extensionSize;
+	}
+
+	return true;
+}
+
+/**
+ * Reads a cached tree and (recursively) its subtrees.
+ * Every tree is stored as:
+ *   path NUL entry_count SP subtree_count LF [SHA1 if entry_count >= 0]
+ * It advances @a data past the tree.
+ */
+bool Index::readCachedTrees(const uchar *&data, const uchar *end, const QString &prefix)
+{
+	const uchar *nul = (const uchar*)memchr(data, 0, end - data);
+	if (!nul) {
+		return false;
+	}
+	QString path = prefix + QString::fromUtf8((const char*)data, nul - data);
+
+	const uchar *lf = (const uchar*)memchr(nul, '\n', end - nul);
+	if (!lf) {
+		return false;
+	}
+	QList<QByteArray> counts = QByteArray((const char*)nul + 1, lf - nul - 1).split(' ');
+	if (counts.size() != 2) {
+		return false;
+	}
+
+	bool entryCountOk = false;
+	bool subtreeCountOk = false;
+	IndexCachedTree cachedTree;
+	cachedTree.entryCount = counts[0].toInt(&entryCountOk);
+	int subtreeCount = counts[1].toInt(&subtreeCountOk);
+	if (!entryCountOk || !subtreeCountOk) {
+		return false;
+	}
+
+	data = lf + 1;
+	if (cachedTree.entryCount >= 0) {
+		if (end - data < Sha1Size) {
+			return false;
+		}
+		cachedTree.sha1 = QByteArray((const char*)data, Sha1Size);
+		data += Sha1Size;
+	} else {
+		cachedTree.entryCount = -1;
+	}
+	d->cachedTrees.insert(path, cachedTree);
+
+	QString subtreePrefix = path.isEmpty() ? path : path + '/';
+	for (int i=0; i < subtreeCount; ++i) {
+		if (data >= end || !readCachedTrees(data, end, subtreePrefix)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint Index::timestamp() const
+{
+	return d->timestamp;
+}
+
+quint32 Index::version() const
+{
+	return d->version;
+}
+
+#include "Index.moc"
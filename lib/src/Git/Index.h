@@ -0,0 +1,231 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief The index (aka staging area) of a Git repository.
+ */
+
+#ifndef INDEX_H
+#define INDEX_H
+
+#include <QObject>
+
+#include <kdemacros.h>
+
+#include <QSharedDataPointer>
+#include <QVector>
+
+
+
+class IndexTest;
+
+namespace Git {
+
+class IndexPrivate;
+class Repo;
+
+
+
+/**
+ * @brief An entry of the index.
+ *
+ * It holds the cached stat data, the blob's SHA1 and the flags of a path as
+ * they are stored in the index file.
+ */
+class KDE_EXPORT IndexEntry
+{
+	public:
+		IndexEntry();
+
+		/** @brief Has the entry been marked with "git update-index --assume-unchanged"? */
+		bool isAssumeValid() const;
+		/** @brief Has the entry been added with "git add --intent-to-add"? */
+		bool isIntentToAdd() const;
+		/** @brief Has the entry been marked with "git update-index --skip-worktree"? */
+		bool isSkipWorktree() const;
+
+		/**
+		 * @brief Returns the mode as octal string like "git ls-files --stage" does.
+		 *
+		 * @return The mode (e.g. "100644").
+		 */
+		QString modeString() const;
+
+		/**
+		 * @brief Returns the blob's SHA1 as hex string.
+		 *
+		 * @return The SHA1 or a null string if it is all zeros.
+		 */
+		QString sha1String() const;
+
+		/**
+		 * @brief Returns the merge stage of the entry.
+		 *
+		 * @return 0 for normal entries, 1-3 for unmerged ones.
+		 */
+		int stage() const;
+
+		quint32 ctimeSeconds;
+		quint32 ctimeNanoseconds;
+		quint32 mtimeSeconds;
+		quint32 mtimeNanoseconds;
+		quint32 dev;
+		quint32 ino;
+		quint32 mode;
+		quint32 uid;
+		quint32 gid;
+		quint32 size;
+		/** The binary SHA1 of the entry's blob. */
+		uchar   sha1[20];
+		quint16 flags;
+		quint16 extendedFlags;
+		QString path;
+};
+
+
+
+/**
+ * @brief The index (aka staging area) of a Git repository.
+ *
+ * It reads the repo's index file (versions 2 to 4) in-process without
+ * running Git. The entries are sorted by path and stage just like in the
+ * file.
+ *
+ * The index is invalid if the file does not exist, is corrupt, has an
+ * unsupported version or uses required extensions that can not be
+ * understood (e.g. split or sparse indexes). You should fall back to
+ * running Git in that case.
+ *
+ * @see isValid()
+ */
+class KDE_EXPORT Index : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/**
+		 * @brief Reads the index of @a repo.
+		 */
+		explicit Index(const Repo &repo, QObject *parent = 0);
+
+		/**
+		 * @brief Reads the index from the given file.
+		 */
+		explicit Index(const QString &indexFilePath, QObject *parent = 0);
+		virtual ~Index();
+
+		/**
+		 * @brief Returns the number of entries covered by the tree cached for @a directory.
+		 *
+		 * The entries of a directory follow each other in entries(), so this can
+		 * be used to skip all of them at once.
+		 *
+		 * @param directory The directory relative to the working directory ("" for the root).
+		 * @return The number of entries or -1 if no valid tree is cached for @a directory.
+		 *
+		 * @see cachedTreeId()
+		 */
+		int cachedTreeEntryCount(const QString &directory) const;
+
+		/**
+		 * @brief Returns the id of the tree cached for @a directory.
+		 *
+		 * Git caches the trees it wrote for the last commit in the index. They
+		 * are invalidated as soon as an entry in the directory changes. So if a
+		 * cached tree's id matches the id of a tree in a commit, all entries of
+		 * the directory are unchanged.
+		 *
+		 * @param directory The directory relative to the working directory ("" for the root).
+		 * @return The tree's SHA1 or a null string if no valid tree is cached for @a directory.
+		 */
+		QString cachedTreeId(const QString &directory) const;
+
+		/**
+		 * @brief Returns all entries sorted by path and stage.
+		 */
+		const QVector<IndexEntry>& entries() const;
+
+		/**
+		 * @brief Returns the position of the first entry for @a path.
+		 *
+		 * @param path The entry's path relative to the working directory.
+		 * @return The position in entries() or -1 if there is no entry for @a path.
+		 */
+		int indexOf(const QString &path) const;
+
+		/**
+		 * @brief Checks whether the index file could be read completely.
+		 */
+		bool isValid() const;
+
+		/**
+		 * @brief Returns the position of the first entry not sorting before @a path.
+		 *
+		 * The entries of a directory follow each other, so all entries below
+		 * "dir/" start at lowerBound("dir/").
+		 *
+		 * @param path A path relative to the working directory.
+		 * @return The position in entries() or the number of entries if all sort before @a path.
+		 */
+		int lowerBound(const QString &path) const;
+
+		/**
+		 * @brief Returns the modification time of the index file.
+		 *
+		 * Entries modified at or after this time are "racily clean": their
+		 * cached stat data can not be trusted to detect changes.
+		 *
+		 * @return The modification time in seconds since the epoch.
+		 */
+		uint timestamp() const;
+
+		/**
+		 * @brief Returns the version of the index file.
+		 *
+		 * @return The version or 0 if the file could not be read.
+		 */
+		quint32 version() const;
+
+	// static
+		/**
+		 * @brief Compares two paths in the order Git sorts index entries by.
+		 *
+		 * Git compares the raw (UTF-8) bytes of the paths. This is the order
+		 * of the code points, which differs from QString's order of UTF-16
+		 * code units for characters outside of the BMP.
+		 *
+		 * @return A negative number, zero or a positive number if @a a sorts before, equal to or after @a b.
+		 */
+		static int comparePaths(const QString &a, const QString &b);
+
+	private:
+		void read(const QString &indexFilePath);
+		bool readCachedTrees(const uchar *&data, const uchar *end, const QString &prefix);
+		bool readEntries(const uchar *data, qint64 size);
+
+	private:
+		QSharedDataPointer<IndexPrivate> d;
+
+		friend class ::IndexTest;
+};
+
+}
+
+#endif // INDEX_H
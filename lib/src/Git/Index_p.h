@@ -0,0 +1,78 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INDEX_P_H
+#define INDEX_P_H
+
+#include "Index.h"
+
+#include <QHash>
+#include <QSharedData>
+#include <QString>
+#include <QVector>
+
+namespace Git {
+
+/**
+ * A tree cached in the index's "TREE" extension.
+ */
+struct IndexCachedTree {
+	IndexCachedTree()
+		: entryCount(-1)
+		, sha1()
+	{}
+
+	/** The number of index entries covered by the tree or -1 if it has been invalidated. */
+	int entryCount;
+	/** The binary SHA1 of the tree. */
+	QByteArray sha1;
+};
+
+class IndexPrivate : public QSharedData {
+public:
+	IndexPrivate()
+		: QSharedData()
+		, cachedTrees()
+		, entries()
+		, filePath()
+		, timestamp(0)
+		, valid(false)
+		, version(0)
+	{}
+	IndexPrivate(const IndexPrivate &other)
+		: QSharedData(other)
+		, cachedTrees(other.cachedTrees)
+		, entries(other.entries)
+		, filePath(other.filePath)
+		, timestamp(other.timestamp)
+		, valid(other.valid)
+		, version(other.version)
+	{}
+	~IndexPrivate() {}
+
+	QHash<QString, IndexCachedTree> cachedTrees;
+	QVector<IndexEntry> entries;
+	QString filePath;
+	uint timestamp;
+	bool valid;
+	quint32 version;
+};
+
+}
+
+#endif // INDEX_P_H
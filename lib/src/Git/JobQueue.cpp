@@ -0,0 +1,126 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "JobQueue.h"
+
+#include "dvcsjob.h"
+
+#include <QThread>
+
+using namespace Git;
+
+
+
+#define PollInterval  10
+
+
+
+JobQueue::JobQueue(QObject *parent)
+	: QObject(parent)
+	, m_maxRunningJobs(qMax(1, QThread::idealThreadCount()))
+	, m_queuedJobs()
+	, m_runningJobs()
+{
+}
+
+
+
+void JobQueue::cancel()
+{
+	// drop the queued ones first, so we don't start them when the others die
+	QList<DvcsJob*> jobs = m_queuedJobs + m_runningJobs;
+	m_queuedJobs.clear();
+
+	foreach (DvcsJob *job, jobs) {
+		job->kill(KJob::EmitResult);
+	}
+}
+
+void JobQueue::enqueue(DvcsJob *job)
+{
+	Q_ASSERT(job);
+
+	connect(job, SIGNAL(finished(KJob*)), this, SLOT(jobFinished(KJob*)));
+	m_queuedJobs.enqueue(job);
+
+	startQueuedJobs();
+}
+
+bool JobQueue::isEmpty() const
+{
+	return m_queuedJobs.isEmpty() && m_runningJobs.isEmpty();
+}
+
+void JobQueue::jobFinished(KJob *job)
+{
+	if (!m_runningJobs.removeOne(static_cast<DvcsJob*>(job))) {
+		m_queuedJobs.removeOne(static_cast<DvcsJob*>(job));
+	}
+
+	startQueuedJobs();
+
+	if (isEmpty()) {
+		emit finished();
+	}
+}
+
+int JobQueue::maxRunningJobs() const
+{
+	return m_maxRunningJobs;
+}
+
+int JobQueue::queuedJobs() const
+{
+	return m_queuedJobs.size();
+}
+
+int JobQueue::runningJobs() const
+{
+	return m_runningJobs.size();
+}
+
+void JobQueue::setMaxRunningJobs(int max)
+{
+	m_maxRunningJobs = qMax(1, max);
+
+	startQueuedJobs();
+}
+
+void JobQueue::startQueuedJobs()
+{
+	while (!m_queuedJobs.isEmpty() && m_runningJobs.size() < m_maxRunningJobs) {
+		DvcsJob *job = m_queuedJobs.dequeue();
+		m_runningJobs << job;
+		job->start();
+	}
+}
+
+void JobQueue::waitForFinished()
+{
+	// waiting for a single process would only read its pipes and let the
+	// others block once they are full, so all of them are served in turns
+	// without dispatching any events (the callers are synchronous APIs)
+	while (!m_runningJobs.isEmpty()) {
+		// finished jobs are removed and queued ones started while we wait
+		foreach (DvcsJob *job, QList<DvcsJob*>(m_runningJobs)) {
+			job->waitForFinished(PollInterval);
+		}
+	}
+}
+
+#include "JobQueue.moc"
@@ -0,0 +1,154 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Runs Git jobs with a bounded number of processes at a time.
+ */
+
+#ifndef JOBQUEUE_H
+#define JOBQUEUE_H
+
+#include <QObject>
+
+#include <kdemacros.h>
+
+#include <QList>
+#include <QQueue>
+
+
+
+class DvcsJob;
+class KJob;
+class JobQueueTest;
+
+namespace Git {
+
+/**
+ * @brief Runs Git jobs with a bounded number of processes at a time.
+ *
+ * Enqueued jobs are started in order as long as less than maxRunningJobs()
+ * of them are running. Every time one of them finishes the next one is
+ * started, so independent Git commands run in parallel without forking an
+ * unbounded number of processes.
+ *
+ * The queue does not own the jobs. Connect to their result() signals to get
+ * their output. If you need the results right away call waitForFinished().
+ *
+ * @code
+ *     GitRunner runner;
+ *     runner.setDirectory(repo.workingDir());
+ *     runner.setAsynchronous(true);
+ *
+ *     runner.lsFiles();
+ *     DvcsJob *job = runner.takeJob();
+ *     connect(job, SIGNAL(result(KJob*)), this, SLOT(slotFilesListed(KJob*)));
+ *     queue->enqueue(job);
+ * @endcode
+ */
+class KDE_EXPORT JobQueue : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/**
+		 * @brief Creates an empty queue.
+		 *
+		 * The number of running jobs is bounded by the number of CPU cores.
+		 */
+		explicit JobQueue(QObject *parent = 0);
+
+		/**
+		 * @brief Appends the job to the queue.
+		 *
+		 * It is started right away if less than maxRunningJobs() are running.
+		 *
+		 * @param job A job that has not been started yet.
+		 */
+		void enqueue(DvcsJob *job);
+
+		/**
+		 * @brief Checks whether there are no queued or running jobs.
+		 */
+		bool isEmpty() const;
+
+		/**
+		 * @brief The maximum number of jobs running at the same time.
+		 */
+		int maxRunningJobs() const;
+
+		/**
+		 * @brief The number of jobs waiting to be started.
+		 */
+		int queuedJobs() const;
+
+		/**
+		 * @brief The number of jobs that have been started but not finished yet.
+		 */
+		int runningJobs() const;
+
+		/**
+		 * @brief Sets the maximum number of jobs running at the same time.
+		 *
+		 * Queued jobs are started if the bound is raised.
+		 *
+		 * @param max The bound, values smaller than 1 are treated as 1.
+		 */
+		void setMaxRunningJobs(int max);
+
+		/**
+		 * @brief Blocks until all queued and running jobs have finished.
+		 *
+		 * The jobs' result() signals will have been emitted when this returns.
+		 * The running processes are waited for in turns, so the output of all
+		 * of them keeps being read. No events are dispatched while waiting.
+		 */
+		void waitForFinished();
+
+	public slots:
+		/**
+		 * @brief Cancels all running jobs and drops the queued ones.
+		 *
+		 * Every job emits its result() with KJob::KilledJobError.
+		 */
+		void cancel();
+
+	signals:
+		/**
+		 * @brief Emitted when the last queued or running job has finished.
+		 */
+		void finished();
+
+	private slots:
+		void jobFinished(KJob *job);
+
+	private:
+		void startQueuedJobs();
+
+	private:
+		int m_maxRunningJobs;
+		QQueue<DvcsJob*> m_queuedJobs;
+		QList<DvcsJob*> m_runningJobs;
+
+		friend class ::JobQueueTest;
+};
+
+}
+
+#endif // JOBQUEUE_H
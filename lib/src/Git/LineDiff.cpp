@@ -0,0 +1,518 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LineDiff.h"
+
+#include <QHash>
+
+#include <climits>
+
+using namespace Git;
+
+
+
+/** Lines occurring more often than this are not used for aligning the texts in the histogram diff. */
+#define MaxChainLength  64
+/** Git only looks at the beginning of files to decide whether they are binary. */
+#define BinaryCheckSize  8000
+
+
+
+DiffHunk::DiffHunk()
+	: oldStart(0)
+	, oldCount(0)
+	, newStart(0)
+	, newCount(0)
+	, text()
+{
+}
+
+
+
+LineDiff::LineDiff(const QByteArray &oldData, const QByteArray &newData, Algorithm algorithm, int contextLines)
+	: m_algorithm(algorithm)
+	, m_changes()
+	, m_contextLines(contextLines)
+	, m_nextChange(0)
+	, m_newChanged()
+	, m_newData(newData)
+	, m_newLines()
+	, m_newLineStarts(lineStartsIn(newData))
+	, m_oldChanged()
+	, m_oldData(oldData)
+	, m_oldLines()
+	, m_oldLineStarts(lineStartsIn(oldData))
+{
+	hashLines();
+	collectChanges();
+}
+
+void LineDiff::appendLine(QByteArray &text, char prefix, const QByteArray &data, const QVector<int> &lineStarts, int line) const
+{
+	int start = lineStarts[line];
+	int end = lineStarts[line + 1];
+
+	text += prefix;
+	text.append(data.constData() + start, end - start);
+
+	if (end == start || data[end - 1] != '\n') {
+		text += "\n\\ No newline at end of file\n";
+	}
+}
+
+void LineDiff::collectChanges()
+{
+	m_oldChanged.fill(false, m_oldLines.size());
+	m_newChanged.fill(false, m_newLines.size());
+
+	// the ranges (4 ints each) still to be compared
+	QVector<int> ranges;
+	ranges << 0 << m_oldLines.size() << 0 << m_newLines.size();
+
+	while (!ranges.isEmpty()) {
+		int size = ranges.size();
+		int oldBegin = ranges[size - 4];
+		int oldEnd   = ranges[size - 3];
+		int newBegin = ranges[size - 2];
+		int newEnd   = ranges[size - 1];
+		ranges.resize(size - 4);
+
+		if (m_algorithm == Histogram) {
+			diffHistogram(oldBegin, oldEnd, newBegin, newEnd, ranges);
+		} else {
+			diffMyers(oldBegin, oldEnd, newBegin, newEnd, ranges);
+		}
+	}
+
+	compact(m_oldLines, m_oldChanged);
+	compact(m_newLines, m_newChanged);
+
+	// the unchanged lines of both texts pair up in order
+	int oldLine = 0;
+	int newLine = 0;
+	while (oldLine < m_oldLines.size() || newLine < m_newLines.size()) {
+		if (oldLine < m_oldLines.size() && newLine < m_newLines.size() && !m_oldChanged[oldLine] && !m_newChanged[newLine]) {
+			++oldLine;
+			++newLine;
+			continue;
+		}
+
+		Change change;
+		change.oldStart = oldLine;
+		change.newStart = newLine;
+		while (oldLine < m_oldLines.size() && m_oldChanged[oldLine]) {
+			++oldLine;
+		}
+		while (newLine < m_newLines.size() && m_newChanged[newLine]) {
+			++newLine;
+		}
+		change.oldEnd = oldLine;
+		change.newEnd = newLine;
+
+		m_changes << change;
+	}
+}
+
+void LineDiff::diffHistogram(int oldBegin, int oldEnd, int newBegin, int newEnd, QVector<int> &ranges)
+{
+	const int *oldLines = m_oldLines.constData();
+	const int *newLines = m_newLines.constData();
+
+	while (oldBegin < oldEnd && newBegin < newEnd && oldLines[oldBegin] == newLines[newBegin]) {
+		++oldBegin;
+		++newBegin;
+	}
+	while (oldBegin < oldEnd && newBegin < newEnd && oldLines[oldEnd - 1] == newLines[newEnd - 1]) {
+		--oldEnd;
+		--newEnd;
+	}
+
+	if (oldBegin == oldEnd || newBegin == newEnd) {
+		markChanged(oldBegin, oldEnd, newBegin, newEnd);
+		return;
+	}
+
+	// where each line occurs in the old range
+	QHash<int, QVector<int> > occurrences;
+	for (int i = oldBegin; i < oldEnd; ++i) {
+		occurrences[oldLines[i]] << i;
+	}
+
+	// find the longest common region whose rarest line is as rare as possible
+	int bestCount = MaxChainLength + 1;
+	int bestLength = 0;
+	int bestOld = 0;
+	int bestNew = 0;
+
+	int newLine = newBegin;
+	while (newLine < newEnd) {
+		int nextNewLine = newLine + 1;
+
+		QHash<int, QVector<int> >::const_iterator found = occurrences.constFind(newLines[newLine]);
+		if (found != occurrences.constEnd() && found.value().size() <= MaxChainLength) {
+			foreach (int oldLine, found.value()) {
+				int count = found.value().size();
+
+				int oldStart = oldLine;
+				int newStart = newLine;
+				while (oldStart > oldBegin && newStart > newBegin && oldLines[oldStart - 1] == newLines[newStart - 1]) {
+					--oldStart;
+					--newStart;
+					count = qMin(count, occurrences.value(oldLines[oldStart]).size());
+				}
+
+				int oldStop = oldLine + 1;
+				int newStop = newLine + 1;
+				while (oldStop < oldEnd && newStop < newEnd && oldLines[oldStop] == newLines[newStop]) {
+					count = qMin(count, occurrences.value(oldLines[oldStop]).size());
+					++oldStop;
+					++newStop;
+				}
+
+				if (count < bestCount || (count == bestCount && oldStop - oldStart > bestLength)) {
+					bestCount = count;
+					bestLength = oldStop - oldStart;
+					bestOld = oldStart;
+					bestNew = newStart;
+				}
+
+				nextNewLine = qMax(nextNewLine, newStop);
+			}
+		}
+
+		newLine = nextNewLine;
+	}
+
+	// only very common lines (or none at all) are shared
+	if (bestLength == 0) {
+		diffMyers(oldBegin, oldEnd, newBegin, newEnd, ranges);
+		return;
+	}
+
+	ranges << oldBegin << bestOld << newBegin << bestNew;
+	ranges << bestOld + bestLength << oldEnd << bestNew + bestLength << newEnd;
+}
+
+void LineDiff::diffMyers(int oldBegin, int oldEnd, int newBegin, int newEnd, QVector<int> &ranges)
+{
+	const int *oldLines = m_oldLines.constData();
+	const int *newLines = m_newLines.constData();
+
+	while (oldBegin < oldEnd && newBegin < newEnd && oldLines[oldBegin] == newLines[newBegin]) {
+		++oldBegin;
+		++newBegin;
+	}
+	while (oldBegin < oldEnd && newBegin < newEnd && oldLines[oldEnd - 1] == newLines[newEnd - 1]) {
+		--oldEnd;
+		--newEnd;
+	}
+
+	if (oldBegin == oldEnd || newBegin == newEnd) {
+		markChanged(oldBegin, oldEnd, newBegin, newEnd);
+		return;
+	}
+
+	int oldSplit;
+	int newSplit;
+	findMiddleSnake(oldBegin, oldEnd, newBegin, newEnd, oldSplit, newSplit);
+
+	ranges << oldBegin << oldSplit << newBegin << newSplit;
+	ranges << oldSplit << oldEnd << newSplit << newEnd;
+}
+
+/**
+ * Searches forward from the beginning and backward from the end of the
+ * (trimmed) ranges at the same time until both paths meet on a diagonal.
+ * The meeting point is on a shortest edit script, so both halves can be
+ * compared independently. This needs linear space only.
+ */
+void LineDiff::findMiddleSnake(int oldBegin, int oldEnd, int newBegin, int newEnd, int &oldSplit, int &newSplit)
+{
+	const int *oldLines = m_oldLines.constData() + oldBegin;
+	const int *newLines = m_newLines.constData() + newBegin;
+	int oldSize = oldEnd - oldBegin;
+	int newSize = newEnd - newBegin;
+
+	// the diagonals (x - y) lie between -newSize and oldSize (plus one on each side for sentinels)
+	int offset = newSize + 1;
+	QVector<int> forward(oldSize + newSize + 3);
+	QVector<int> backward(oldSize + newSize + 3);
+
+	int minDiagonal = -newSize;
+	int maxDiagonal = oldSize;
+	int backwardMid = oldSize - newSize;
+	bool odd = (backwardMid & 1) != 0;
+
+	int forwardMin = 0;
+	int forwardMax = 0;
+	int backwardMin = backwardMid;
+	int backwardMax = backwardMid;
+	forward[offset] = 0;
+	backward[offset + backwardMid] = oldSize;
+
+	forever {
+		if (forwardMin > minDiagonal) {
+			forward[offset + --forwardMin - 1] = -1;
+		} else {
+			++forwardMin;
+		}
+		if (forwardMax < maxDiagonal) {
+			forward[offset + ++forwardMax + 1] = -1;
+		} else {
+			--forwardMax;
+		}
+
+		for (int diagonal = forwardMax; diagonal >= forwardMin; diagonal -= 2) {
+			int x;
+			if (forward[offset + diagonal - 1] >= forward[offset + diagonal + 1]) {
+				x = forward[offset + diagonal - 1] + 1;
+			} else {
+				x = forward[offset + diagonal + 1];
+			}
+			int y = x - diagonal;
+
+			while (x < oldSize && y < newSize && oldLines[x] == newLines[y]) {
+				++x;
+				++y;
+			}
+			forward[offset + diagonal] = x;
+
+			if (odd && backwardMin <= diagonal && diagonal <= backwardMax && backward[offset + diagonal] <= x) {
+				oldSplit = oldBegin + x;
+				newSplit = newBegin + y;
+				return;
+			}
+		}
+
+		if (backwardMin > minDiagonal) {
+			backward[offset + --backwardMin - 1] = INT_MAX;
+		} else {
+			++backwardMin;
+		}
+		if (backwardMax < maxDiagonal) {
+			backward[offset + ++backwardMax + 1] = INT_MAX;
+		} else {
+			--backwardMax;
+		}
+
+		for (int diagonal = backwardMax; diagonal >= backwardMin; diagonal -= 2) {
+			int x;
+			if (backward[offset + diagonal - 1] < backward[offset + diagonal + 1]) {
+				x = backward[offset + diagonal - 1];
+			} else {
+				x = backward[offset + diagonal + 1] - 1;
+			}
+			int y = x - diagonal;
+
+			while (x > 0 && y > 0 && oldLines[x - 1] == newLines[y - 1]) {
+				--x;
+				--y;
+			}
+			backward[offset + diagonal] = x;
+
+			if (!odd && forwardMin <= diagonal && diagonal <= forwardMax && x <= forward[offset + diagonal]) {
+				oldSplit = oldBegin + x;
+				newSplit = newBegin + y;
+				return;
+			}
+		}
+	}
+}
+
+bool LineDiff::hasChanges() const
+{
+	return !m_changes.isEmpty();
+}
+
+void LineDiff::hashLines()
+{
+	// equal lines get the same number, so the algorithms only compare ints
+	QHash<QByteArray, int> lineIds;
+
+	const QByteArray *data[2] = { &m_oldData, &m_newData };
+	const QVector<int> *lineStarts[2] = { &m_oldLineStarts, &m_newLineStarts };
+	QVector<int> *lines[2] = { &m_oldLines, &m_newLines };
+
+	for (int text = 0; text < 2; ++text) {
+		int lineCount = lineStarts[text]->size() - 1;
+		lines[text]->resize(lineCount);
+
+		for (int i = 0; i < lineCount; ++i) {
+			int start = lineStarts[text]->at(i);
+			// the data outlives the hash, so the lines need not be copied
+			QByteArray line = QByteArray::fromRawData(data[text]->constData() + start, lineStarts[text]->at(i + 1) - start);
+
+			QHash<QByteArray, int>::const_iterator found = lineIds.constFind(line);
+			if (found != lineIds.constEnd()) {
+				(*lines[text])[i] = found.value();
+			} else {
+				int lineId = lineIds.size();
+				lineIds.insert(line, lineId);
+				(*lines[text])[i] = lineId;
+			}
+		}
+	}
+}
+
+void LineDiff::markChanged(int oldBegin, int oldEnd, int newBegin, int newEnd)
+{
+	for (int i = oldBegin; i < oldEnd; ++i) {
+		m_oldChanged[i] = true;
+	}
+	for (int i = newBegin; i < newEnd; ++i) {
+		m_newChanged[i] = true;
+	}
+}
+
+bool LineDiff::nextHunk(DiffHunk &hunk)
+{
+	if (m_nextChange >= m_changes.size()) {
+		return false;
+	}
+
+	// changes separated by few unchanged lines go into the same hunk
+	int firstChange = m_nextChange;
+	int lastChange = firstChange;
+	while (lastChange + 1 < m_changes.size()
+		&& m_changes[lastChange + 1].oldStart - m_changes[lastChange].oldEnd <= 2 * m_contextLines) {
+		++lastChange;
+	}
+	m_nextChange = lastChange + 1;
+
+	const Change &first = m_changes[firstChange];
+	const Change &last = m_changes[lastChange];
+	int leadingContext = qMin(m_contextLines, first.oldStart);
+	int trailingContext = qMin(m_contextLines, m_oldLines.size() - last.oldEnd);
+
+	int oldStart = first.oldStart - leadingContext;
+	int newStart = first.newStart - leadingContext;
+	int oldEnd = last.oldEnd + trailingContext;
+	int newEnd = last.newEnd + trailingContext;
+
+	hunk.oldStart = oldStart + 1;
+	hunk.oldCount = oldEnd - oldStart;
+	hunk.newStart = newStart + 1;
+	hunk.newCount = newEnd - newStart;
+
+	// like Git an empty range starts at the line before it and a count of 1 is left out
+	hunk.text = "@@ -";
+	hunk.text += QByteArray::number(hunk.oldCount ? hunk.oldStart : hunk.oldStart - 1);
+	if (hunk.oldCount != 1) {
+		hunk.text += ',' + QByteArray::number(hunk.oldCount);
+	}
+	hunk.text += " +";
+	hunk.text += QByteArray::number(hunk.newCount ? hunk.newStart : hunk.newStart - 1);
+	if (hunk.newCount != 1) {
+		hunk.text += ',' + QByteArray::number(hunk.newCount);
+	}
+	hunk.text += " @@\n";
+
+	int oldLine = oldStart;
+	int newLine = newStart;
+	while (oldLine < oldEnd || newLine < newEnd) {
+		if (oldLine < oldEnd && newLine < newEnd && !m_oldChanged[oldLine] && !m_newChanged[newLine]) {
+			appendLine(hunk.text, ' ', m_oldData, m_oldLineStarts, oldLine);
+			++oldLine;
+			++newLine;
+			continue;
+		}
+
+		while (oldLine < oldEnd && m_oldChanged[oldLine]) {
+			appendLine(hunk.text, '-', m_oldData, m_oldLineStarts, oldLine);
+			++oldLine;
+		}
+		while (newLine < newEnd && m_newChanged[newLine]) {
+			appendLine(hunk.text, '+', m_newData, m_newLineStarts, newLine);
+			++newLine;
+		}
+	}
+
+	return true;
+}
+
+QByteArray LineDiff::unifiedDiff()
+{
+	QByteArray diff;
+
+	DiffHunk hunk;
+	while (nextHunk(hunk)) {
+		diff += hunk.text;
+	}
+
+	return diff;
+}
+
+
+
+/**
+ * Like Git, moves groups of changed lines down as far as possible, if the
+ * line after a group equals its first line. The result is the same but
+ * e.g. an added function is shown as a whole instead of starting with the
+ * closing brace of the function before it.
+ */
+void LineDiff::compact(const QVector<int> &lines, QVector<bool> &changed)
+{
+	int line = 0;
+	while (line < lines.size()) {
+		if (!changed[line]) {
+			++line;
+			continue;
+		}
+
+		int groupStart = line;
+		while (line < lines.size() && changed[line]) {
+			++line;
+		}
+
+		while (line < lines.size() && lines[groupStart] == lines[line]) {
+			changed[groupStart] = false;
+			changed[line] = true;
+			++groupStart;
+			++line;
+
+			// the group may have run into the next one
+			while (line < lines.size() && changed[line]) {
+				++line;
+			}
+		}
+	}
+}
+
+bool LineDiff::isBinary(const QByteArray &data)
+{
+	return data.left(BinaryCheckSize).contains('\0');
+}
+
+QVector<int> LineDiff::lineStartsIn(const QByteArray &data)
+{
+	QVector<int> lineStarts;
+	lineStarts << 0;
+
+	int position = 0;
+	while ((position = data.indexOf('\n', position)) >= 0) {
+		++position;
+		lineStarts << position;
+	}
+
+	// the last line may not end with a newline
+	if (lineStarts.last() != data.size()) {
+		lineStarts << data.size();
+	}
+
+	return lineStarts;
+}
@@ -0,0 +1,165 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Compares two texts line by line.
+ */
+
+#ifndef LINEDIFF_H
+#define LINEDIFF_H
+
+#include <kdemacros.h>
+
+#include <QByteArray>
+#include <QVector>
+
+
+
+class LineDiffTest;
+
+namespace Git {
+
+
+
+/**
+ * @brief A hunk of a unified diff.
+ *
+ * The line numbers start at 1 like in the hunk's header.
+ */
+class KDE_EXPORT DiffHunk
+{
+	public:
+		DiffHunk();
+
+		int oldStart;
+		int oldCount;
+		int newStart;
+		int newCount;
+		/** The hunk as it appears in a unified diff (including its "@@" header) */
+		QByteArray text;
+};
+
+
+
+/**
+ * @brief Compares two texts line by line.
+ *
+ * The lines are hashed once, so the algorithms only compare integers. The
+ * common lines at the beginning and the end are trimmed before the actual
+ * algorithm runs on what remains.
+ *
+ * The differences are found when the diff is constructed. The hunks of the
+ * unified diff are formatted one at a time, so the first ones can be shown
+ * before the rest has been formatted:
+ * @code
+ *   LineDiff diff(oldData, newData);
+ *   DiffHunk hunk;
+ *   while (diff.nextHunk(hunk)) {
+ *     show(hunk.text);
+ *   }
+ * @endcode
+ */
+class KDE_EXPORT LineDiff
+{
+	public:
+		enum Algorithm {
+			/** Finds the smallest number of changes (like Git's default) */
+			Myers,
+			/** Aligns rare lines first (like "git diff --histogram"), often more readable */
+			Histogram
+		};
+
+		/**
+		 * @brief Compares @a oldData with @a newData.
+		 *
+		 * @param oldData The old text.
+		 * @param newData The new text.
+		 * @param algorithm The algorithm used for finding the differences.
+		 * @param contextLines The number of unchanged lines shown around changes.
+		 */
+		LineDiff(const QByteArray &oldData, const QByteArray &newData, Algorithm algorithm = Myers, int contextLines = 3);
+
+		/**
+		 * @brief Checks whether the texts differ at all.
+		 */
+		bool hasChanges() const;
+
+		/**
+		 * @brief Formats the next hunk.
+		 *
+		 * @param hunk Receives the hunk.
+		 * @return Whether there was another hunk.
+		 */
+		bool nextHunk(DiffHunk &hunk);
+
+		/**
+		 * @brief Formats the remaining hunks.
+		 *
+		 * @return The hunks of a unified diff (without the file headers).
+		 */
+		QByteArray unifiedDiff();
+
+	// static
+		/**
+		 * @brief Checks whether @a data looks binary (like Git it looks for NUL bytes).
+		 */
+		static bool isBinary(const QByteArray &data);
+
+	private:
+		/** A consecutive range of changed lines */
+		struct Change {
+			int oldStart;
+			int oldEnd;
+			int newStart;
+			int newEnd;
+		};
+
+		void appendLine(QByteArray &text, char prefix, const QByteArray &data, const QVector<int> &lineStarts, int line) const;
+		void collectChanges();
+		void diffHistogram(int oldBegin, int oldEnd, int newBegin, int newEnd, QVector<int> &ranges);
+		void diffMyers(int oldBegin, int oldEnd, int newBegin, int newEnd, QVector<int> &ranges);
+		void findMiddleSnake(int oldBegin, int oldEnd, int newBegin, int newEnd, int &oldSplit, int &newSplit);
+		void hashLines();
+		void markChanged(int oldBegin, int oldEnd, int newBegin, int newEnd);
+
+	// static
+		static void compact(const QVector<int> &lines, QVector<bool> &changed);
+		static QVector<int> lineStartsIn(const QByteArray &data);
+
+	private:
+		Algorithm m_algorithm;
+		QVector<Change> m_changes;
+		int m_contextLines;
+		int m_nextChange;
+		QVector<bool> m_newChanged;
+		QByteArray m_newData;
+		QVector<int> m_newLines;
+		QVector<int> m_newLineStarts;
+		QVector<bool> m_oldChanged;
+		QByteArray m_oldData;
+		QVector<int> m_oldLines;
+		QVector<int> m_oldLineStarts;
+
+		friend class ::LineDiffTest;
+};
+
+}
+
+#endif // LINEDIFF_H
@@ -22,6 +22,9 @@
 #include "Repo.h"
 
 #include <KDebug>
+#include <KSaveFile>
+
+#include <QCryptographicHash>
 
 using namespace Git;
 
@@ -73,6 +76,21 @@ const QList<Id> LooseStorage::allIds()
 	return d->ids;
 }
 
+bool LooseStorage::contains(const QString &id)
+{
+	if (ObjectStorage::contains(id)) {
+		return true;
+	}
+
+	if (id.size() != 40 || !QFile::exists(d->objectsDir.filePath(id.left(2) + "/" + id.mid(2)))) {
+		return false;
+	}
+
+	d->ids << Id(id, *this);
+
+	return true;
+}
+
 void LooseStorage::invalidateIds()
 {
 	foreach (Id id, d->ids) {
@@ -203,5 +221,69 @@ const QString LooseStorage::sourceFor(const Id &id)
 }
 
 
+Id LooseStorage::writeObject(ObjectType type, const QByteArray &data)
+{
+	QByteArray rawData = RawObject::typeNameFromType(type).toLatin1();
+	rawData += ' ' + QByteArray::number(data.size());
+	rawData += '\0';
+	rawData += data;
+
+	QString id = QCryptographicHash::hash(rawData, QCryptographicHash::Sha1).toHex();
+
+	// objects never change, so there is nothing to do if it exists already
+	if (contains(id)) {
+		return Id(id, *this);
+	}
+
+	QString idDirPath = id.left(2);
+	if (!d->objectsDir.exists(idDirPath) && !d->objectsDir.mkdir(idDirPath)) {
+		kWarning() << "Could not create object directory:" << d->objectsDir.filePath(idDirPath);
+		return Id();
+	}
+
+	QString objectPath = d->objectsDir.filePath("%1/%2").arg(idDirPath).arg(id.mid(2));
+
+	// the temporary file is renamed only after everything has been written
+	KSaveFile objectFile(objectPath);
+	if (!objectFile.open()) {
+		kWarning() << "Could not write object:" << objectPath << objectFile.errorString();
+		return Id();
+	}
+
+	objectFile.write(deflate(rawData));
+	if (!objectFile.finalize()) {
+		kWarning() << "Could not write object:" << objectPath << objectFile.errorString();
+		return Id();
+	}
+
+	// Git writes objects read-only
+	QFile::setPermissions(objectPath, QFile::ReadOwner | QFile::ReadUser | QFile::ReadGroup | QFile::ReadOther);
+
+	d->ids << Id(id, *this);
+
+	return d->ids.last();
+}
+
+bool LooseStorage::writeObjectDataTo(const Id &id, QIODevice &device)
+{
+	if (!id.isValid()) {
+		return false;
+	}
+
+	// already loaded objects don't have to be inflated again
+	if (d->objectData.contains(id)) {
+		return ObjectStorage::writeObjectDataTo(id, device);
+	}
+
+	QFile objectFile(sourceFor(id));
+	if (!objectFile.open(QIODevice::ReadOnly)) {
+		kWarning() << "Could not read object:" << objectFile.fileName() << objectFile.errorString();
+		return false;
+	}
+
+	return inflateTo(objectFile, device, true);
+}
+
+
 
 #include "LooseStorage.moc"
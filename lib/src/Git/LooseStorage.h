@@ -40,11 +40,36 @@ class KDE_EXPORT LooseStorage : public ObjectStorage
 		virtual ~LooseStorage();
 
 		const QList<Id> allIds();
+		using ObjectStorage::contains;
+		/**
+		 * @brief Checks whether the object is in this storage.
+		 *
+		 * Unlike allIds() this also finds objects that have been written
+		 * after the ids have been listed (e.g. by staging files).
+		 */
+		bool contains(const QString &id);
 		const QByteArray objectDataFor(const Id &id);
 		RawObject&       objectFor(const Id &id);
 		int              objectSizeFor(const Id &id);
 		ObjectType       objectTypeFor(const Id &id);
 
+		/**
+		 * @brief Writes an object into this storage like "git hash-object -w" does.
+		 *
+		 * The object is deflated into a temporary file which is then renamed,
+		 * so readers never see partially written objects. Objects that are
+		 * already in the storage are not written again.
+		 *
+		 * @param type The object's type (e.g. OBJ_BLOB).
+		 * @param data The object's content without the header.
+		 * @return The object's id or an invalid id if it could not be written.
+		 */
+		Id writeObject(ObjectType type, const QByteArray &data);
+		/**
+		 * @brief Inflates the object's file into @a device without caching its data.
+		 */
+		bool writeObjectDataTo(const Id &id, QIODevice &device);
+
 	public slots:
 		void reset();
 
@@ -26,6 +26,8 @@
 
 #include <QStringList>
 
+#include <cstring>
+
 using namespace Git;
 
 
@@ -116,6 +118,12 @@ bool ObjectStorage::contains(const QString &id)
 	return false;
 }
 
+const QByteArray ObjectStorage::deflate(const QByteArray &inflatedData)
+{
+	// qCompress() writes a zlib stream prefixed with the 4 byte big-endian size
+	return qCompress(inflatedData).mid(4);
+}
+
 const QByteArray ObjectStorage::inflate(QByteArray deflatedData)
 {
 	QByteArray inflatedData;
@@ -169,11 +177,77 @@ const QByteArray ObjectStorage::inflate(QByteArray deflatedData)
 	return inflatedData;
 }
 
+bool ObjectStorage::inflateTo(QIODevice &source, QIODevice &target, bool skipHeader)
+{
+	KFilterBase *filter = KFilterBase::findFilterByMimeType("application/x-gzip");
+	Q_ASSERT(filter);
+
+	filter->init(QIODevice::ReadOnly);
+
+	const int bufferSize = 64*1024;
+	QByteArray inBuffer;
+	QByteArray outBuffer(bufferSize, '\0');
+	bool inHeader = skipHeader;
+	bool ok = false;
+
+	forever {
+		if (filter->inBufferEmpty()) {
+			inBuffer = source.read(bufferSize);
+			if (inBuffer.isEmpty()) {
+				kWarning() << "Stream ended before the object was inflated";
+				break;
+			}
+			filter->setInBuffer(inBuffer.data(), inBuffer.size());
+		}
+
+		filter->setOutBuffer(outBuffer.data(), outBuffer.size());
+		KFilterBase::Result result = filter->uncompress();
+		if (result == KFilterBase::Error) {
+			kWarning() << "Error when uncompressing object";
+			break;
+		}
+
+		const char *data = outBuffer.constData();
+		int uncompressedBytes = outBuffer.size() - filter->outBufferAvailable();
+
+		if (inHeader) {
+			const char *nul = (const char*)memchr(data, '\0', uncompressedBytes);
+			if (nul) {
+				uncompressedBytes -= nul + 1 - data;
+				data = nul + 1;
+				inHeader = false;
+			} else {
+				uncompressedBytes = 0;
+			}
+		}
+
+		if (uncompressedBytes > 0 && target.write(data, uncompressedBytes) != uncompressedBytes) {
+			break;
+		}
+
+		if (result == KFilterBase::End) {
+			ok = true;
+			break;
+		}
+	}
+
+	filter->terminate();
+	delete filter;
+
+	return ok;
+}
+
 Repo& ObjectStorage::repo() const
 {
 	return *d->repo;
 }
 
+bool ObjectStorage::writeObjectDataTo(const Id &id, QIODevice &device)
+{
+	QByteArray data = objectDataFor(id);
+	return device.write(data) == data.size();
+}
+
 void ObjectStorage::reset()
 {
 	invalidateIds();
@@ -34,6 +34,8 @@
 
 #include <QSharedDataPointer>
 
+class QIODevice;
+
 namespace Git {
 
 class ObjectStoragePrivate;
@@ -74,12 +76,38 @@ class KDE_EXPORT ObjectStorage : public QObject
 		virtual int              objectSizeFor(const Id &id) = 0;
 		virtual ObjectType       objectTypeFor(const Id &id) = 0;
 
+		/**
+		 * @brief Writes the object's raw data to @a device.
+		 *
+		 * Storages that can inflate an object in chunks override this, so
+		 * large blobs never have to be in memory at once. By default the
+		 * data is taken from objectDataFor().
+		 *
+		 * @param id The object's id.
+		 * @param device The device to write to (it has to be open).
+		 * @return Whether all of the data could be written.
+		 */
+		virtual bool writeObjectDataTo(const Id &id, QIODevice &device);
+
 	protected:
 		virtual void invalidateIds() = 0;
 		virtual void invalidateObjects() = 0;
 
 	// static
+		/**
+		 * @brief Compresses @a inflated into a zlib stream like Git does for loose objects.
+		 */
+		static const QByteArray deflate(const QByteArray &inflated);
 		static const QByteArray inflate(const QByteArray deflated);
+		/**
+		 * @brief Inflates the zlib stream read from @a source into @a target in chunks.
+		 *
+		 * @param source The device the stream is read from (from its current position).
+		 * @param target The device the inflated data is written to.
+		 * @param skipHeader Whether to drop the object header up to the first '\0' (as in loose objects).
+		 * @return Whether the whole stream could be inflated and written.
+		 */
+		static bool inflateTo(QIODevice &source, QIODevice &target, bool skipHeader = false);
 
 	protected:
 		QExplicitlySharedDataPointer<ObjectStoragePrivate> d;
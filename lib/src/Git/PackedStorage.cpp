@@ -394,6 +394,15 @@ int PackedStorage::size()
 	return d->size;
 }
 
+bool PackedStorage::writeObjectDataTo(const Id &id, QIODevice &device)
+{
+	if (!id.isValid()) {
+		return false;
+	}
+
+	return packObjectFor(id)->writeFinalDataTo(device);
+}
+
 
 
 #include "PackedStorage.moc"
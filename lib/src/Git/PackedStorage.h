@@ -50,6 +50,7 @@ class KDE_EXPORT PackedStorage : public ObjectStorage
 		int              objectSizeFor(const Id &id);
 		ObjectType       objectTypeFor(const Id &id);
 		int              size();
+		bool             writeObjectDataTo(const Id &id, QIODevice &device);
 
 	// static
 		static const QStringList allNamesIn(const Repo &repo);
@@ -313,6 +313,19 @@ inline ObjectType PackedStorageObject::type()
 	return d->type;
 }
 
+bool PackedStorageObject::writeFinalDataTo(QIODevice &device)
+{
+	if (isDeltified()) {
+		QByteArray data = patchedData();
+		return device.write(data) == data.size();
+	}
+
+	QFile &pack = d->storage->packFile();
+	pack.seek(d->dataOffset);
+
+	return ObjectStorage::inflateTo(pack, device);
+}
+
 
 
 #include "PackedStorageObject.moc"
@@ -51,6 +51,13 @@ class PackedStorageObject : public QObject
 //		const QString sha1();
 		quint32 size();
 		ObjectType type();
+		/**
+		 * @brief Writes finalData() to @a device.
+		 *
+		 * Undeltified objects are inflated from the pack in chunks. Deltified
+		 * objects have to be patched in memory first.
+		 */
+		bool writeFinalDataTo(QIODevice &device);
 
 	private:
 		void readHeader();
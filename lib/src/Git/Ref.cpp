@@ -19,6 +19,7 @@
 #include "Ref.h"
 #include "Ref_p.h"
 
+#include "RefDatabase.h"
 #include "Repo.h"
 
 #include <KDebug>
@@ -70,14 +71,11 @@ QList<Ref> Ref::all(const QString &remote, const QString &prefix) const
 {
 	QList<Ref> refs;
 
-	QDir refsDir = QDir(d->repo->gitDir());
-	refsDir.cd("refs");
-	refsDir.cd(remote);
-	refsDir.cd(prefix);
+	QString namePrefix = remote.isEmpty() ? QString("refs/%1/").arg(prefix) : QString("refs/%1/%2/").arg(remote).arg(prefix);
 
-	foreach (const QString &name, refsDir.entryList(QDir::Files)) {
-		//kDebug() << "ref found:" << name;
-		refs << Ref(remote, prefix, name, *d->repo);
+	foreach (const QString &fullName, d->repo->refDatabase()->names(namePrefix)) {
+		//kDebug() << "ref found:" << fullName;
+		refs << Ref(remote, prefix, fullName.mid(namePrefix.size()), *d->repo);
 	}
 
 	return refs;
@@ -103,7 +101,7 @@ Commit Ref::commit() const
 
 bool Ref::exists(const QString &name, const Repo &repo)
 {
-	return QFile::exists(QDir(repo.gitDir()).filePath(name));
+	return ((Repo&)repo).refDatabase()->contains(name); // non-const access
 }
 
 const QString Ref::fullName() const
@@ -121,19 +119,10 @@ const QString Ref::fullName() const
 
 QString Ref::fullNameFor(const QString &name, const Repo &repo)
 {
-	// see: http://www.kernel.org/pub/software/scm/git/docs/git-rev-parse.html#_specifying_revisions
-	QStringList searchPaths;
-	searchPaths << "%1" << "refs/%1" << "refs/tags/%1" << "refs/heads/%1" << "refs/remotes/%1" << "refs/remotes/%1/HEAD";
+	QString fullName = ((Repo&)repo).refDatabase()->fullNameFor(name); // non-const access
+	kDebug() << "Full ref name for" << name << "is" << fullName;
 
-	foreach (QString path, searchPaths) {
-		path = path.arg(name);
-		if (exists(path, repo)) {
-			kDebug() << "Full ref name for" << name << "is" << path;
-			return path;
-		}
-	}
-
-	return QString();
+	return fullName;
 }
 
 Ref Ref::head(const QString &name, Repo &repo)
@@ -167,17 +156,12 @@ bool Ref::operator==(const Ref &other) const
 
 void Ref::populate()
 {
-	QFile refFile(d->refsDir.filePath(d->name));
-	refFile.open(QFile::ReadOnly);
+	// the ref may be loose or packed
+	QString commitId = d->repo->refDatabase()->idFor(fullName());
 
-	QString commitId = refFile.readAll().trimmed();
-
-	//kDebug() << "reading head:" << refFile.fileName();
 	//kDebug() << "head content:" << commitId;
 
 	d->commitId = d->repo->idFor(commitId);
-
-	refFile.close();
 }
 
 const QString& Ref::prefix() const
@@ -147,7 +147,8 @@ class KDE_EXPORT Ref : public QObject
 		/**
 		 * @brief Looks up a refs full name in a given repo.
 		 *
-		 * It will look in the repo's git directory for refs with that name.
+		 * It will look up the repo's loose and packed refs with that name
+		 * without touching the file system.
 		 *
 		 * Examples:
 		 * @code
@@ -163,6 +164,7 @@ class KDE_EXPORT Ref : public QObject
 		 * @param repo The repo to look in.
 		 * @return The full ref path.
 		 *
+		 * @see RefDatabase::fullNameFor()
 		 * @see http://www.kernel.org/pub/software/scm/git/docs/git-rev-parse.html#_specifying_revisions
 		 */
 		static QString fullNameFor(const QString &name, const Repo &repo);
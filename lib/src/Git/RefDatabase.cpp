@@ -0,0 +1,507 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RefDatabase.h"
+
+#include <KDebug>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QtAlgorithms>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Git;
+
+
+
+#define PackedRefsHeader  "# pack-refs with:"
+#define Sha1HexSize       40
+#define MaxSymrefDepth    5
+
+
+
+static bool packedRefLessThan(const PackedRef &a, const PackedRef &b)
+{
+	return a.name < b.name;
+}
+
+/**
+ * Returns the position of the first packed ref not sorting before @a name.
+ */
+static int lowerBound(const QVector<PackedRef> &refs, const QByteArray &name)
+{
+	int low = 0;
+	int high = refs.size();
+
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if (refs[middle].name < name) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * Extracts the refs from the packed-refs file's content.
+ *
+ * @return The refs sorted by name.
+ */
+static QVector<PackedRef> parsePackedRefs(const char *data, qint64 size)
+{
+	QVector<PackedRef> refs;
+	bool isSorted = false;
+
+	const char *pos = data;
+	const char *end = data + size;
+	while (pos < end) {
+		const char *lf = (const char*)memchr(pos, '\n', end - pos);
+		if (!lf) {
+			lf = end;
+		}
+		int length = lf - pos;
+
+		if (*pos == '#') {
+			QByteArray header = QByteArray::fromRawData(pos, length);
+			if (header.startsWith(PackedRefsHeader)) {
+				isSorted = header.mid(strlen(PackedRefsHeader)).split(' ').contains("sorted");
+			}
+		} else if (*pos == '^') {
+			// the peeled id of the annotated tag above
+		} else if (length > Sha1HexSize + 1 && pos[Sha1HexSize] == ' ') {
+			PackedRef ref;
+			ref.id = QByteArray(pos, Sha1HexSize);
+			ref.name = QByteArray(pos + Sha1HexSize + 1, length - Sha1HexSize - 1);
+			refs << ref;
+		} else if (length > 0) {
+			kWarning() << "invalid line in packed-refs:" << QByteArray(pos, length);
+		}
+
+		pos = lf + 1;
+	}
+
+	// Git only writes the trait if it has sorted the refs, so others need sorting
+	if (!isSorted) {
+		qSort(refs.begin(), refs.end(), packedRefLessThan);
+	}
+
+	return refs;
+}
+
+/**
+ * Reads the packed-refs file at @a path.
+ */
+static QVector<PackedRef> readPackedRefs(const QString &path)
+{
+	QVector<PackedRef> refs;
+
+	QFile packedRefsFile(path);
+	if (!packedRefsFile.open(QFile::ReadOnly)) {
+		return refs;
+	}
+
+	qint64 size = packedRefsFile.size();
+	uchar *data = packedRefsFile.map(0, size);
+	if (data) {
+		refs = parsePackedRefs((const char*)data, size);
+		packedRefsFile.unmap(data);
+	} else {
+		QByteArray content = packedRefsFile.readAll();
+		refs = parsePackedRefs(content.constData(), content.size());
+	}
+	packedRefsFile.close();
+
+	kDebug() << "read" << refs.size() << "packed refs";
+
+	return refs;
+}
+
+/**
+ * Reads the first line of a ref file.
+ *
+ * @return The SHA1, "ref: <full name>" or a null string if the file does not exist.
+ */
+static QString readRefFile(const QString &path)
+{
+	QFile refFile(path);
+	if (!refFile.open(QFile::ReadOnly)) {
+		return QString();
+	}
+
+	return QString::fromUtf8(refFile.readLine().trimmed());
+}
+
+/**
+ * Appends an entry to the reflog at @a path.
+ *
+ * The log is only created for branches, just like Git does by default.
+ */
+static void appendToReflog(const QString &path, const QString &fullName, const QByteArray &entry)
+{
+	if (!QFile::exists(path) && !fullName.startsWith("refs/heads/") && fullName != "HEAD") {
+		return;
+	}
+
+	QFileInfo(path).dir().mkpath(".");
+
+	QFile reflog(path);
+	if (!reflog.open(QFile::WriteOnly | QFile::Append)) {
+		kWarning() << "Could not write reflog:" << path << reflog.errorString();
+		return;
+	}
+
+	reflog.write(entry);
+}
+
+/**
+ * Returns the parts of the stat data that change when a ref file is written.
+ *
+ * @return The stat data or an empty array if @a path does not exist.
+ */
+static QByteArray statDataFor(const QString &path)
+{
+	struct stat fileStat;
+	if (lstat(QFile::encodeName(path).constData(), &fileStat) != 0) {
+		return QByteArray();
+	}
+
+	QByteArray statData;
+	statData.append(QByteArray::number(qint64(fileStat.st_mtim.tv_sec))).append('.');
+	statData.append(QByteArray::number(qint64(fileStat.st_mtim.tv_nsec))).append(':');
+	statData.append(QByteArray::number(quint64(fileStat.st_ino))).append(':');
+	statData.append(QByteArray::number(qint64(fileStat.st_size)));
+
+	return statData;
+}
+
+/**
+ * Pseudo refs (e.g. "HEAD" or "ORIG_HEAD") live directly in the git dir.
+ */
+static bool isPseudoRef(const QString &name)
+{
+	if (name.isEmpty()) {
+		return false;
+	}
+
+	foreach (const QChar &c, name) {
+		if (c != '_' && (c < 'A' || c > 'Z')) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+RefDatabase::RefDatabase(const QString &gitDir, QObject *parent)
+	: QObject(parent)
+	, m_gitDir(gitDir)
+	, m_head()
+	, m_headStatData()
+	, m_looseRefs()
+	, m_looseStatData()
+	, m_packedRefs()
+	, m_packedRefsStatData()
+{
+	QDir dir(m_gitDir);
+
+	// the stat data is taken first, so changes while reading are noticed on refresh
+	m_headStatData = statDataFor(dir.filePath("HEAD"));
+	m_head = readRefFile(dir.filePath("HEAD"));
+
+	m_packedRefsStatData = statDataFor(dir.filePath("packed-refs"));
+	m_packedRefs = readPackedRefs(dir.filePath("packed-refs"));
+
+	m_looseStatData = looseRefStatData();
+	foreach (const QString &name, m_looseStatData.keys()) {
+		QString value = readRefFile(dir.filePath(name));
+		if (!value.isNull()) {
+			m_looseRefs.insert(name, value);
+		}
+	}
+}
+
+
+
+bool RefDatabase::contains(const QString &fullName) const
+{
+	return !valueOf(fullName).isNull();
+}
+
+QString RefDatabase::fullNameFor(const QString &name) const
+{
+	// see: http://www.kernel.org/pub/software/scm/git/docs/git-rev-parse.html#_specifying_revisions
+	QStringList searchPaths;
+	searchPaths << "%1" << "refs/%1" << "refs/tags/%1" << "refs/heads/%1" << "refs/remotes/%1" << "refs/remotes/%1/HEAD";
+
+	foreach (QString path, searchPaths) {
+		path = path.arg(name);
+		if (contains(path)) {
+			return path;
+		}
+	}
+
+	return QString();
+}
+
+QString RefDatabase::idFor(const QString &fullName) const
+{
+	QString value = valueOf(fullName);
+
+	for (int depth=0; value.startsWith("ref:") && depth < MaxSymrefDepth; ++depth) {
+		value = valueOf(value.mid(4).trimmed());
+	}
+
+	if (value.startsWith("ref:")) {
+		kWarning() << "symbolic ref" << fullName << "is nested too deep";
+		return QString();
+	}
+
+	return value;
+}
+
+QHash<QString, QByteArray> RefDatabase::looseRefStatData() const
+{
+	QHash<QString, QByteArray> statData;
+	QDir gitDir(m_gitDir);
+
+	QDirIterator it(gitDir.filePath("refs"), QDir::Files, QDirIterator::Subdirectories);
+	while (it.hasNext()) {
+		QString path = it.next();
+		if (path.endsWith(".lock")) {
+			continue;
+		}
+
+		statData.insert(gitDir.relativeFilePath(path), statDataFor(path));
+	}
+
+	return statData;
+}
+
+QStringList RefDatabase::names(const QString &prefix) const
+{
+	QSet<QString> names;
+
+	QByteArray packedPrefix = prefix.toUtf8();
+	for (int i=lowerBound(m_packedRefs, packedPrefix); i < m_packedRefs.size(); ++i) {
+		if (!m_packedRefs[i].name.startsWith(packedPrefix)) {
+			break;
+		}
+		names << QString::fromUtf8(m_packedRefs[i].name);
+	}
+
+	foreach (const QString &name, m_looseRefs.keys()) {
+		if (name.startsWith(prefix)) {
+			names << name;
+		}
+	}
+
+	QStringList result = names.toList();
+	qSort(result);
+
+	return result;
+}
+
+void RefDatabase::refresh()
+{
+	QDir dir(m_gitDir);
+	QSet<QString> affectedNames;
+
+	// symbolic refs may have moved with their targets without being written
+	affectedNames << "HEAD";
+	QHash<QString, QString>::const_iterator loose;
+	for (loose = m_looseRefs.constBegin(); loose != m_looseRefs.constEnd(); ++loose) {
+		if (loose.value().startsWith("ref:")) {
+			affectedNames << loose.key();
+		}
+	}
+
+	QByteArray headStatData = statDataFor(dir.filePath("HEAD"));
+	bool headChanged = headStatData != m_headStatData;
+
+	QByteArray packedRefsStatData = statDataFor(dir.filePath("packed-refs"));
+	QVector<PackedRef> packedRefs = m_packedRefs;
+	if (packedRefsStatData != m_packedRefsStatData) {
+		packedRefs = readPackedRefs(dir.filePath("packed-refs"));
+
+		foreach (const PackedRef &ref, m_packedRefs) {
+			affectedNames << QString::fromUtf8(ref.name);
+		}
+		foreach (const PackedRef &ref, packedRefs) {
+			affectedNames << QString::fromUtf8(ref.name);
+		}
+	}
+
+	QHash<QString, QByteArray> looseStatData = looseRefStatData();
+	QStringList changedLooseRefs;
+	QHash<QString, QByteArray>::const_iterator file;
+	for (file = looseStatData.constBegin(); file != looseStatData.constEnd(); ++file) {
+		QHash<QString, QByteArray>::const_iterator known = m_looseStatData.constFind(file.key());
+		if (known == m_looseStatData.constEnd() || known.value() != file.value()) {
+			changedLooseRefs << file.key();
+		}
+	}
+	QStringList deletedLooseRefs;
+	foreach (const QString &name, m_looseStatData.keys()) {
+		if (!looseStatData.contains(name)) {
+			deletedLooseRefs << name;
+		}
+	}
+	affectedNames += changedLooseRefs.toSet();
+	affectedNames += deletedLooseRefs.toSet();
+
+	// remember where the affected refs pointed to before updating the snapshot
+	QHash<QString, QString> oldIds;
+	foreach (const QString &name, affectedNames) {
+		oldIds.insert(name, idFor(name));
+	}
+
+	if (headChanged) {
+		m_headStatData = headStatData;
+		m_head = readRefFile(dir.filePath("HEAD"));
+	}
+
+	m_packedRefsStatData = packedRefsStatData;
+	m_packedRefs = packedRefs;
+
+	foreach (const QString &name, changedLooseRefs) {
+		QString value = readRefFile(dir.filePath(name));
+		if (value.isNull()) {
+			m_looseRefs.remove(name);
+		} else {
+			m_looseRefs.insert(name, value);
+		}
+	}
+	foreach (const QString &name, deletedLooseRefs) {
+		m_looseRefs.remove(name);
+	}
+	m_looseStatData = looseStatData;
+
+	QStringList names = affectedNames.toList();
+	qSort(names);
+	foreach (const QString &name, names) {
+		QString oldId = oldIds[name];
+		QString newId = idFor(name);
+
+		if (oldId == newId) {
+			continue;
+		} else if (oldId.isEmpty()) {
+			kDebug() << "ref added:" << name;
+			emit refAdded(name, newId);
+		} else if (newId.isEmpty()) {
+			kDebug() << "ref deleted:" << name;
+			emit refDeleted(name, oldId);
+		} else {
+			kDebug() << "ref moved:" << name;
+			emit refMoved(name, oldId, newId);
+		}
+	}
+}
+
+bool RefDatabase::update(const QString &fullName, const QString &newId, const QString &oldId, const QString &identity, const QString &message)
+{
+	Q_ASSERT(fullName.startsWith("refs/"));
+	Q_ASSERT(newId.size() == Sha1HexSize);
+
+	QString refPath = QDir(m_gitDir).filePath(fullName);
+	QString lockPath = refPath + ".lock";
+
+	QFileInfo(refPath).dir().mkpath(".");
+
+	// the lock file must not exist, otherwise someone else is updating the ref
+	int lockFd = ::open(QFile::encodeName(lockPath).constData(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+	if (lockFd < 0) {
+		kWarning() << "Could not lock ref:" << lockPath << strerror(errno);
+		return false;
+	}
+
+	// only loose refs are updated by others while we are running
+	QString currentId = readRefFile(refPath);
+	if (currentId.isNull()) {
+		currentId = valueOf(fullName);
+	}
+
+	if (currentId != oldId) {
+		kWarning() << "Not updating" << fullName << "which points to" << currentId << "instead of" << oldId;
+		::close(lockFd);
+		QFile::remove(lockPath);
+		return false;
+	}
+
+	QByteArray value = newId.toLatin1() + '\n';
+	bool written = ::write(lockFd, value.constData(), value.size()) == value.size();
+	written = ::close(lockFd) == 0 && written;
+
+	if (!written || ::rename(QFile::encodeName(lockPath).constData(), QFile::encodeName(refPath).constData()) != 0) {
+		kWarning() << "Could not update ref:" << refPath << strerror(errno);
+		QFile::remove(lockPath);
+		return false;
+	}
+
+	QByteArray entry = (oldId.isEmpty() ? QByteArray(Sha1HexSize, '0') : oldId.toLatin1());
+	entry += ' ' + newId.toLatin1() + ' ' + identity.toUtf8() + '\t' + message.toUtf8() + '\n';
+
+	appendToReflog(QDir(m_gitDir).filePath("logs/" + fullName), fullName, entry);
+	if (m_head == "ref: " + fullName) {
+		appendToReflog(QDir(m_gitDir).filePath("logs/HEAD"), "HEAD", entry);
+	}
+
+	return true;
+}
+
+QString RefDatabase::valueOf(const QString &fullName) const
+{
+	if (fullName.startsWith("refs/")) {
+		QHash<QString, QString>::const_iterator loose = m_looseRefs.constFind(fullName);
+		if (loose != m_looseRefs.constEnd()) {
+			return loose.value();
+		}
+
+		QByteArray name = fullName.toUtf8();
+		int position = lowerBound(m_packedRefs, name);
+		if (position < m_packedRefs.size() && m_packedRefs[position].name == name) {
+			return QString::fromLatin1(m_packedRefs[position].id);
+		}
+	} else if (fullName == "HEAD") {
+		return m_head;
+	} else if (isPseudoRef(fullName)) {
+		// the other pseudo refs change all the time, so they are not part of the snapshot
+		QString value = readRefFile(QDir(m_gitDir).filePath(fullName));
+		// e.g. FETCH_HEAD has more than just the id on its lines
+		if (!value.isNull()) {
+			return value.startsWith("ref:") ? value : value.left(Sha1HexSize);
+		}
+	}
+
+	return QString();
+}
+
+#include "RefDatabase.moc"
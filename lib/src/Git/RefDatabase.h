@@ -0,0 +1,194 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief A snapshot of all refs of a repo.
+ */
+
+#ifndef REFDATABASE_H
+#define REFDATABASE_H
+
+#include <QObject>
+
+#include <kdemacros.h>
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+
+
+class RefDatabaseTest;
+
+namespace Git {
+
+/**
+ * A ref as it is listed in the packed-refs file.
+ */
+struct PackedRef {
+	/** The full name (e.g. "refs/heads/master"). */
+	QByteArray name;
+	/** The SHA1 the ref points to as hex string. */
+	QByteArray id;
+};
+
+
+
+/**
+ * @brief A snapshot of all refs of a repo.
+ *
+ * It reads HEAD, the packed-refs file and all loose refs below refs/ only
+ * once. Loose refs take precedence over packed ones, just like in Git.
+ * Lookups do not touch the file system (except for other pseudo refs like
+ * "ORIG_HEAD" or "FETCH_HEAD").
+ *
+ * The packed refs are kept sorted, so they can be found by binary search.
+ * If the file has been written with the "sorted" trait they are not sorted
+ * again.
+ *
+ * The snapshot only changes on refresh(). It remembers the stat data of
+ * every file it has read and only reads the files again that have changed.
+ */
+class KDE_EXPORT RefDatabase : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/**
+		 * @brief Reads the refs in @a gitDir.
+		 */
+		explicit RefDatabase(const QString &gitDir, QObject *parent = 0);
+
+		/**
+		 * @brief Checks whether there is a ref with the given full name.
+		 *
+		 * @param fullName The full name (e.g. "refs/heads/master" or "HEAD").
+		 */
+		bool contains(const QString &fullName) const;
+
+		/**
+		 * @brief Looks up the full name of a ref like "git rev-parse" does.
+		 *
+		 * It will try "<name>", "refs/<name>", "refs/tags/<name>",
+		 * "refs/heads/<name>", "refs/remotes/<name>" and
+		 * "refs/remotes/<name>/HEAD" in that order.
+		 *
+		 * @param name The short name of the ref (e.g. "master" or "origin/feature-x").
+		 * @return The full name or a null string if there is no such ref.
+		 *
+		 * @see http://www.kernel.org/pub/software/scm/git/docs/git-rev-parse.html#_specifying_revisions
+		 */
+		QString fullNameFor(const QString &name) const;
+
+		/**
+		 * @brief Returns the SHA1 a ref points to.
+		 *
+		 * Symbolic refs (e.g. "refs/remotes/origin/HEAD") are followed.
+		 *
+		 * @param fullName The full name (e.g. "refs/heads/master" or "HEAD").
+		 * @return The SHA1 or a null string if the ref does not exist.
+		 */
+		QString idFor(const QString &fullName) const;
+
+		/**
+		 * @brief Returns the full names of all refs starting with @a prefix.
+		 *
+		 * @param prefix The start of the names (e.g. "refs/heads/").
+		 * @return The sorted names.
+		 */
+		QStringList names(const QString &prefix = QString("refs/")) const;
+
+		/**
+		 * @brief Points a ref at another commit like "git update-ref" does.
+		 *
+		 * The new value is written into "<ref>.lock" which is then renamed, so
+		 * concurrent writers fail instead of overwriting each other. The update
+		 * is refused if the ref on disk does not point to @a oldId anymore.
+		 *
+		 * The move is recorded in the ref's reflog (and in HEAD's if HEAD
+		 * points to the ref). The snapshot itself only changes on refresh().
+		 *
+		 * @param fullName The full name of a non-symbolic ref (e.g. "refs/heads/master").
+		 * @param newId The SHA1 the ref should point to.
+		 * @param oldId The SHA1 the ref is expected to point to or a null string if it should not exist yet.
+		 * @param identity The identity for the reflog (e.g. "Me <me@some.tld> 1234567890 +0100").
+		 * @param message The message for the reflog (e.g. "commit: Added some file.").
+		 * @return Whether the ref has been updated.
+		 */
+		bool update(const QString &fullName, const QString &newId, const QString &oldId, const QString &identity, const QString &message);
+
+	public slots:
+		/**
+		 * @brief Updates the snapshot with the refs that have changed on disk.
+		 *
+		 * Only files whose stat data (modification time, inode or size) has
+		 * changed are read again. Git replaces ref files when it updates them,
+		 * so even changes in the same second are noticed.
+		 *
+		 * For every ref that has changed one of refAdded(), refDeleted() or
+		 * refMoved() is emitted. This includes symbolic refs (e.g. "HEAD")
+		 * whose target has changed.
+		 */
+		void refresh();
+
+	signals:
+		/**
+		 * @brief This is emitted by refresh() for refs that have been created.
+		 */
+		void refAdded(const QString &fullName, const QString &id);
+
+		/**
+		 * @brief This is emitted by refresh() for refs that have been deleted.
+		 */
+		void refDeleted(const QString &fullName, const QString &oldId);
+
+		/**
+		 * @brief This is emitted by refresh() for refs that point to another commit.
+		 */
+		void refMoved(const QString &fullName, const QString &oldId, const QString &newId);
+
+	private:
+		/**
+		 * @brief Returns the stat data of all loose refs below refs/.
+		 */
+		QHash<QString, QByteArray> looseRefStatData() const;
+
+		/**
+		 * @brief Returns the content of a ref without following symbolic refs.
+		 *
+		 * @return The SHA1, "ref: <full name>" for symbolic refs or a null string if there is no such ref.
+		 */
+		QString valueOf(const QString &fullName) const;
+
+	private:
+		QString m_gitDir;
+		QString m_head;
+		QByteArray m_headStatData;
+		QHash<QString, QString> m_looseRefs;
+		QHash<QString, QByteArray> m_looseStatData;
+		QVector<PackedRef> m_packedRefs;
+		QByteArray m_packedRefsStatData;
+
+		friend class ::RefDatabaseTest;
+};
+
+}
+
+#endif // REFDATABASE_H
@@ -20,21 +20,212 @@
 #include "Repo_p.h"
 
 #include "gitrunner.h"
+#include "ActorTable.h"
 #include "Blob.h"
+#include "CatFileProcess.h"
 #include "Commit.h"
+#include "CommitCache.h"
+#include "Index.h"
 #include "LooseStorage.h"
 #include "PackedStorage.h"
+#include "RefDatabase.h"
 #include "Status.h"
 #include "Tree.h"
+#include "TreeDiff.h"
 
 #include <KMessageBox>
 
 #include <QDir>
+#include <QHash>
+#include <QFileInfo>
 
 using namespace Git;
 
 
 
+#define EmptyTreeId  "4b825dc642cb6eb9a060e54bf8d69288fbee4904"
+/** The number of tree entries (of all trees) kept by treeEntries(). */
+#define MaxCachedTreeEntries  (100*1000)
+
+
+
+/**
+ * Cleans up a commit message like "git commit --cleanup=whitespace" does.
+ *
+ * Trailing whitespace, leading and trailing empty lines and repeated empty
+ * lines are removed.
+ *
+ * @return The message ending with a newline or a null string if it is empty.
+ */
+static QString cleanedUpMessage(const QString &message)
+{
+	QStringList lines;
+	bool pendingEmptyLine = false;
+
+	foreach (QString line, message.split('\n')) {
+		int end = line.size();
+		while (end > 0 && line[end-1].isSpace()) {
+			--end;
+		}
+		line.truncate(end);
+
+		if (line.isEmpty()) {
+			// leading empty lines are dropped
+			pendingEmptyLine = !lines.isEmpty();
+			continue;
+		}
+
+		if (pendingEmptyLine) {
+			lines << QString();
+			pendingEmptyLine = false;
+		}
+		lines << line;
+	}
+
+	if (lines.isEmpty()) {
+		return QString();
+	}
+
+	return lines.join("\n") + '\n';
+}
+
+/**
+ * Checks whether the config asks "git commit" for more than we do in process
+ * (i.e. hooks from core.hooksPath, signing or an encoding other than UTF-8).
+ */
+static bool hasCommitConfig(const QString &workingDir)
+{
+	GitRunner runner;
+	runner.setDirectory(workingDir);
+
+	// Git fails without any output if none of them is set
+	if (runner.config(QStringList() << "--get-regexp" << "^(core\\.hookspath|commit\\.gpgsign|i18n\\.commitencoding)$") != DvcsJob::JobSucceeded) {
+		return !runner.getResult().trimmed().isEmpty();
+	}
+
+	// the last value of a key wins
+	QHash<QString, QString> values;
+	foreach (const QString &line, runner.getResult().split('\n', QString::SkipEmptyParts)) {
+		values[line.section(' ', 0, 0).toLower()] = line.section(' ', 1).trimmed().toLower();
+	}
+
+	if (values.contains("core.hookspath")) {
+		return true;
+	}
+
+	if (values.contains("commit.gpgsign")) {
+		QString gpgSign = values["commit.gpgsign"];
+		if (!(gpgSign == "false" || gpgSign == "no" || gpgSign == "off" || gpgSign == "0")) {
+			return true;
+		}
+	}
+
+	if (values.contains("i18n.commitencoding")) {
+		QString encoding = values["i18n.commitencoding"];
+		if (encoding != "utf-8" && encoding != "utf8") {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Checks whether any of the hooks "git commit" would run are enabled.
+ */
+static bool hasCommitHooks(const QString &gitDir)
+{
+	QStringList hooks;
+	hooks << "pre-commit" << "prepare-commit-msg" << "commit-msg" << "post-commit";
+
+	foreach (const QString &hook, hooks) {
+		QFileInfo hookFile(gitDir + "/hooks/" + hook);
+		if (hookFile.isFile() && hookFile.isExecutable()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Returns the full name of the branch HEAD points to.
+ *
+ * @return The full name (e.g. "refs/heads/master") or a null string if HEAD is detached.
+ */
+static QString headBranchIn(const QString &gitDir)
+{
+	QFile headFile(gitDir + "/HEAD");
+	if (!headFile.open(QFile::ReadOnly)) {
+		return QString();
+	}
+
+	QByteArray head = headFile.readLine().trimmed();
+	if (!head.startsWith("ref: refs/")) {
+		return QString();
+	}
+
+	return QString::fromUtf8(head.mid(5)); // 5 == "ref: ".length
+}
+
+/**
+ * Writes the trees for the index entries below @a prefix like "git write-tree" does.
+ *
+ * Trees that are still cached in the index are not written again.
+ *
+ * @param prefix The directory with a trailing slash ("" for the root).
+ * @param position The position of the first entry below @a prefix. It will be moved behind the last one.
+ * @return The tree's SHA1 or a null string if it could not be written.
+ */
+static QString writeTreeFor(LooseStorage &storage, const Index &index, const QString &prefix, int &position)
+{
+	const QVector<IndexEntry> &entries = index.entries();
+	QByteArray treeData;
+
+	// entries are sorted by path, which is the order of entries in trees too
+	while (position < entries.size() && entries[position].path.startsWith(prefix)) {
+		const IndexEntry &entry = entries[position];
+		int slash = entry.path.indexOf('/', prefix.size());
+
+		if (slash < 0) {
+			// entries that have only been announced with "git add -N" are left out
+			if (!entry.isIntentToAdd()) {
+				treeData += QByteArray::number(entry.mode, 8) + ' ' + entry.path.mid(prefix.size()).toUtf8();
+				treeData += '\0';
+				treeData += QByteArray((const char*)entry.sha1, 20);
+			}
+			++position;
+			continue;
+		}
+
+		QString directory = entry.path.left(slash);
+		QString treeId = index.cachedTreeId(directory);
+		if (!treeId.isNull()) {
+			position += index.cachedTreeEntryCount(directory);
+		} else {
+			treeId = writeTreeFor(storage, index, directory + '/', position);
+			if (treeId.isNull()) {
+				return QString();
+			}
+		}
+
+		if (treeId != EmptyTreeId) {
+			treeData += "40000 " + directory.mid(prefix.size()).toUtf8();
+			treeData += '\0';
+			treeData += QByteArray::fromHex(treeId.toLatin1());
+		}
+	}
+
+	Id treeId = storage.writeObject(OBJ_TREE, treeData);
+	if (!treeId.isValid()) {
+		return QString();
+	}
+
+	return treeId.toSha1String();
+}
+
+
+
 Repo::Repo(const QString &workingDir, QObject *parent)
 	: QObject(parent)
 	, d(new RepoPrivate)
@@ -42,6 +233,9 @@ Repo::Repo(const QString &workingDir, QObject *parent)
 	d->gitDir = workingDir + "/.git";
 	d->workingDir = workingDir;
 	d->looseStorage = new LooseStorage(*this);
+	d->actors = QSharedPointer<ActorTable>(new ActorTable());
+	d->treeEntries = QSharedPointer<QCache<QString, QVector<TreeEntry> > >(new QCache<QString, QVector<TreeEntry> >(MaxCachedTreeEntries));
+	d->untrackedCache = UntrackedCache::forWorkingDir(workingDir);
 }
 
 Repo::Repo(const Repo &other)
@@ -57,11 +251,25 @@ Repo::~Repo()
 
 
 
+ActorTable* Repo::actors()
+{
+	return d->actors.data();
+}
+
 Blob& Repo::blob(const Id &id)
 {
 	return id.object().toBlob();
 }
 
+CatFileProcess* Repo::catFileProcess()
+{
+	if (!d->catFileProcess) {
+		d->catFileProcess = QSharedPointer<CatFileProcess>(new CatFileProcess(workingDir()));
+	}
+
+	return d->catFileProcess.data();
+}
+
 void Repo::clone(const QString &fromRepo, const QString &toDirectory, const QStringList &options)
 {
 	GitRunner runner;
@@ -72,6 +280,11 @@ void Repo::clone(const QString &fromRepo, const QString &toDirectory, const QStr
 
 void Repo::commitIndex(const QString &message, const QStringList &options)
 {
+	// options (e.g. "--amend"), hooks and config changing the commit are left to Git
+	if (options.isEmpty() && !hasCommitHooks(gitDir()) && !hasCommitConfig(workingDir()) && commitIndexInProcess(message)) {
+		return;
+	}
+
 	GitRunner runner;
 	runner.setDirectory(workingDir());
 
@@ -80,14 +293,107 @@ void Repo::commitIndex(const QString &message, const QStringList &options)
 
 	runner.commit(opts);
 
-	resetCommits();
-	resetRefs();
 	resetLooseStorage();
 	resetStatus();
 
-	emit headsChanged();
 	emit indexChanged();
-	emit historyChanged();
+
+	// only the current branch has moved
+	refreshRefs();
+}
+
+bool Repo::commitIndexInProcess(const QString &message)
+{
+	// merges and cherry-picks need the additional parents and messages Git keeps
+	if (QFile::exists(gitDir() + "/MERGE_HEAD") || QFile::exists(gitDir() + "/CHERRY_PICK_HEAD")) {
+		return false;
+	}
+
+	QString branch = headBranchIn(gitDir());
+	if (branch.isNull()) {
+		return false;
+	}
+
+	Index index(*this);
+	if (!index.isValid()) {
+		return false;
+	}
+	foreach (const IndexEntry &entry, index.entries()) {
+		if (entry.stage() != 0) {
+			return false;
+		}
+	}
+
+	// Git refuses to commit without a message
+	QString cleanMessage = cleanedUpMessage(message);
+	if (cleanMessage.isNull()) {
+		return true;
+	}
+
+	// someone else may have committed in the meantime
+	refreshRefs();
+	QString parentId = refDatabase()->idFor(branch);
+
+	QString treeId = index.cachedTreeId(QString());
+	if (treeId.isNull()) {
+		int position = 0;
+		treeId = writeTreeFor(*d->looseStorage, index, QString(), position);
+		if (treeId.isNull()) {
+			return false;
+		}
+	}
+
+	// Git refuses to commit if nothing has changed
+	if (parentId.isNull() ? treeId == EmptyTreeId : treeId == commit(idFor(parentId)).tree().id().toSha1String()) {
+		return true;
+	}
+
+	// Git knows best where the identities come from (environment, config, system)
+	GitRunner runner;
+	runner.setDirectory(workingDir());
+	if (runner.var("GIT_AUTHOR_IDENT") != DvcsJob::JobSucceeded) {
+		return false;
+	}
+	QString author = runner.getResult().trimmed();
+	if (runner.var("GIT_COMMITTER_IDENT") != DvcsJob::JobSucceeded) {
+		return false;
+	}
+	QString committer = runner.getResult().trimmed();
+
+	QByteArray commitData = "tree " + treeId.toLatin1() + '\n';
+	if (!parentId.isNull()) {
+		commitData += "parent " + parentId.toLatin1() + '\n';
+	}
+	commitData += "author " + author.toUtf8() + '\n';
+	commitData += "committer " + committer.toUtf8() + '\n';
+	commitData += '\n';
+	commitData += cleanMessage.toUtf8();
+
+	Id commitId = d->looseStorage->writeObject(OBJ_COMMIT, commitData);
+	if (!commitId.isValid()) {
+		return false;
+	}
+
+	QString reflogMessage = QString(parentId.isNull() ? "commit (initial): %1" : "commit: %1").arg(cleanMessage.section('\n', 0, 0));
+	if (!refDatabase()->update(branch, commitId.toSha1String(), parentId, committer, reflogMessage)) {
+		return false;
+	}
+
+	// the new commit is the only one the branch has gained
+	QList<Commit> history = d->commits.value(branch);
+	bool hadHistory = d->commits.contains(branch);
+
+	resetStatus();
+
+	emit indexChanged();
+
+	refreshRefs();
+
+	if (hadHistory) {
+		d->commits[branch] = QList<Commit>() << commit(commitId) << history;
+	}
+
+	return true;
 }
 
 Commit& Repo::commit(const Id &id)
@@ -95,6 +401,15 @@ Commit& Repo::commit(const Id &id)
 	return id.object().toCommit();
 }
 
+CommitCache* Repo::commitCache()
+{
+	if (!d->commitCache) {
+		d->commitCache = CommitCache::forGitDir(gitDir());
+	}
+
+	return d->commitCache.data();
+}
+
 QList<Commit> Repo::commits(const QString &branch)
 {
 	Ref branchRef = ref(branch);
@@ -139,12 +454,19 @@ const Ref& Repo::currentHead()
 
 QString Repo::diff(const Commit &a, const Commit &b) const
 {
-	GitRunner runner;
-	runner.setDirectory(workingDir());
+	// non-const access for loading objects
+	Commit commitA = a;
+	Commit commitB = b;
+	TreeDiff treeDiff(*(Repo*)this, commitA.tree().id().toSha1String(), commitB.tree().id().toSha1String());
+	treeDiff.detectRenames();
 
-	runner.diffCommits(a.id().toSha1String(), b.id().toSha1String());
+	return treeDiff.unifiedDiff();
+}
 
-	return runner.getResult();
+void Repo::forgetRef(const QString &fullName)
+{
+	d->refs.remove(fullName);
+	d->commits.remove(fullName);
 }
 
 const QString& Repo::gitDir() const
@@ -164,20 +486,18 @@ void Repo::init(const QString &newRepoPath)
 	}
 }
 
+bool Repo::hasStatus() const
+{
+	return d->status != 0;
+}
+
 QList<Ref> Repo::heads()
 {
 	QList<Ref> refs;
 
-	if (d->refs.isEmpty()) {
-		foreach (const Ref &head, Ref(*this).allHeads()) {
-			d->refs[head.fullName()] = head;
-		}
-	}
-
-	foreach (const Ref &ref, d->refs.values()) {
-		if (!ref.isRemote() && ref.prefix() == "heads") {
-			refs << ref;
-		}
+	// the names come from the ref database, so added or deleted heads are never missed
+	foreach (const QString &fullName, refDatabase()->names("refs/heads/")) {
+		refs << ref(fullName);
 	}
 
 	return refs;
@@ -205,12 +525,13 @@ const Ref& Repo::ref(const QString &name)
 		QStringList parts = fullName.split("/");
 		Q_ASSERT(parts[0] == "refs");
 		parts.removeFirst();
+		Q_ASSERT(parts.size() >= 2);
 
-		if (parts.size() == 2) {
-			ref = Ref(QString(), parts[0], parts[1], *this);
+		// names may contain slashes themselves (e.g. "refs/heads/feature/x")
+		if (parts[0] == "remotes" && parts.size() >= 3) {
+			ref = Ref(parts[0], parts[1], QStringList(parts.mid(2)).join("/"), *this);
 		} else {
-			Q_ASSERT(parts.size() == 3);
-			ref = Ref(parts[0], parts[1], parts[2], *this);
+			ref = Ref(QString(), parts[0], QStringList(parts.mid(1)).join("/"), *this);
 		}
 
 		d->refs[fullName] = ref;
@@ -219,15 +540,46 @@ const Ref& Repo::ref(const QString &name)
 	return d->refs[fullName];
 }
 
+RefDatabase* Repo::refDatabase()
+{
+	if (!d->refDatabase) {
+		d->refDatabase = new RefDatabase(gitDir(), this);
+
+		// the cached refs have to be dropped before anyone else is notified
+		connect(d->refDatabase, SIGNAL(refAdded(QString,QString)), this, SLOT(forgetRef(QString)));
+		connect(d->refDatabase, SIGNAL(refDeleted(QString,QString)), this, SLOT(forgetRef(QString)));
+		connect(d->refDatabase, SIGNAL(refMoved(QString,QString,QString)), this, SLOT(forgetRef(QString)));
+
+		connect(d->refDatabase, SIGNAL(refAdded(QString,QString)), this, SIGNAL(refAdded(QString,QString)));
+		connect(d->refDatabase, SIGNAL(refDeleted(QString,QString)), this, SIGNAL(refDeleted(QString,QString)));
+		connect(d->refDatabase, SIGNAL(refMoved(QString,QString,QString)), this, SIGNAL(refMoved(QString,QString,QString)));
+	}
+
+	return d->refDatabase;
+}
+
+void Repo::refreshRefs()
+{
+	// nothing has been loaded that could be outdated
+	if (!d->refDatabase) {
+		return;
+	}
+
+	d->refDatabase->refresh();
+}
+
 void Repo::reset()
 {
+	d->treeEntries->clear();
+
 	resetCommits();
-	resetRefs();
 	resetLooseStorage();
 	resetPackedStorages();
 	resetStatus();
 
-	emit headsChanged();
+	// the refs are kept up to date with the refs on disk and will not be read entirely again
+	refreshRefs();
+
 	emit historyChanged();
 	emit indexChanged();
 }
@@ -244,11 +596,15 @@ void Repo::resetRefs()
 	if (!d->refs.isEmpty()) {
 		d->refs.clear();
 	}
+
+	delete d->refDatabase;
+	d->refDatabase = 0;
 }
 
 void Repo::resetStatus()
 {
 	/** @todo make Status smarter to detect only changed files */
+	// the untracked cache survives, so the next status only reads changed directories
 	delete d->status;
 	d->status = 0;
 }
@@ -271,6 +627,19 @@ void Repo::resetPackedStorages()
 	d->storages << d->looseStorage;
 }
 
+void Repo::setStatus(Status *status)
+{
+	Q_ASSERT(status);
+	Q_ASSERT(status->thread() == thread());
+
+	if (d->status != status) {
+		delete d->status;
+	}
+
+	status->setRepo(this);
+	d->status = status;
+}
+
 void Repo::stageFiles(const QStringList &paths)
 {
 	GitRunner runner;
@@ -278,8 +647,7 @@ void Repo::stageFiles(const QStringList &paths)
 
 	runner.add(paths, QStringList());
 
-	resetStatus();
-	emit indexChanged();
+	updateStatusOf(paths);
 }
 
 Status* Repo::status()
@@ -321,6 +689,25 @@ Tree& Repo::tree(const Id &id)
 	return id.object().toTree();
 }
 
+const QVector<TreeEntry> Repo::treeEntries(const QString &treeId)
+{
+	QVector<TreeEntry> *cachedEntries = d->treeEntries->object(treeId);
+	if (cachedEntries) {
+		return *cachedEntries;
+	}
+
+	Id id = idFor(treeId);
+	if (!id.exists() || !id.object().isTree()) {
+		return QVector<TreeEntry>();
+	}
+
+	// the cache is bounded by the number of entries, not of trees
+	QVector<TreeEntry> entries = tree(id).rawEntries();
+	d->treeEntries->insert(treeId, new QVector<TreeEntry>(entries), qMax(1, entries.size()));
+
+	return entries;
+}
+
 void Repo::unstageFiles(const QStringList &paths)
 {
 	GitRunner runner;
@@ -336,8 +723,22 @@ void Repo::unstageFiles(const QStringList &paths)
 		runner.reset(paths, QStringList(), "HEAD");
 	}
 
-	resetStatus();
-	emit indexChanged();
+	updateStatusOf(paths);
+}
+
+void Repo::updateStatusOf(const QStringList &paths)
+{
+	if (d->status) {
+		d->status->update(paths);
+		emit statusUpdated();
+	} else {
+		emit indexChanged();
+	}
+}
+
+UntrackedCache* Repo::untrackedCache() const
+{
+	return d->untrackedCache.data();
 }
 
 const QString& Repo::workingDir() const
@@ -33,22 +33,30 @@
 
 #include <QSharedDataPointer>
 #include <QStringList>
+#include <QVector>
 
+class RepoCommitIndexTest;
 class RepoCommitsCachingTest;
 class RepoHeadsCachingTest;
 class RepoStatusCachingTest;
 
 namespace Git {
 
+class ActorTable;
 class Blob;
+class CatFileProcess;
 class Commit;
+class CommitCache;
 class Id;
 class ObjectStorage;
 class RawObject;
 class Ref;
+class RefDatabase;
 class RepoPrivate;
 class Status;
 class Tree;
+class TreeEntry;
+class UntrackedCache;
 
 
 
@@ -73,9 +81,30 @@ class KDE_EXPORT Repo : public QObject
 		Repo(const Repo &other);
 		virtual ~Repo();
 
+		/**
+		 * @brief Returns the table of the authors and committers of this repo's commits.
+		 *
+		 * It lives as long as the repo and is not affected by resets.
+		 */
+		ActorTable* actors();
 		Blob& blob(const Id &id);
+		/**
+		 * @brief Returns the "git cat-file --batch" process for reading objects through Git.
+		 *
+		 * Only objects that can not be read natively should be read with it.
+		 * The process is started on first use and lives as long as the repo.
+		 */
+		CatFileProcess* catFileProcess();
 		Commit& commit(const Id &id);
 
+		/**
+		 * @brief Returns the cache keeping the parsed commits across sessions.
+		 *
+		 * It is shared by all repo objects of the repository and is not
+		 * affected by resets.
+		 */
+		CommitCache* commitCache();
+
 		/**
 		 * @brief Returns the proper @link Git::Id Id @endlink object for a given string.
 		 *
@@ -95,13 +124,50 @@ class KDE_EXPORT Repo : public QObject
 		RawObject& object(const Id &id);
 		Tree& tree(const Id &id);
 
+		/**
+		 * @brief Returns the entries of the tree with the given id.
+		 *
+		 * Trees never change, so their parsed entries are cached by SHA1
+		 * until the repo is reset. The cache holds a bounded number of
+		 * entries, the least recently used trees are dropped first.
+		 *
+		 * @param treeId The tree's full SHA1.
+		 * @return The tree's entries or an empty list if there is no such tree.
+		 *
+		 * @see Tree::findPath()
+		 */
+		const QVector<TreeEntry> treeEntries(const QString &treeId);
+
 		void commitIndex(const QString &message, const QStringList &options = QStringList());
 		QList<Commit> commits(const QString &branch = QString("HEAD"));
 		const Ref& currentHead();
+		/** Diffs the commits' trees with renames detected (see Commit::diff()). */
 		QString diff(const Commit &a, const Commit &b) const;
 		QList<Ref> heads();
 		const QString& gitDir() const;
+		/** Returns whether the status has been loaded already (see status()). */
+		bool hasStatus() const;
 		const Ref& ref(const QString &name);
+
+		/**
+		 * @brief Returns the snapshot of the repo's loose and packed refs.
+		 *
+		 * It is read on first access and replaced when the refs are reset.
+		 * refreshRefs() only reads the refs again that have changed.
+		 *
+		 * @see refreshRefs(), resetRefs()
+		 */
+		RefDatabase* refDatabase();
+		/**
+		 * @brief Replaces the repo's status with @a status.
+		 *
+		 * This is intended for statuses that have been constructed for another
+		 * repo object of the same working directory (e.g. in a background thread).
+		 * The repo takes ownership of @a status. It has to live in the repo's thread.
+		 *
+		 * @param status The new status.
+		 */
+		void setStatus(Status *status);
 		/** Stages files to be included in the next commit. */
 		void stageFiles(const QStringList &paths);
 		Status* status();
@@ -109,6 +175,13 @@ class KDE_EXPORT Repo : public QObject
 		ObjectStorage* storageFor(const QString &id);
 		/** Unstages (staged) files to not be included in the next commit. */
 		void unstageFiles(const QStringList &paths);
+		/**
+		 * @brief Returns the cache used for finding untracked files.
+		 *
+		 * It is shared with all repo objects of the same working directory and
+		 * is not affected by resets.
+		 */
+		UntrackedCache* untrackedCache() const;
 		const QString& workingDir() const;
 
 	// static
@@ -117,6 +190,16 @@ class KDE_EXPORT Repo : public QObject
 		static void init(const QString &newRepoPath);
 
 	public slots:
+		/**
+		 * @brief Updates the refs that have changed on disk.
+		 *
+		 * Unlike resetRefs() the cached refs and commit lists of unchanged
+		 * refs are kept. refAdded(), refDeleted() or refMoved() is emitted
+		 * for every ref that has changed.
+		 *
+		 * @see RefDatabase::refresh()
+		 */
+		void refreshRefs();
 		void reset();
 		void resetCommits();
 		void resetRefs();
@@ -126,7 +209,6 @@ class KDE_EXPORT Repo : public QObject
 
 	signals:
 //		void currentHeadChanged();
-		void headsChanged();
 //		void headChanged(const QString&);
 		void historyChanged();
 
@@ -137,9 +219,69 @@ class KDE_EXPORT Repo : public QObject
 		 */
 		void indexChanged();
 
+		/**
+		 * @brief This is emitted when staging or unstaging files has updated the status in place.
+		 *
+		 * The status() object stays the same, only the files of the affected
+		 * paths have changed (see the signals of Status). Unlike indexChanged()
+		 * there is no need to reload the whole status.
+		 */
+		void statusUpdated();
+
+		/**
+		 * @brief This is emitted by refreshRefs() for refs that have been created.
+		 *
+		 * @param fullName The ref's full name (e.g. "refs/heads/master").
+		 * @param id The SHA1 it points to.
+		 */
+		void refAdded(const QString &fullName, const QString &id);
+
+		/**
+		 * @brief This is emitted by refreshRefs() for refs that have been deleted.
+		 *
+		 * @param fullName The ref's full name (e.g. "refs/heads/master").
+		 * @param oldId The SHA1 it pointed to.
+		 */
+		void refDeleted(const QString &fullName, const QString &oldId);
+
+		/**
+		 * @brief This is emitted by refreshRefs() for refs that point to another commit now.
+		 *
+		 * It is also emitted for "HEAD" when the current branch has moved or
+		 * another branch has been checked out.
+		 *
+		 * @param fullName The ref's full name (e.g. "refs/heads/master" or "HEAD").
+		 * @param oldId The SHA1 it pointed to.
+		 * @param newId The SHA1 it points to now.
+		 */
+		void refMoved(const QString &fullName, const QString &oldId, const QString &newId);
+
+	private slots:
+		/**
+		 * @brief Drops the cached ref and commit list for a ref that has changed.
+		 */
+		void forgetRef(const QString &fullName);
+
 	private:
+		/**
+		 * @brief Commits the index without running "git commit".
+		 *
+		 * The trees and the commit are written into the loose storage and the
+		 * current branch is moved with a lock file. The cached history of the
+		 * branch is kept and only gains the new commit.
+		 *
+		 * @return False if Git has to do the commit (e.g. during a merge or with unmerged entries).
+		 */
+		bool commitIndexInProcess(const QString &message);
+
+		/**
+		 * @brief Updates the status of @a paths after they have been (un)staged.
+		 */
+		void updateStatusOf(const QStringList &paths);
+
 		QSharedDataPointer<RepoPrivate> d;
 
+		friend class ::RepoCommitIndexTest;
 		friend class ::RepoCommitsCachingTest;
 		friend class ::RepoHeadsCachingTest;
 		friend class ::RepoStatusCachingTest;
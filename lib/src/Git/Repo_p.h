@@ -19,10 +19,19 @@
 #ifndef REPO_P_H
 #define REPO_P_H
 
+#include "ActorTable.h"
+#include "CatFileProcess.h"
 #include "Commit.h"
+#include "CommitCache.h"
 #include "LooseStorage.h"
 #include "Ref.h"
+#include "RefDatabase.h"
 #include "Status.h"
+#include "Tree.h"
+#include "UntrackedCache.h"
+
+#include <QCache>
+#include <QSharedPointer>
 
 namespace Git {
 
@@ -30,32 +39,51 @@ class RepoPrivate : public QSharedData {
 public:
 	RepoPrivate()
 		: QSharedData()
+		, actors()
+		, catFileProcess()
+		, commitCache()
 		, commits()
 		, gitDir()
 		, refs()
+		, refDatabase(0)
 		, looseStorage(0)
 		, status(0)
 		, storages()
+		, treeEntries()
+		, untrackedCache()
 		, workingDir()
 	{}
 	RepoPrivate(const RepoPrivate &other)
 		: QSharedData()
+		, actors(other.actors)
+		, catFileProcess(other.catFileProcess)
+		, commitCache(other.commitCache)
 		, commits(other.commits)
 		, gitDir(other.gitDir)
 		, refs(other.refs)
+		, refDatabase(other.refDatabase)
 		, looseStorage(other.looseStorage)
 		, status(other.status)
 		, storages(other.storages)
+		, treeEntries(other.treeEntries)
+		, untrackedCache(other.untrackedCache)
 		, workingDir(other.workingDir)
 	{}
 	~RepoPrivate() {}
 
+	// shared, so copies of a repo do not keep dangling pointers
+	QSharedPointer<ActorTable> actors;
+	QSharedPointer<CatFileProcess> catFileProcess;
+	QSharedPointer<CommitCache> commitCache;
 	QHash<QString, QList<Commit> > commits;
 	QString gitDir;
 	QHash<QString, Ref> refs;
+	RefDatabase *refDatabase;
 	LooseStorage *looseStorage;
 	Status *status;
 	QList<ObjectStorage*> storages;
+	QSharedPointer<QCache<QString, QVector<TreeEntry> > > treeEntries;
+	QSharedPointer<UntrackedCache> untrackedCache;
 	QString workingDir;
 };
 
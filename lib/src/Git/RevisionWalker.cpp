@@ -0,0 +1,101 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RevisionWalker.h"
+
+#include "Ref.h"
+
+using namespace Git;
+
+
+
+RevisionWalker::RevisionWalker(const Ref &ref)
+	: m_count(0)
+	, m_fringe()
+	, m_seen()
+{
+	push(ref.commit());
+}
+
+RevisionWalker::RevisionWalker(const Commit &commit)
+	: m_count(0)
+	, m_fringe()
+	, m_seen()
+{
+	push(commit);
+}
+
+
+
+bool RevisionWalker::atEnd() const
+{
+	return m_fringe.isEmpty();
+}
+
+int RevisionWalker::count() const
+{
+	return m_count;
+}
+
+Commit RevisionWalker::next()
+{
+	if (atEnd()) {
+		return Commit();
+	}
+
+	// equal dates are inserted in front of each other
+	// so the last one is the one that was pushed first
+	QMap<uint, Commit>::iterator latest = m_fringe.end() - 1;
+	Commit commit = latest.value();
+	m_fringe.erase(latest);
+
+	foreach (const Commit &parent, commit.parents()) {
+		push(parent);
+	}
+
+	++m_count;
+
+	return commit;
+}
+
+QList<Commit> RevisionWalker::next(int count)
+{
+	QList<Commit> commits;
+
+	while (commits.size() < count && !atEnd()) {
+		commits << next();
+	}
+
+	return commits;
+}
+
+void RevisionWalker::push(const Commit &commit)
+{
+	if (!commit.isValid()) {
+		return;
+	}
+
+	QByteArray sha1 = commit.id().toBinarySha1();
+	if (m_seen.contains(sha1)) {
+		return;
+	}
+	m_seen << sha1;
+
+	Commit pushed(commit);
+	m_fringe.insertMulti(pushed.committedAt().toTime_t(), pushed);
+}
@@ -0,0 +1,118 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Walks the history of a ref incrementally.
+ */
+
+#ifndef REVISIONWALKER_H
+#define REVISIONWALKER_H
+
+#include "Commit.h"
+
+#include <kdemacros.h>
+
+#include <QByteArray>
+#include <QMap>
+#include <QSet>
+
+
+
+class RevisionWalkerTest;
+
+namespace Git {
+
+class Ref;
+
+
+
+/**
+ * @brief Walks the history of a ref incrementally.
+ *
+ * The commits are produced in the same order as Commit::allReachableFrom()
+ * lists them (newest commit date first), but only as many of them as are
+ * asked for. Only the commits on the fringe of the walk are kept around.
+ * To not produce a commit twice the walker remembers the binary SHA1 of
+ * every commit it has come across though (20 bytes plus the overhead of a
+ * QByteArray in a QSet per commit).
+ *
+ * @code
+ *   RevisionWalker walker(repo.currentHead());
+ *   QList<Commit> firstPage = walker.next(100);
+ *   while (!walker.atEnd()) {
+ *     Commit commit = walker.next();
+ *     // ...
+ *   }
+ * @endcode
+ */
+class KDE_EXPORT RevisionWalker
+{
+	public:
+		/**
+		 * @brief Constructs a walker starting at the commit @a ref points to.
+		 */
+		explicit RevisionWalker(const Ref &ref);
+
+		/**
+		 * @brief Constructs a walker starting at @a commit.
+		 */
+		explicit RevisionWalker(const Commit &commit);
+
+		/**
+		 * @brief Have all reachable commits been produced?
+		 */
+		bool atEnd() const;
+
+		/**
+		 * @brief Returns the number of commits produced so far.
+		 */
+		int count() const;
+
+		/**
+		 * @brief Produces the next commit of the walk.
+		 *
+		 * @return The next commit or an invalid commit if the walk is at its end.
+		 */
+		Commit next();
+
+		/**
+		 * @brief Produces up to @a count commits of the walk.
+		 *
+		 * @param count The maximum number of commits to produce.
+		 * @return The produced commits. It will be shorter than @a count only at the end of the walk.
+		 */
+		QList<Commit> next(int count);
+
+	private:
+		void push(const Commit &commit);
+
+	private:
+		int m_count;
+		/** The commits to be produced next by commit date. */
+		QMap<uint, Commit> m_fringe;
+		/** The binary SHA1s of all commits that have been pushed to the fringe. */
+		QSet<QByteArray> m_seen;
+
+		friend class ::RevisionWalkerTest;
+};
+
+}
+
+#endif // REVISIONWALKER_H
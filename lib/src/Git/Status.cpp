@@ -19,109 +19,773 @@
 #include "Status.h"
 
 #include "gitrunner.h"
+#include "CatFileProcess.h"
+#include "Id.h"
+#include "IgnoreRules.h"
+#include "Index.h"
+#include "JobQueue.h"
+#include "LineDiff.h"
+#include "ObjectStorage.h"
+#include "RefDatabase.h"
 #include "Repo.h"
+#include "Tree.h"
+#include "UntrackedCache.h"
+
+#include <KDebug>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QtAlgorithms>
+#include <QtConcurrentMap>
+
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace Git;
 
 
 
+#define GitlinkMode  0160000
+#define SymlinkMode  0120000
+#define ExecMode     0100755
+#define FileMode     0100644
+#define TypeMask     0170000
+#define Sha1Size     20
+#define ReadChunkSize  (64*1024)
+#define StatusFileBlockSize  64
+/** The maximum length of the paths passed to a single Git command, so it stays well below ARG_MAX. */
+#define PathArgumentsSize  (64*1024)
+
+
+
+/**
+ * @brief The state of an index entry's file in the working directory.
+ */
+struct WorkingTreeFile
+{
+	WorkingTreeFile()
+		: entry(0)
+		, indexTimestamp(0)
+		, localPath()
+		, mayConvertContent(false)
+		, mode(0)
+		, needsGit(false)
+		, status(StatusFile::None)
+		, trustExecutableBit(true)
+	{}
+
+	const IndexEntry *entry;
+	uint indexTimestamp;
+	QByteArray localPath;
+	/** Whether line ending conversion or filters may change the content when it is staged */
+	bool mayConvertContent;
+	quint32 mode;
+	/** Whether the content differs in a way only Git can judge (see mayConvertContent) */
+	bool needsGit;
+	StatusFile::Status status;
+	/** The value of core.fileMode */
+	bool trustExecutableBit;
+};
+
+/**
+ * @brief A difference between a tree and the index.
+ */
+struct StagedChange
+{
+	StagedChange()
+		: entry(0)
+		, idRepo()
+		, modeRepo(0)
+	{}
+
+	/** The index entry or 0 if the path has been removed from the index. */
+	const IndexEntry *entry;
+	/** The id in the tree or a null string if the path has been added to the index. */
+	QString idRepo;
+	quint32 modeRepo;
+};
+
+/**
+ * Calculates the SHA1 the file would have as a blob.
+ */
+static QByteArray blobSha1For(const QByteArray &localPath, const struct stat &fileStat)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+
+	if (S_ISLNK(fileStat.st_mode)) {
+		// the blob of a symlink contains the link's target
+		QByteArray target(fileStat.st_size + 1, '\0');
+		ssize_t targetSize = readlink(localPath.constData(), target.data(), target.size());
+		if (targetSize < 0) {
+			return QByteArray();
+		}
+		target.truncate(targetSize);
+
+		hash.addData("blob " + QByteArray::number(target.size()));
+		hash.addData("\0", 1);
+		hash.addData(target);
+	} else {
+		QFile file(QFile::decodeName(localPath));
+		if (!file.open(QFile::ReadOnly)) {
+			return QByteArray();
+		}
+
+		hash.addData("blob " + QByteArray::number(file.size()));
+		hash.addData("\0", 1);
+		while (!file.atEnd()) {
+			hash.addData(file.read(ReadChunkSize));
+		}
+	}
+
+	return hash.result();
+}
+
+/**
+ * Checks whether @a field only consists of zeros (like the ids and modes Git
+ * prints for missing files).
+ */
+static bool isZeros(const QByteArray &field)
+{
+	for (int i = 0; i < field.size(); ++i) {
+		if (field[i] != '0') {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Returns the field of Git's output starting at @a position and moves
+ * @a position past its terminating @a separator.
+ *
+ * The field is not copied, it shares the data of @a output. So it must not
+ * outlive @a output and it is not terminated by a '\0'.
+ */
+static QByteArray nextField(const QByteArray &output, int &position, char separator = '\0')
+{
+	if (position >= output.size()) {
+		position = output.size();
+		return QByteArray();
+	}
+
+	const char *start = output.constData() + position;
+	const char *end = (const char*)memchr(start, separator, output.size() - position);
+	int length = end ? end - start : output.size() - position;
+
+	position += length + 1;
+
+	return QByteArray::fromRawData(start, length);
+}
+
+/**
+ * Looks up @a key (in lower case) in the core section of a Git config file.
+ *
+ * @return The last value set in the file, an empty string for keys without
+ *         a value or a null string if it is not set.
+ */
+static QString coreConfigValueFrom(const QString &configFilePath, const QByteArray &key)
+{
+	QFile configFile(configFilePath);
+	if (!configFile.open(QFile::ReadOnly)) {
+		return QString();
+	}
+
+	QString value;
+	bool inCoreSection = false;
+	while (!configFile.atEnd()) {
+		QByteArray line = configFile.readLine().trimmed();
+		if (line.startsWith('[')) {
+			inCoreSection = line.toLower() == "[core]";
+		} else if (inCoreSection && line.toLower().startsWith(key)) {
+			QByteArray rest = line.mid(key.size()).trimmed();
+			if (rest.isEmpty()) {
+				value = QString("");
+			} else if (rest.startsWith('=')) {
+				value = QString::fromUtf8(rest.mid(1).trimmed()).remove('"');
+			}
+		}
+	}
+
+	return value;
+}
+
+/**
+ * Looks up @a key (in lower case) in the core section of the repo's and the
+ * user's Git config files. The repo's config takes precedence.
+ */
+static QString coreConfigValueIn(const QString &gitDir, const QByteArray &key)
+{
+	QString configHome = QFile::decodeName(qgetenv("XDG_CONFIG_HOME"));
+	if (configHome.isEmpty()) {
+		configHome = QDir::homePath() + "/.config";
+	}
+
+	QStringList configFiles;
+	configFiles << gitDir + "/config" << QDir::homePath() + "/.gitconfig" << configHome + "/git/config";
+
+	foreach (const QString &configFile, configFiles) {
+		QString value = coreConfigValueFrom(configFile, key);
+		if (!value.isNull()) {
+			return value;
+		}
+	}
+
+	return QString();
+}
+
+/**
+ * Interprets a Git config value as boolean.
+ */
+static bool isConfigTrue(const QString &value, bool defaultValue)
+{
+	if (value.isNull()) {
+		return defaultValue;
+	}
+
+	QString lowerValue = value.toLower();
+	return !(lowerValue == "false" || lowerValue == "no" || lowerValue == "off" || lowerValue == "0");
+}
+
+/**
+ * Checks whether Git may convert the content of files when they are staged
+ * (i.e. core.autocrlf is set or there are attributes that may ask for line
+ * ending conversion or filters).
+ */
+static bool mayConvertContentIn(const Repo &repo, const Index &index)
+{
+	QString autocrlf = coreConfigValueIn(repo.gitDir(), "autocrlf");
+	if (autocrlf.toLower() == "input" || isConfigTrue(autocrlf, false)) {
+		return true;
+	}
+
+	QString configHome = QFile::decodeName(qgetenv("XDG_CONFIG_HOME"));
+	if (configHome.isEmpty()) {
+		configHome = QDir::homePath() + "/.config";
+	}
+
+	if (QFile::exists(repo.gitDir() + "/info/attributes") || QFile::exists(configHome + "/git/attributes")
+		|| !coreConfigValueIn(repo.gitDir(), "attributesfile").isEmpty()) {
+		return true;
+	}
+
+	foreach (const IndexEntry &entry, index.entries()) {
+		if (entry.path == ".gitattributes" || entry.path.endsWith("/.gitattributes")) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Compares an index entry with its file in the working directory.
+ * Like Git it only looks at the file's content if the stat data is not conclusive.
+ *
+ * If the content may have been converted it leaves the decision to Git.
+ */
+static void compareWithWorkingTree(WorkingTreeFile &file)
+{
+	const IndexEntry &entry = *file.entry;
+
+	// Git does not look at these in the working tree
+	if (entry.stage() != 0 || entry.isAssumeValid() || entry.isSkipWorktree()) {
+		return;
+	}
+
+	struct stat fileStat;
+	if (lstat(file.localPath.constData(), &fileStat) != 0) {
+		file.status = StatusFile::Deleted;
+		return;
+	}
+
+	// submodules are not checked
+	if ((entry.mode & TypeMask) == GitlinkMode) {
+		return;
+	}
+
+	// a directory took the file's place
+	if (S_ISDIR(fileStat.st_mode)) {
+		file.status = StatusFile::Deleted;
+		return;
+	}
+
+	if (S_ISLNK(fileStat.st_mode)) {
+		file.mode = SymlinkMode;
+	} else if (!file.trustExecutableBit && (entry.mode == ExecMode || entry.mode == FileMode)) {
+		// the file system can't be trusted, so keep what the index says
+		file.mode = entry.mode;
+	} else {
+		file.mode = (fileStat.st_mode & S_IXUSR) ? ExecMode : FileMode;
+	}
+
+	if (file.mode != entry.mode) {
+		file.status = StatusFile::Modified;
+		return;
+	}
+
+	bool statDataMatches = entry.mtimeSeconds == quint32(fileStat.st_mtime)
+		&& entry.ctimeSeconds == quint32(fileStat.st_ctime)
+		&& entry.ino == quint32(fileStat.st_ino)
+		&& entry.uid == quint32(fileStat.st_uid)
+		&& entry.gid == quint32(fileStat.st_gid)
+		&& entry.size == quint32(fileStat.st_size);
+	// the file may have been changed in the same second the index was written
+	bool racilyClean = entry.mtimeSeconds >= file.indexTimestamp;
+
+	if (statDataMatches && !racilyClean) {
+		return;
+	}
+
+	// a zero size may have been "smudged" by Git to force a content check
+	if (entry.size == quint32(fileStat.st_size) || entry.size == 0) {
+		QByteArray sha1 = blobSha1For(file.localPath, fileStat);
+		if (sha1.size() == Sha1Size && memcmp(sha1.constData(), entry.sha1, Sha1Size) == 0) {
+			return;
+		}
+	}
+
+	// the size and content of the staged file may differ from the working tree's
+	if (file.mayConvertContent && file.mode != SymlinkMode) {
+		file.needsGit = true;
+	} else {
+		file.status = StatusFile::Modified;
+	}
+}
+
+
+/**
+ * Finds the index entries that differ from their files in the working directory.
+ *
+ * @param paths Only look at these paths (0 for all).
+ */
+static QVector<WorkingTreeFile> changedWorkingTreeFiles(const Index &index, const Repo &repo, const QSet<QString> *paths = 0)
+{
+	const QVector<IndexEntry> &entries = index.entries();
+	QByteArray localDir = QFile::encodeName(repo.workingDir()) + '/';
+	bool trustExecutableBit = isConfigTrue(coreConfigValueIn(repo.gitDir(), "filemode"), true);
+	bool mayConvertContent = mayConvertContentIn(repo, index);
+
+	QVector<WorkingTreeFile> files;
+	files.reserve(paths ? paths->size() : entries.size());
+	for (int i=0; i < entries.size(); ++i) {
+		if (paths && !paths->contains(entries[i].path)) {
+			continue;
+		}
+
+		WorkingTreeFile file;
+		file.entry = &entries[i];
+		file.indexTimestamp = index.timestamp();
+		file.localPath = localDir + QFile::encodeName(entries[i].path);
+		file.mayConvertContent = mayConvertContent;
+		file.trustExecutableBit = trustExecutableBit;
+		files << file;
+	}
+
+	// stat (and hash if necessary) the files on all cores
+	QtConcurrent::blockingMap(files, compareWithWorkingTree);
+
+	// the paths are spread over several commands, so none exceeds the
+	// command line limit
+	QList<QStringList> convertedPaths;
+	int pathsSize = PathArgumentsSize;
+	foreach (const WorkingTreeFile &file, files) {
+		if (!file.needsGit) {
+			continue;
+		}
+
+		if (pathsSize + file.entry->path.size() > PathArgumentsSize) {
+			convertedPaths << QStringList();
+			pathsSize = 0;
+		}
+		// "git diff" must not interpret wildcards or magic in the file names
+		convertedPaths.last() << ":(literal)" + file.entry->path;
+		pathsSize += file.entry->path.size() + 11; // 11 == ":(literal)".length + 1
+	}
+
+	// only Git knows what the content of these files would look like staged
+	// unlike "git diff-files", "git diff" ignores files whose content only
+	// differs before the conversion
+	QList<DvcsJob*> jobs;
+	JobQueue queue;
+	foreach (const QStringList &paths, convertedPaths) {
+		GitRunner runner;
+		runner.setDirectory(repo.workingDir());
+		runner.setAsynchronous(true);
+		runner.diff(QStringList(), QStringList() << "-z" << "--name-only" << "--no-ext-diff", paths);
+
+		DvcsJob *job = runner.takeJob();
+		job->setAutoDelete(false);
+		jobs << job;
+		queue.enqueue(job);
+	}
+	queue.waitForFinished();
+
+	QSet<QString> modifiedPaths;
+	for (int i=0; i < jobs.size(); ++i) {
+		if (jobs[i]->status() != DvcsJob::JobSucceeded) {
+			// better show files as modified than hide changes
+			kWarning() << "could not compare converted files:" << jobs[i]->rawOutput();
+			foreach (const QString &path, convertedPaths[i]) {
+				modifiedPaths << path.mid(10); // 10 == ":(literal)".length
+			}
+			continue;
+		}
+
+		QByteArray output = jobs[i]->rawOutput();
+		int position = 0;
+		while (position < output.size()) {
+			modifiedPaths << QString::fromUtf8(nextField(output, position));
+		}
+	}
+	qDeleteAll(jobs);
+
+	QVector<WorkingTreeFile> changedFiles;
+	foreach (WorkingTreeFile file, files) {
+		if (file.needsGit && modifiedPaths.contains(file.entry->path)) {
+			file.status = StatusFile::Modified;
+		}
+		if (file.status != StatusFile::None) {
+			changedFiles << file;
+		}
+	}
+
+	return changedFiles;
+}
+
+/**
+ * Resolves HEAD to the id of its commit's tree without running Git.
+ *
+ * @return The tree's id or a null string if HEAD can not be resolved (e.g. on an unborn branch).
+ */
+static QString headTreeIdIn(Repo &repo)
+{
+	// the ref database follows HEAD to its branch, be it loose or packed
+	QString commitId = repo.refDatabase()->idFor("HEAD");
+	if (commitId.size() != 40) {
+		return QString();
+	}
+
+	Id id = repo.idFor(commitId);
+	if (!id.exists() || !id.object().isCommit()) {
+		return QString();
+	}
+
+	return repo.commit(id).tree().id().toSha1String();
+}
+
+/**
+ * Looks up the blob entry for @a path in a tree and its subtrees.
+ *
+ * @return Whether there is a (non-tree) entry for @a path.
+ */
+static bool findTreeEntry(Repo &repo, const QString &treeId, const QString &path, TreeEntry &result)
+{
+	TreeEntry entry;
+	if (!repo.tree(repo.idFor(treeId)).findPath(path, entry) || entry.isTree()) {
+		return false;
+	}
+
+	result = entry;
+	return true;
+}
+
+/**
+ * Keeps the files of the given paths. The other files are deleted.
+ *
+ * @param paths The paths to keep or 0 for all.
+ */
+static QList<StatusFile*> filesIn(const QList<StatusFile*> &files, const QSet<QString> *paths)
+{
+	if (!paths) {
+		return files;
+	}
+
+	QList<StatusFile*> result;
+	foreach (StatusFile *file, files) {
+		if (paths->contains(file->path())) {
+			result << file;
+		} else {
+			delete file;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Checks whether @a path or any directory on it is ignored.
+ * @a rules must not have entered any directory yet.
+ */
+static bool isIgnoredIn(IgnoreRules &rules, const QByteArray &path)
+{
+	bool ignored = false;
+	int enteredDirectories = 1;
+	rules.enterDirectory(QByteArray());
+
+	int slash = path.indexOf('/');
+	while (slash >= 0 && !ignored) {
+		QByteArray directory = path.left(slash);
+		ignored = rules.isIgnored(directory, true);
+		rules.enterDirectory(directory + '/');
+		++enteredDirectories;
+		slash = path.indexOf('/', slash + 1);
+	}
+	ignored = ignored || rules.isIgnored(path, false);
+
+	while (enteredDirectories-- > 0) {
+		rules.leaveDirectory();
+	}
+
+	return ignored;
+}
+
+/**
+ * Merges the (sorted) entries of a tree with the (sorted) index entries.
+ *
+ * Subtrees the index has cached with the same id are skipped without being
+ * loaded. @a position points to the first index entry in the tree's
+ * directory and is advanced past its last one.
+ */
+static void compareTreeWithIndex(Repo &repo, const Index &index, const QString &treeId, const QString &prefix, int &position, QMap<QString, StagedChange> &changes)
+{
+	const QVector<IndexEntry> &entries = index.entries();
+
+	foreach (const TreeEntry &treeEntry, repo.tree(repo.idFor(treeId)).rawEntries()) {
+		QString path = prefix + treeEntry.name;
+		bool isTree = treeEntry.isTree();
+		// trees sort as if they had a trailing "/"
+		QString sortKey = isTree ? path + '/' : path;
+
+		// index entries sorting before the tree entry have been added
+		while (position < entries.size() && Index::comparePaths(entries[position].path, sortKey) < 0) {
+			StagedChange change;
+			change.entry = &entries[position];
+			changes.insert(entries[position].path, change);
+			++position;
+		}
+
+		if (isTree) {
+			if (index.cachedTreeId(path) == treeEntry.sha1String()) {
+				// nothing in the directory has changed
+				position += index.cachedTreeEntryCount(path);
+				Q_ASSERT(position <= entries.size());
+			} else {
+				compareTreeWithIndex(repo, index, treeEntry.sha1String(), sortKey, position, changes);
+			}
+		} else if (position < entries.size() && entries[position].path == path) {
+			const IndexEntry &entry = entries[position];
+			if (entry.mode != treeEntry.mode || memcmp(entry.sha1, treeEntry.sha1, Sha1Size) != 0) {
+				StagedChange change;
+				change.entry = &entry;
+				change.idRepo = treeEntry.sha1String();
+				change.modeRepo = treeEntry.mode;
+				changes.insert(path, change);
+			}
+			++position;
+		} else {
+			// the entry has been removed from the index
+			StagedChange change;
+			change.idRepo = treeEntry.sha1String();
+			change.modeRepo = treeEntry.mode;
+			changes.insert(path, change);
+		}
+	}
+
+	// the remaining index entries in the directory have been added
+	while (position < entries.size() && entries[position].path.startsWith(prefix)) {
+		StagedChange change;
+		change.entry = &entries[position];
+		changes.insert(entries[position].path, change);
+		++position;
+	}
+}
+
+
+
 Status::Status(const Repo *repo)
 	: QObject((QObject*)repo)
+	, m_fileBlocks()
+	, m_files()
+	, m_filesByStatus()
+	, m_filesSorted(false)
+	, m_freeFiles()
+	, m_gitJobs()
+	, m_index(0)
 	, m_repo(repo)
+	, m_status()
+	, m_stagedFiles()
+	, m_unstagedFiles()
 {
 	constuctStatus();
 }
 
-void Status::addFile(StatusFile *file)
+Status::~Status()
+{
+	foreach (StatusFile *block, m_fileBlocks) {
+		delete[] block;
+	}
+}
+
+void Status::addFile(QHash<QString, QVector<StatusFile> > &status, StatusFile *file) const
 {
 	QString path = file->path();
-	if (m_status[path].size() > 0) {
-		StatusFile *lastFile = m_status[path].last();
-		if (lastFile->m_status == None || !file->isStaged()) {
-			lastFile->merge(*file);
+	QVector<StatusFile> &files = status[path];
+	if (files.size() > 0) {
+		StatusFile &lastFile = files.last();
+		if (lastFile.m_status == None || !file->isStaged()) {
+			lastFile.merge(*file);
 		} else {
-			m_status[path] << new StatusFile(m_repo);
+			files << StatusFile(m_repo);
 		}
 	} else {
-		m_status[path] << new StatusFile(m_repo);
+		files << StatusFile(m_repo);
 	}
 
-	StatusFile *statusFile  = m_status[path].last();
-	statusFile->m_idIndex   = file->m_idIndex;
-	statusFile->m_idRepo    = file->m_idRepo;
-	statusFile->m_modeIndex = file->m_modeIndex;
-	statusFile->m_modeRepo  = file->m_modeRepo;
-	statusFile->m_path      = file->m_path;
-	statusFile->m_staged    = file->m_staged;
-	statusFile->m_status    = file->m_status;
+	assignFile(&files.last(), *file);
+
+	// only the merged copy is kept
+	delete file;
 }
 
-void Status::constuctStatus()
+bool Status::assignFile(StatusFile *statusFile, const StatusFile &file) const
+{
+	bool changed = statusFile->m_idIndex != file.m_idIndex
+		|| statusFile->m_idRepo != file.m_idRepo
+		|| statusFile->m_modeIndex != file.m_modeIndex
+		|| statusFile->m_modeRepo != file.m_modeRepo
+		|| statusFile->m_path != file.m_path
+		|| statusFile->m_staged != file.m_staged
+		|| statusFile->m_status != file.m_status;
+
+	statusFile->m_idIndex   = file.m_idIndex;
+	statusFile->m_idRepo    = file.m_idRepo;
+	statusFile->m_modeIndex = file.m_modeIndex;
+	statusFile->m_modeRepo  = file.m_modeRepo;
+	statusFile->m_path      = file.m_path;
+	statusFile->m_staged    = file.m_staged;
+	statusFile->m_status    = file.m_status;
+
+	return changed;
+}
+
+StatusFile* Status::allocateFile()
+{
+	if (m_freeFiles.isEmpty()) {
+		StatusFile *block = new StatusFile[StatusFileBlockSize];
+		m_fileBlocks << block;
+		for (int i=0; i < StatusFileBlockSize; ++i) {
+			m_freeFiles << &block[i];
+		}
+	}
+
+	return m_freeFiles.takeLast();
+}
+
+QHash<QString, QVector<StatusFile> > Status::collectStatus(const QSet<QString> *paths) const
 {
-	m_status.clear();
+	QHash<QString, QVector<StatusFile> > status;
+
+	if (!m_index->isValid()) {
+		// the queries are independent, so let Git answer them all at once
+		runGitQueries(QList<GitQuery>() << LsFilesQuery << UntrackedFilesQuery << DiffFilesQuery << DiffIndexQuery);
+	}
 
-	foreach (StatusFile *file, lsFiles()) {
-		addFile(file);
+	foreach (StatusFile *file, lsFiles(paths)) {
+		addFile(status, file);
 	}
 
 	// find untracked files
-	foreach (StatusFile *file, untrackedFiles()) {
-		addFile(file);
+	foreach (StatusFile *file, untrackedFiles(paths)) {
+		addFile(status, file);
+	}
+
+	// both diffs look at the working tree, so it is only stat'ed (and hashed) once
+	QVector<WorkingTreeFile> changedFiles;
+	if (m_index->isValid()) {
+		changedFiles = changedWorkingTreeFiles(*m_index, *m_repo, paths);
 	}
 
 	// find modified in tree
-	foreach (StatusFile *file, diffFiles()) {
-		addFile(file);
+	foreach (StatusFile *file, diffFiles(paths, &changedFiles)) {
+		addFile(status, file);
 	}
 
 	// find added but not committed - new files
-	foreach (StatusFile *file, diffIndex("HEAD")) {
+	foreach (StatusFile *file, diffIndex("HEAD", paths, &changedFiles)) {
 		// the file has been staged
 		// if the file has a index id or is marked as deleted
 		// @info staged deleted files have no index id
 		if ((!file->idIndex().isEmpty() || file->isDeleted())
-			|| m_status[file->path()].last()->idRepo() != file->idRepo()) {
+			|| status[file->path()].last().idRepo() != file->idRepo()) {
 			file->m_staged = true;
 		}
 
-		if (!(m_status.contains(file->path()) && m_status[file->path()].last()->isDeleted())) {
-			addFile(file);
+		if (!(status.contains(file->path()) && status[file->path()].last().isDeleted())) {
+			addFile(status, file);
+		} else {
+			delete file;
 		}
 	}
 
-	foreach (const QList<StatusFile*> list, m_status.values()) {
-		m_files << list;
-	}
+	// drop the queries that have not been asked for
+	qDeleteAll(m_gitJobs);
+	m_gitJobs.clear();
+
+	return status;
 }
 
-QList<StatusFile*> Status::diffFiles() const
+void Status::constuctStatus()
 {
-	QList<StatusFile*> result;
+	m_index = new Index(*m_repo, this);
 
-	GitRunner runner;
-	runner.setDirectory(m_repo->workingDir());
+	QHash<QString, QVector<StatusFile> > status = collectStatus(0);
+
+	int fileCount = 0;
+	foreach (const QVector<StatusFile> &files, status) {
+		fileCount += files.size();
+	}
+
+	// all the files go into a single block
+	StatusFile *block = new StatusFile[fileCount];
+	m_fileBlocks << block;
+	m_files.reserve(fileCount);
+
+	QHashIterator<QString, QVector<StatusFile> > files(status);
+	while (files.hasNext()) {
+		files.next();
+
+		QList<StatusFile*> &pathFiles = m_status[files.key()];
+		foreach (const StatusFile &file, files.value()) {
+			*block = file;
+			pathFiles << block;
+			m_files << block;
+			++block;
+		}
+	}
+}
 
-	runner.diffFiles();
+QList<StatusFile*> Status::diffFiles(const QSet<QString> *paths, const QVector<WorkingTreeFile> *changedFiles) const
+{
+	if (!m_index->isValid()) {
+		return filesIn(diffFilesUsingGit(), paths);
+	}
 
-	QStringList lines = runner.getResult().split("\n");
-	lines.removeLast();
-	foreach(const QString &line, lines) {
-		QString info = line.split("\t")[0];
-		QString rawFile = line.split("\t")[1];
-		QString fileSrc = unescapeFileName(rawFile);
-		QString modeSrc = info.split(" ")[0].mid(1);
-		QString modeDst = info.split(" ")[1];
-		QString   idSrc = info.split(" ")[2];
-		QString   idDst = info.split(" ")[3];
-		QString  status = info.split(" ")[4];
+	QVector<WorkingTreeFile> files = changedFiles ? *changedFiles : changedWorkingTreeFiles(*m_index, *m_repo, paths);
+
+	QList<StatusFile*> result;
 
+	foreach (const WorkingTreeFile &file, files) {
+		// like "git diff-files" the working tree file has no id
 		StatusFile *fileStatus = new StatusFile(m_repo);
-		fileStatus->m_path = fileSrc;
-		fileStatus->m_idIndex = QRegExp("^[0]*$").exactMatch(idDst) ? QString() : idDst;
-		fileStatus->m_idRepo = QRegExp("^[0]*$").exactMatch(idSrc) ? QString() : idSrc;
-		fileStatus->m_modeIndex = modeDst == "000000" ? QString() : modeDst;
-		fileStatus->m_modeRepo = modeSrc == "000000" ? QString() : modeSrc;
-		fileStatus->m_status = statusFromString(status);
+		fileStatus->m_path = file.entry->path;
+		fileStatus->m_idRepo = file.entry->sha1String();
+		fileStatus->m_modeIndex = file.status == StatusFile::Deleted ? QString() : QString::number(file.mode, 8);
+		fileStatus->m_modeRepo = file.entry->modeString();
+		fileStatus->m_status = file.status;
 
 		result << fileStatus;
 	}
@@ -129,35 +793,109 @@ QList<StatusFile*> Status::diffFiles() const
 	return result;
 }
 
-QList<StatusFile*> Status::diffIndex(const QString &treeish) const
+QList<StatusFile*> Status::diffFilesUsingGit() const
 {
-	QList<StatusFile*> result;
+	return filesFromRawDiff(gitOutputFor(DiffFilesQuery));
+}
 
-	GitRunner runner;
-	runner.setDirectory(m_repo->workingDir());
+QList<StatusFile*> Status::diffIndex(const QString &treeish, const QSet<QString> *paths, const QVector<WorkingTreeFile> *changedFiles) const
+{
+	Repo &repo = *(Repo*)m_repo; // non-const access for loading objects
+
+	QString treeId;
+	if (m_index->isValid() && treeish == "HEAD") {
+		treeId = headTreeIdIn(repo);
+	}
+
+	// unmerged entries are left to Git
+	foreach (const IndexEntry &entry, m_index->entries()) {
+		if (entry.stage() != 0) {
+			treeId.clear();
+			break;
+		}
+	}
+
+	if (treeId.isEmpty()) {
+		return filesIn(diffIndexUsingGit(treeish), paths);
+	}
+
+	// find the changes between the tree and the index
+	QMap<QString, StagedChange> changes;
+	if (paths) {
+		foreach (const QString &path, *paths) {
+			TreeEntry treeEntry;
+			bool isInTree = findTreeEntry(repo, treeId, path, treeEntry);
+			int position = m_index->indexOf(path);
+			const IndexEntry *entry = position < 0 ? 0 : &m_index->entries()[position];
+
+			if (!isInTree && !entry) {
+				continue;
+			} else if (isInTree && entry && entry->mode == treeEntry.mode && memcmp(entry->sha1, treeEntry.sha1, Sha1Size) == 0) {
+				continue;
+			}
+
+			StagedChange change;
+			change.entry = entry;
+			if (isInTree) {
+				change.idRepo = treeEntry.sha1String();
+				change.modeRepo = treeEntry.mode;
+			}
+			changes.insert(path, change);
+		}
+	} else if (m_index->cachedTreeId(QString()) != treeId) {
+		int position = 0;
+		compareTreeWithIndex(repo, *m_index, treeId, QString(), position, changes);
+	}
 
-	runner.diffIndex(treeish);
+	// like "git diff-index" (without --cached) it looks at the working tree, too
+	QVector<WorkingTreeFile> files = changedFiles ? *changedFiles : changedWorkingTreeFiles(*m_index, *m_repo, paths);
+
+	QHash<QString, WorkingTreeFile> filesByPath;
+	foreach (const WorkingTreeFile &file, files) {
+		filesByPath.insert(file.entry->path, file);
+		if (!changes.contains(file.entry->path)) {
+			// the index entry is the same as in the tree
+			StagedChange change;
+			change.entry = file.entry;
+			change.idRepo = file.entry->sha1String();
+			change.modeRepo = file.entry->mode;
+			changes.insert(file.entry->path, change);
+		}
+	}
 
-	QStringList lines = runner.getResult().split("\n");
-	lines.removeLast();
+	QList<StatusFile*> result;
 
-	foreach(const QString &line, lines) {
-		QString info = line.split("\t")[0];
-		QString rawFile = line.split("\t")[1];
-		QString fileSrc = unescapeFileName(rawFile);
-		QString modeSrc = info.split(" ")[0].mid(1);
-		QString modeDst = info.split(" ")[1];
-		QString   idSrc = info.split(" ")[2];
-		QString   idDst = info.split(" ")[3];
-		QString  status = info.split(" ")[4];
+	QMapIterator<QString, StagedChange> change(changes);
+	while (change.hasNext()) {
+		change.next();
+		const StagedChange &stagedChange = change.value();
 
 		StatusFile *fileStatus = new StatusFile(m_repo);
-		fileStatus->m_path = fileSrc;
-		fileStatus->m_idIndex = QRegExp("^[0]*$").exactMatch(idDst) ? QString() : idDst;
-		fileStatus->m_idRepo = QRegExp("^[0]*$").exactMatch(idSrc) ? QString() : idSrc;
-		fileStatus->m_modeIndex = modeDst == "000000" ? QString() : modeDst;
-		fileStatus->m_modeRepo = modeSrc == "000000" ? QString() : modeSrc;
-		fileStatus->m_status = statusFromString(status);
+		fileStatus->m_path = change.key();
+		fileStatus->m_idRepo = stagedChange.idRepo;
+		fileStatus->m_modeRepo = stagedChange.idRepo.isEmpty() ? QString() : QString::number(stagedChange.modeRepo, 8);
+
+		if (!stagedChange.entry) {
+			fileStatus->m_status = StatusFile::Deleted;
+		} else if (filesByPath.contains(change.key())) {
+			const WorkingTreeFile &file = filesByPath[change.key()];
+			if (file.status == StatusFile::Deleted) {
+				// Git ignores added files missing in the working tree
+				if (stagedChange.idRepo.isEmpty()) {
+					delete fileStatus;
+					continue;
+				}
+				fileStatus->m_status = StatusFile::Deleted;
+			} else {
+				// the working tree file has no id
+				fileStatus->m_modeIndex = QString::number(file.mode, 8);
+				fileStatus->m_status = stagedChange.idRepo.isEmpty() ? StatusFile::Added : StatusFile::Modified;
+			}
+		} else {
+			fileStatus->m_idIndex = stagedChange.entry->sha1String();
+			fileStatus->m_modeIndex = stagedChange.entry->modeString();
+			fileStatus->m_status = stagedChange.idRepo.isEmpty() ? StatusFile::Added : StatusFile::Modified;
+		}
 
 		result << fileStatus;
 	}
@@ -165,6 +903,11 @@ QList<StatusFile*> Status::diffIndex(const QString &treeish) const
 	return result;
 }
 
+QList<StatusFile*> Status::diffIndexUsingGit(const QString &treeish) const
+{
+	return filesFromRawDiff(gitOutputFor(DiffIndexQuery, treeish));
+}
+
 QList<StatusFile*> Status::files() const
 {
 	return m_files;
@@ -178,52 +921,159 @@ QList<StatusFile*> Status::filesByStatus(StatusFile::Status fileStatus) const
 		return unstagedFiles();
 	}
 
-	QList<StatusFile*> result;
+	sortFilesByStatus();
 
-	foreach (StatusFile *file, m_files) {
-		if (file->status() & fileStatus) {
-			result << file;
+	// the files are sorted by single flags
+	QList<StatusFile*> result;
+	for (int flag = StatusFile::Untracked; flag <= StatusFile::Deleted; flag <<= 1) {
+		if (fileStatus & flag) {
+			result << m_filesByStatus.value(flag);
 		}
 	}
 
 	return result;
 }
 
+QList<StatusFile*> Status::filesFromRawDiff(const QByteArray &output) const
+{
+	QList<StatusFile*> result;
+
+	// ":<mode src> <mode dst> <id src> <id dst> <status>\0<path>\0" for every file
+	int position = 0;
+	while (position < output.size()) {
+		QByteArray info = nextField(output, position);
+		QByteArray path = nextField(output, position);
+
+		int infoPosition = 1; // skip the colon
+		QByteArray modeSrc = nextField(info, infoPosition, ' ');
+		QByteArray modeDst = nextField(info, infoPosition, ' ');
+		QByteArray   idSrc = nextField(info, infoPosition, ' ');
+		QByteArray   idDst = nextField(info, infoPosition, ' ');
+		QByteArray  status = nextField(info, infoPosition, ' ');
+
+		StatusFile *fileStatus = new StatusFile(m_repo);
+		fileStatus->m_path = QString::fromUtf8(path.constData(), path.size());
+		fileStatus->m_idIndex = isZeros(idDst) ? QString() : QString::fromLatin1(idDst.constData(), idDst.size());
+		fileStatus->m_idRepo = isZeros(idSrc) ? QString() : QString::fromLatin1(idSrc.constData(), idSrc.size());
+		fileStatus->m_modeIndex = isZeros(modeDst) ? QString() : QString::fromLatin1(modeDst.constData(), modeDst.size());
+		fileStatus->m_modeRepo = isZeros(modeSrc) ? QString() : QString::fromLatin1(modeSrc.constData(), modeSrc.size());
+		fileStatus->m_status = statusFromString(QString::fromLatin1(status.constData(), status.size()));
+
+		result << fileStatus;
+	}
+
+	return result;
+}
+
 QList<StatusFile*> Status::forFile(const QString &file) const
 {
 	return m_status[file];
 }
 
+DvcsJob* Status::gitJobFor(GitQuery query, const QString &treeish) const
+{
+	GitRunner runner;
+	runner.setDirectory(m_repo->workingDir());
+	runner.setAsynchronous(true);
+
+	switch (query) {
+		case DiffFilesQuery:
+			runner.diffFiles(QStringList() << "-z");
+			break;
+		case DiffIndexQuery:
+			runner.diffIndex(treeish, QStringList() << "-z");
+			break;
+		case IgnoredDirectoriesQuery:
+			runner.lsFiles(QStringList() << "-z" << "--others" << "--ignored" << "--exclude-standard" << "--directory");
+			break;
+		case IgnoredFilesQuery:
+			runner.lsFiles(QStringList() << "-z" << "--others" << "--ignored" << "--exclude-standard");
+			break;
+		case LsFilesQuery:
+			runner.lsFiles(QStringList() << "-z" << "--stage");
+			break;
+		case UntrackedFilesQuery:
+			// if a file shows up here it has not yet been staged
+			// @info staged deleted files don't show up in diff-files
+			runner.lsFiles(QStringList() << "-z" << "--others" << "--exclude-standard");
+			break;
+	}
+
+	DvcsJob *job = runner.takeJob();
+	job->setAutoDelete(false);
+
+	return job;
+}
+
+QByteArray Status::gitOutputFor(GitQuery query, const QString &treeish) const
+{
+	DvcsJob *job = gitJobFor(query, treeish);
+
+	DvcsJob *finishedJob = m_gitJobs.take(job->dvcsCommand());
+	if (finishedJob) {
+		delete job;
+		job = finishedJob;
+	} else {
+		job->start();
+		job->waitForFinished();
+	}
+
+	QByteArray output = job->rawOutput();
+	delete job;
+
+	return output;
+}
+
 QList<StatusFile*> Status::ignoredFiles() const
 {
+	if (!m_index->isValid()) {
+		return ignoredFilesUsingGit();
+	}
+
+	QList<QByteArray> ignoredPaths;
+	m_repo->untrackedCache()->scan(*m_repo, *m_index, 0, &ignoredPaths);
+
 	QList<StatusFile*> ignoredFiles;
 
-	GitRunner runner;
-	runner.setDirectory(m_repo->workingDir());
+	foreach (const QByteArray &path, ignoredPaths) {
+		StatusFile *statusFile = new StatusFile(m_repo);
+		statusFile->m_path = QString::fromUtf8(path);
+
+		ignoredFiles << statusFile;
+	}
+
+	return ignoredFiles;
+}
+
+QList<StatusFile*> Status::ignoredFilesUsingGit() const
+{
+	QList<StatusFile*> ignoredFiles;
+
+	runGitQueries(QList<GitQuery>() << IgnoredFilesQuery << IgnoredDirectoriesQuery);
 
 	// list ignored files
-	QStringList otherIgnoredFiles;
-	runner.lsFiles(QStringList() << "--others" << "--ignored" << "--exclude-standard");
-	otherIgnoredFiles = runner.getResult().split("\n");
-	otherIgnoredFiles.removeLast(); // remove empty line at the end
-	foreach (const QString &file, otherIgnoredFiles) { // unescape file names
-		StatusFile *statusFile = new StatusFile(m_repo);
+	QByteArray otherIgnoredFiles = gitOutputFor(IgnoredFilesQuery);
+	int position = 0;
+	while (position < otherIgnoredFiles.size()) {
+		QByteArray file = nextField(otherIgnoredFiles, position);
 
-		statusFile->m_path = unescapeFileName(file);
+		StatusFile *statusFile = new StatusFile(m_repo);
+		statusFile->m_path = QString::fromUtf8(file.constData(), file.size());
 
 		ignoredFiles << statusFile;
 	}
 
 	// list ignored directories (may also include files)
-	runner.lsFiles(QStringList() << "--others" << "--ignored" << "--exclude-standard" << "--directory");
-	QStringList otherIgnoredDirs = runner.getResult().split("\n");
-	otherIgnoredDirs.removeLast(); // remove empty line at the end
-	for(int i=0; i < otherIgnoredDirs.size(); ++i) { // unescape file names
-		otherIgnoredDirs[i] = unescapeFileName(otherIgnoredDirs[i]);
-		if (QFileInfo(m_repo->workingDir(), otherIgnoredDirs[i]).isDir()) { // only leave dirs
+	QByteArray otherIgnoredDirs = gitOutputFor(IgnoredDirectoriesQuery);
+	position = 0;
+	while (position < otherIgnoredDirs.size()) {
+		QByteArray dir = nextField(otherIgnoredDirs, position);
+		QString path = QString::fromUtf8(dir.constData(), dir.size());
+
+		if (QFileInfo(m_repo->workingDir(), path).isDir()) { // only leave dirs
 			StatusFile *statusFile = new StatusFile(m_repo);
 
-			statusFile->m_path = otherIgnoredDirs[i];
+			statusFile->m_path = path;
 
 			ignoredFiles << statusFile;
 		}
@@ -241,32 +1091,55 @@ QList<StatusFile*> Status::ignoredFiles() const
 	return ignoredFiles;
 }
 
-QList<StatusFile*> Status::lsFiles() const
+const Index& Status::index() const
+{
+	return *m_index;
+}
+
+QList<StatusFile*> Status::lsFiles(const QSet<QString> *paths) const
 {
+	if (!m_index->isValid()) {
+		return filesIn(lsFilesUsingGit(), paths);
+	}
+
 	QList<StatusFile*> result;
 
-	GitRunner runner;
-	runner.setDirectory(m_repo->workingDir());
+	foreach (const IndexEntry &entry, m_index->entries()) {
+		if (paths && !paths->contains(entry.path)) {
+			continue;
+		}
 
-	QStringList opts;
-	opts << "--stage";
+		StatusFile *fileStatus = new StatusFile(m_repo);
+		fileStatus->m_path = entry.path;
+		fileStatus->m_idIndex = entry.sha1String();
+		fileStatus->m_modeIndex = entry.mode == 0 ? QString() : entry.modeString();
 
-	runner.lsFiles(opts);
+		result << fileStatus;
+	}
+
+	return result;
+}
+
+QList<StatusFile*> Status::lsFilesUsingGit() const
+{
+	QList<StatusFile*> result;
 
-	QStringList lines = runner.getResult().split("\n");
-	lines.removeLast();
-	foreach(const QString &line, lines) {
-		QString info = line.split("\t")[0];
-		QString rawFile = line.split("\t")[1];
-		QString file = unescapeFileName(rawFile);
-		QString modeIndex = info.split(" ")[0];
-		QString   idIndex = info.split(" ")[1];
-//		QString     stage = info.split(" ")[2];
+	// "<mode> <id> <stage>\t<path>\0" for every index entry
+	QByteArray output = gitOutputFor(LsFilesQuery);
+	int position = 0;
+	while (position < output.size()) {
+		QByteArray entry = nextField(output, position);
+
+		int entryPosition = 0;
+		QByteArray modeIndex = nextField(entry, entryPosition, ' ');
+		QByteArray   idIndex = nextField(entry, entryPosition, ' ');
+		nextField(entry, entryPosition, '\t'); // skip the stage
+		QByteArray path = nextField(entry, entryPosition);
 
 		StatusFile *fileStatus = new StatusFile(m_repo);
-		fileStatus->m_path = file;
-		fileStatus->m_idIndex = QRegExp("^[0]*$").exactMatch(idIndex) ? QString() : idIndex;
-		fileStatus->m_modeIndex = modeIndex == "000000" ? QString() : modeIndex;
+		fileStatus->m_path = QString::fromUtf8(path.constData(), path.size());
+		fileStatus->m_idIndex = isZeros(idIndex) ? QString() : QString::fromLatin1(idIndex.constData(), idIndex.size());
+		fileStatus->m_modeIndex = isZeros(modeIndex) ? QString() : QString::fromLatin1(modeIndex.constData(), modeIndex.size());
 //		fileStatus->m_stage = stage;
 
 		result << fileStatus;
@@ -275,17 +1148,65 @@ QList<StatusFile*> Status::lsFiles() const
 	return result;
 }
 
-QList<StatusFile*> Status::stagedFiles() const
+void Status::setRepo(const Repo *repo)
 {
-	QList<StatusFile*> files;
+	m_repo = repo;
+	setParent((QObject*)repo);
+
+	foreach (StatusFile *file, m_files) {
+		file->m_repo = repo;
+	}
+}
+
+void Status::releaseFile(StatusFile *file)
+{
+	*file = StatusFile();
+	m_freeFiles << file;
+}
+
+void Status::runGitQueries(const QList<GitQuery> &queries) const
+{
+	JobQueue queue;
+
+	foreach (GitQuery query, queries) {
+		DvcsJob *job = gitJobFor(query, "HEAD");
+		m_gitJobs.insert(job->dvcsCommand(), job);
+		queue.enqueue(job);
+	}
+
+	// the queue keeps reading the output of all of them without dispatching
+	// any events, so nothing can delete us or change the repo meanwhile
+	queue.waitForFinished();
+}
+
+void Status::sortFilesByStatus() const
+{
+	if (m_filesSorted) {
+		return;
+	}
+
+	m_filesByStatus.clear();
+	m_stagedFiles.clear();
+	m_unstagedFiles.clear();
+
+	foreach (StatusFile *file, m_files) {
+		m_filesByStatus[file->m_status] << file;
 
-	foreach(StatusFile *file, m_files) {
 		if (file->changesStaged()) {
-			files << file;
+			m_stagedFiles << file;
+		} else if (file->changesUnstaged()) {
+			m_unstagedFiles << file;
 		}
 	}
 
-	return files;
+	m_filesSorted = true;
+}
+
+QList<StatusFile*> Status::stagedFiles() const
+{
+	sortFilesByStatus();
+
+	return m_stagedFiles;
 }
 
 StatusFile::Status Status::statusFromString(const QString &status) const
@@ -301,55 +1222,167 @@ StatusFile::Status Status::statusFromString(const QString &status) const
 	return StatusFile::None;
 }
 
-QString Status::unescapeFileName(const QString &escapedName) const
+QList<StatusFile*> Status::unstagedFiles() const
 {
-	return escapedName;
+	sortFilesByStatus();
+
+	return m_unstagedFiles;
 }
 
-QList<StatusFile*> Status::unstagedFiles() const
+void Status::update(const QStringList &paths)
 {
-	QList<StatusFile*> files;
+	// the index has changed
+	delete m_index;
+	m_index = new Index(*m_repo, this);
+
+	// staging a directory affects all the files in it
+	QSet<QString> affectedPaths;
+	QStringList knownPaths;
+	bool updateAll = false;
+	foreach (const QString &path, paths) {
+		QString cleanPath = QDir::cleanPath(path);
+		if (cleanPath.isEmpty() || cleanPath == ".") {
+			updateAll = true;
+			break;
+		}
+
+		affectedPaths << cleanPath;
+
+		// the files in a directory follow each other in sorted lists
+		QString directoryPrefix = cleanPath + '/';
+		if (knownPaths.isEmpty() && !m_status.isEmpty()) {
+			knownPaths = m_status.keys();
+			qSort(knownPaths);
+		}
+		QStringList::const_iterator knownPath = qLowerBound(knownPaths.constBegin(), knownPaths.constEnd(), directoryPrefix);
+		for (; knownPath != knownPaths.constEnd() && knownPath->startsWith(directoryPrefix); ++knownPath) {
+			affectedPaths << *knownPath;
+		}
 
-	foreach(StatusFile *file, m_files) {
-		if (file->changesUnstaged()) {
+		const QVector<IndexEntry> &entries = m_index->entries();
+		for (int i = m_index->lowerBound(directoryPrefix); i < entries.size() && entries[i].path.startsWith(directoryPrefix); ++i) {
+			affectedPaths << entries[i].path;
+		}
+	}
+
+	QHash<QString, QVector<StatusFile> > newStatus = collectStatus(updateAll ? 0 : &affectedPaths);
+	if (updateAll) {
+		affectedPaths = m_status.keys().toSet() + newStatus.keys().toSet();
+	}
+
+	// the files that are gone are announced before anything changes
+	foreach (const QString &path, affectedPaths) {
+		QList<StatusFile*> oldFiles = m_status.value(path);
+		for (int i = newStatus.value(path).size(); i < oldFiles.size(); ++i) {
+			emit fileAboutToBeRemoved(oldFiles[i]);
+		}
+	}
+
+	// reuse the existing files where possible
+	QList<StatusFile*> addedFiles;
+	QList<StatusFile*> changedFiles;
+	foreach (const QString &path, affectedPaths) {
+		QList<StatusFile*> oldFiles = m_status.value(path);
+		QVector<StatusFile> newFiles = newStatus.value(path);
+		QList<StatusFile*> files;
+
+		int i = 0;
+		for (; i < oldFiles.size() && i < newFiles.size(); ++i) {
+			StatusFile *file = oldFiles[i];
+			if (assignFile(file, newFiles[i])) {
+				changedFiles << file;
+			}
 			files << file;
 		}
+		for (int j = i; j < oldFiles.size(); ++j) {
+			m_files.removeOne(oldFiles[j]);
+			releaseFile(oldFiles[j]);
+		}
+		for (int j = i; j < newFiles.size(); ++j) {
+			StatusFile *file = allocateFile();
+			*file = newFiles[j];
+			files << file;
+			m_files << file;
+			addedFiles << file;
+		}
+
+		if (files.isEmpty()) {
+			m_status.remove(path);
+		} else {
+			m_status.insert(path, files);
+		}
 	}
 
-	return files;
+	m_filesSorted = false;
+
+	foreach (StatusFile *file, changedFiles) {
+		emit fileChanged(file);
+	}
+	foreach (StatusFile *file, addedFiles) {
+		emit fileAdded(file);
+	}
 }
 
-QList<StatusFile*> Status::untrackedFiles() const
+QList<StatusFile*> Status::untrackedFiles(const QSet<QString> *paths) const
 {
-	GitRunner runner;
-	runner.setDirectory(m_repo->workingDir());
+	if (!m_index->isValid()) {
+		return filesIn(untrackedFilesUsingGit(), paths);
+	}
 
-	// if a file shows up here it has not yet been staged
-	// @info staged deleted files don't show up in diff-files
-	runner.lsFiles(QStringList() << "--others");
+	QList<QByteArray> untrackedPaths;
+	if (paths) {
+		// only look at the given files instead of scanning the whole working tree
+		IgnoreRules rules(*m_repo);
+		foreach (const QString &path, *paths) {
+			if (m_index->indexOf(path) >= 0) {
+				continue;
+			}
 
-	QStringList otherFiles = runner.getResult().split("\n");
-	otherFiles.removeLast(); // remove empty line at the end
+			QByteArray localPath = QFile::encodeName(m_repo->workingDir() + '/' + path);
+			struct stat fileStat;
+			if (lstat(localPath.constData(), &fileStat) != 0 || S_ISDIR(fileStat.st_mode)) {
+				continue;
+			}
+
+			QByteArray utf8Path = path.toUtf8();
+			if (!isIgnoredIn(rules, utf8Path)) {
+				untrackedPaths << utf8Path;
+			}
+		}
+	} else {
+		m_repo->untrackedCache()->scan(*m_repo, *m_index, &untrackedPaths, 0);
+	}
 
 	QList<StatusFile*> untrackedFiles;
 
-	foreach (const QString &file, otherFiles) {
+	foreach (const QByteArray &path, untrackedPaths) {
 		StatusFile *statusFile = new StatusFile(m_repo);
-		statusFile->m_path = unescapeFileName(file); // unescape file names
+		statusFile->m_path = QString::fromUtf8(path);
 		statusFile->m_staged = false;
 		statusFile->m_status = StatusFile::Untracked;
 
 		untrackedFiles << statusFile;
 	}
 
-	// remove ignored files from the list
-	foreach (const StatusFile *iFile, ignoredFiles()) {
-		foreach (StatusFile *uFile, untrackedFiles) {
-			if (uFile->path() == iFile->path() || uFile->path().startsWith(iFile->path())) {
-				untrackedFiles.removeOne(uFile);
-				delete uFile;
-			}
-		}
+	return untrackedFiles;
+}
+
+QList<StatusFile*> Status::untrackedFilesUsingGit() const
+{
+	QByteArray otherFiles = gitOutputFor(UntrackedFilesQuery);
+
+	QList<StatusFile*> untrackedFiles;
+
+	int position = 0;
+	while (position < otherFiles.size()) {
+		QByteArray file = nextField(otherFiles, position);
+
+		StatusFile *statusFile = new StatusFile(m_repo);
+		statusFile->m_path = QString::fromUtf8(file.constData(), file.size());
+		statusFile->m_staged = false;
+		statusFile->m_status = StatusFile::Untracked;
+
+		untrackedFiles << statusFile;
 	}
 
 	return untrackedFiles;
@@ -358,8 +1391,7 @@ QList<StatusFile*> Status::untrackedFiles() const
 
 
 StatusFile::StatusFile(const Repo *repo)
-	: QObject((QObject*)repo)
-	, m_repo(repo)
+	: m_repo(repo)
 	, m_staged(false)
 	, m_status(None)
 {
@@ -371,10 +1403,6 @@ const QByteArray StatusFile::blob(QString type) const
 		type = changesUnstaged() ? "file" : "index";
 	}
 
-	GitRunner runner;
-	runner.setDirectory(m_repo->workingDir());
-
-	QString id;
 	QByteArray blobData;
 
 	if (type == "file") {
@@ -384,24 +1412,48 @@ const QByteArray StatusFile::blob(QString type) const
 			blobData = file.readAll();
 			file.close();
 		}
-	} else if (type == "index") {
+	} else {
+		QString id = blobIdFor(type);
+		if (!id.isNull()) {
+			blobData = blobDataFor(id);
+		}
+	}
+
+	return blobData;
+}
+
+const QByteArray StatusFile::blobDataFor(const QString &id) const
+{
+	Repo &repo = *(Repo*)m_repo; // non-const access for loading objects
+
+	ObjectStorage *storage = repo.storageFor(id);
+	if (!storage) {
+		// e.g. it is in an alternate object database
+		QByteArray data = repo.catFileProcess()->readObject(id);
+		if (data.isNull()) {
+			kWarning() << "Could not find blob" << id;
+		}
+		return data;
+	}
+
+	return storage->objectDataFor(Id(id, *storage));
+}
+
+const QString StatusFile::blobIdFor(const QString &type) const
+{
+	if (type == "index") {
 		if (!m_idIndex.isEmpty()) {
-			id = m_idIndex;
+			return m_idIndex;
 		} else if (!m_staged) {
-			id = m_idRepo;
+			return m_idRepo;
 		}
 	} else if (type == "repo") {
 		if (!m_idRepo.isEmpty()) {
-			id = m_idRepo;
+			return m_idRepo;
 		}
 	}
 
-	if (!id.isNull()) {
-		runner.catFile(id, QStringList() << "-p");
-		blobData = runner.getResult().toUtf8();
-	}
-
-	return blobData;
+	return QString();
 }
 
 bool StatusFile::changesStaged() const
@@ -417,22 +1469,83 @@ bool StatusFile::changesUnstaged() const
 
 const QString StatusFile::diff() const
 {
-	QString diff;
+	if (isUntracked()) {
+		return QString();
+	}
 
-	if (!isUntracked()) {
-		GitRunner runner;
-		runner.setDirectory(m_repo->workingDir());
+	// links and submodules have no content to compare
+	if (m_modeIndex.startsWith("120") || m_modeIndex.startsWith("160")
+		|| m_modeRepo.startsWith("120") || m_modeRepo.startsWith("160")) {
+		return diffUsingGit();
+	}
 
-		QStringList opts;
-		if (changesStaged()) {
-			opts << "--cached";
+	Repo &repo = *(Repo*)m_repo; // non-const access for loading objects
+
+	// staged changes compare the repo with the index, unstaged ones the index with the working tree
+	QString oldId;
+	QString newId;
+	if (changesStaged()) {
+		oldId = m_idRepo;
+		if (!isDeleted()) {
+			newId = m_idIndex.isEmpty() ? indexBlobId() : m_idIndex;
+			if (newId.isEmpty()) {
+				return diffUsingGit();
+			}
 		}
+	} else {
+		oldId = blobIdFor("index");
+	}
+
+	if ((!oldId.isEmpty() && !repo.storageFor(oldId)) || (!newId.isEmpty() && !repo.storageFor(newId))) {
+		return diffUsingGit();
+	}
+
+	QByteArray oldData = oldId.isEmpty() ? QByteArray() : blobDataFor(oldId);
+	QByteArray newData;
+	bool hasNewFile;
+	if (changesStaged()) {
+		hasNewFile = !newId.isEmpty();
+		newData = hasNewFile ? blobDataFor(newId) : QByteArray();
+	} else {
+		hasNewFile = QFile::exists(QDir(m_repo->workingDir()).filePath(path()));
+		newData = blob("file");
+	}
 
-		runner.diff(QStringList(), opts, QStringList() << path());
+	QString oldName = oldId.isEmpty() ? QString("/dev/null") : "a/" + path();
+	QString newName = hasNewFile ? "b/" + path() : QString("/dev/null");
+
+	if (LineDiff::isBinary(oldData) || LineDiff::isBinary(newData)) {
+		return QString("Binary files %1 and %2 differ\n").arg(oldName).arg(newName);
+	}
 
-		diff = runner.getResult();
+	LineDiff lineDiff(oldData, newData);
+	if (!lineDiff.hasChanges()) {
+		return QString("");
 	}
 
+	QByteArray diff = "--- " + oldName.toUtf8() + "\n+++ " + newName.toUtf8() + "\n";
+	diff += lineDiff.unifiedDiff();
+
+	return QString::fromUtf8(diff);
+}
+
+const QString StatusFile::diffUsingGit() const
+{
+	QString diff;
+
+	GitRunner runner;
+	runner.setDirectory(m_repo->workingDir());
+
+	QStringList opts;
+	if (changesStaged()) {
+		opts << "--cached";
+	}
+
+	// the patch is only shown, -z would not change its (quoted) header lines anyway
+	runner.diff(QStringList(), opts, QStringList() << path());
+
+	diff = runner.getResult();
+
 	// for now just remove the header
 	diff = diff.mid(diff.indexOf("---"));
 
@@ -444,6 +1557,17 @@ bool StatusFile::hasChanged() const
 	return m_status != None;
 }
 
+bool StatusFile::hasStatus(Status fileStatus) const
+{
+	if (fileStatus & Staged) {
+		return changesStaged();
+	} else if (fileStatus & Unstaged) {
+		return changesUnstaged();
+	}
+
+	return m_status & fileStatus;
+}
+
 const QString& StatusFile::idIndex() const
 {
 	return m_idIndex;
@@ -454,6 +1578,29 @@ const QString& StatusFile::idRepo() const
 	return m_idRepo;
 }
 
+const QString StatusFile::indexBlobId() const
+{
+	Repo &repo = *(Repo*)m_repo; // non-const access for the status
+
+	// the status has read the index already
+	if (repo.hasStatus()) {
+		const Index &index = repo.status()->index();
+		if (index.isValid()) {
+			int position = index.indexOf(m_path);
+			return position < 0 ? QString() : index.entries()[position].sha1String();
+		}
+	}
+
+	Index index(*m_repo);
+	if (!index.isValid()) {
+		return QString();
+	}
+
+	int position = index.indexOf(m_path);
+
+	return position < 0 ? QString() : index.entries()[position].sha1String();
+}
+
 bool StatusFile::isAdded() const
 {
 	return m_status == Added;
@@ -479,6 +1626,47 @@ bool StatusFile::isUntracked() const
 	return m_status == Untracked;
 }
 
+bool StatusFile::writeBlobTo(QIODevice &device, QString type) const
+{
+	if (type.isEmpty()) {
+		type = changesUnstaged() ? "file" : "index";
+	}
+
+	if (type == "file") {
+		// copy the file in chunks so it never has to fit into memory
+		QFile file(QDir(m_repo->workingDir()).filePath(path()));
+		if (!file.open(QFile::ReadOnly)) {
+			return false;
+		}
+
+		QByteArray buffer(ReadChunkSize, 0);
+		qint64 readBytes;
+		while ((readBytes = file.read(buffer.data(), buffer.size())) > 0) {
+			if (device.write(buffer.constData(), readBytes) != readBytes) {
+				return false;
+			}
+		}
+
+		return readBytes == 0;
+	}
+
+	QString id = blobIdFor(type);
+	if (id.isNull()) {
+		return false;
+	}
+
+	Repo &repo = *(Repo*)m_repo; // non-const access for loading objects
+
+	// the storages inflate the blob in chunks
+	ObjectStorage *storage = repo.storageFor(id);
+	if (storage) {
+		return storage->writeObjectDataTo(Id(id, *storage), device);
+	}
+
+	QByteArray blobData = blobDataFor(id);
+	return device.write(blobData) == blobData.size();
+}
+
 void StatusFile::merge(const StatusFile &file)
 {
 	if (!file.m_idIndex.isEmpty())   { m_idIndex   = file.m_idIndex; }
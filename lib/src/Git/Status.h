@@ -25,6 +25,14 @@
 
 #include <QHash>
 #include <QList>
+#include <QMetaType>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+class DvcsJob;
+class QIODevice;
+struct WorkingTreeFile;
 
 
 
@@ -39,19 +47,24 @@ class StatusUpdatedFileTest;
 
 namespace Git {
 
+class Index;
 class Repo;
 class Status;
 
 
 
-class KDE_EXPORT StatusFile : public QObject
+/**
+ * @brief The status of a single file.
+ *
+ * It is a plain value, so a Status can keep all of its files in a few
+ * contiguous blocks instead of allocating each of them on its own.
+ */
+class KDE_EXPORT StatusFile
 {
-	Q_OBJECT
-
 	friend class Status;
 
 	public:
-		StatusFile(const Repo *parent);
+		explicit StatusFile(const Repo *repo = 0);
 
 	enum StatusFlag {
 		None      = 0x00,
@@ -65,9 +78,26 @@ class KDE_EXPORT StatusFile : public QObject
 	Q_DECLARE_FLAGS(Status, StatusFlag)
 
 
+		/**
+		 * @brief Returns the content of the file.
+		 *
+		 * The blobs in the index and the repo are read from the repo's object
+		 * storages directly.
+		 *
+		 * @param type One of "file", "index" or "repo". By default it is
+		 *        the working tree file for unstaged and the index for staged changes.
+		 */
 		const QByteArray blob(QString type = QString()) const;
 		bool changesStaged() const;
 		bool changesUnstaged() const;
+		/**
+		 * @brief Returns the unified diff of the file's changes (without the "diff --git" header).
+		 *
+		 * Staged changes are compared with the repo, unstaged ones with the
+		 * index. The blobs are compared in process with LineDiff.
+		 *
+		 * @return The diff or a null string for untracked files.
+		 */
 		const QString diff() const;
 		const QString& idIndex() const;
 		const QString& idRepo() const;
@@ -77,11 +107,39 @@ class KDE_EXPORT StatusFile : public QObject
 		bool isStaged() const;
 		bool isUntracked() const;
 		bool hasChanged() const;
+		/**
+		 * @brief Checks whether the file belongs to the files of the given status.
+		 *
+		 * @see Status::filesByStatus()
+		 */
+		bool hasStatus(Status fileStatus) const;
 		void merge(const StatusFile &file);
 		const QString& modeIndex() const;
 		const QString& modeRepo() const;
 		const QString& path() const;
 		Status status() const;
+		/**
+		 * @brief Writes the content of the file to @a device.
+		 *
+		 * Working tree files are copied and blobs of the object storages are
+		 * inflated in chunks, so large files do not have to be read into memory
+		 * at once. Only deltified packed objects are patched in memory.
+		 *
+		 * @param device The device to write to (it has to be open).
+		 * @param type See blob().
+		 * @return Whether the whole content could be written.
+		 */
+		bool writeBlobTo(QIODevice &device, QString type = QString()) const;
+
+	private:
+		/** Returns the data of the blob @a id from the repo's object storages */
+		const QByteArray blobDataFor(const QString &id) const;
+		/** Returns the id of the blob for the given type (see blob()) or a null string */
+		const QString blobIdFor(const QString &type) const;
+		/** Runs "git diff" for links, submodules and files whose blobs can not be read */
+		const QString diffUsingGit() const;
+		/** Looks up the file's blob id in the index */
+		const QString indexBlobId() const;
 
 	private:
 		QString m_idIndex;
@@ -103,31 +161,173 @@ class KDE_EXPORT Status : public QObject
 
 	public:
 		explicit Status(const Repo *repo);
+		~Status();
 
 		QList<StatusFile*> files() const;
 		QList<StatusFile*> filesByStatus(StatusFile::Status fileStatus) const;
 		QList<StatusFile*> forFile(const QString &file) const;
+		/**
+		 * @brief Returns the index the status has been read from.
+		 *
+		 * It is replaced by update(), so it should not be kept.
+		 */
+		const Index& index() const;
 		QList<StatusFile*> stagedFiles() const;
 		QList<StatusFile*> unstagedFiles() const;
 
+		/**
+		 * @brief Updates the status of the given paths in place.
+		 *
+		 * This is intended to be called after the paths have been staged or
+		 * unstaged. Only these paths (and the files in them if they are
+		 * directories) are looked at again. Files that stay are updated
+		 * instead of being replaced, so pointers to them remain valid.
+		 *
+		 * @param paths The paths relative to the working directory.
+		 *
+		 * @see fileAdded(), fileAboutToBeRemoved(), fileChanged()
+		 */
+		void update(const QStringList &paths);
+
+	signals:
+		/**
+		 * @brief This is emitted after @a file has been added by update().
+		 */
+		void fileAdded(Git::StatusFile *file);
+
+		/**
+		 * @brief This is emitted before @a file is removed by update().
+		 *
+		 * The file must not be used afterwards.
+		 */
+		void fileAboutToBeRemoved(Git::StatusFile *file);
+
+		/**
+		 * @brief This is emitted after @a file has been changed by update().
+		 *
+		 * E.g. it may have moved from the unstaged to the staged files.
+		 */
+		void fileChanged(Git::StatusFile *file);
+
 	private:
+		/** The Git queries used when the status can not be determined natively */
+		enum GitQuery {
+			DiffFilesQuery,
+			DiffIndexQuery,
+			IgnoredDirectoriesQuery,
+			IgnoredFilesQuery,
+			LsFilesQuery,
+			UntrackedFilesQuery
+		};
+
 		void constuctStatus();
-		void addFile(StatusFile *file);
-		/** Compares the index and the working directory */
-		QList<StatusFile*> diffFiles() const;
-		/** Compares the index and the repository */
-		QList<StatusFile*> diffIndex(const QString &treeish) const;
+		/**
+		 * @brief Merges @a file into the files of its path in @a status.
+		 *
+		 * @a file itself is not used afterwards.
+		 */
+		void addFile(QHash<QString, QVector<StatusFile> > &status, StatusFile *file) const;
+		/**
+		 * @brief Returns a new file from the status' blocks of files.
+		 */
+		StatusFile* allocateFile();
+		/**
+		 * @brief Returns @a file to the status' blocks of files.
+		 */
+		void releaseFile(StatusFile *file);
+		/**
+		 * @brief Sorts the files into the lists returned by filesByStatus() and friends.
+		 */
+		void sortFilesByStatus() const;
+		/**
+		 * @brief Copies the state of @a file into @a statusFile.
+		 *
+		 * @return Whether @a statusFile has changed.
+		 */
+		bool assignFile(StatusFile *statusFile, const StatusFile &file) const;
+		/**
+		 * @brief Collects the status of all files or only of the given paths.
+		 *
+		 * @param paths The paths to look at or 0 for all.
+		 */
+		QHash<QString, QVector<StatusFile> > collectStatus(const QSet<QString> *paths) const;
+		/**
+		 * @brief Binds the status and its files to @a repo.
+		 *
+		 * @see Repo::setStatus()
+		 */
+		void setRepo(const Repo *repo);
+		/**
+		 * @brief Compares the index and the working directory (optionally only for the given paths).
+		 *
+		 * @param changedFiles The index entries differing from the working directory, if they are known already.
+		 */
+		QList<StatusFile*> diffFiles(const QSet<QString> *paths = 0, const QVector<WorkingTreeFile> *changedFiles = 0) const;
+		/** Compares the index and the working directory using Git, if the index can not be read natively */
+		QList<StatusFile*> diffFilesUsingGit() const;
+		/**
+		 * @brief Compares the index (and the working directory) with the repository (optionally only for the given paths).
+		 *
+		 * @param changedFiles The index entries differing from the working directory, if they are known already.
+		 */
+		QList<StatusFile*> diffIndex(const QString &treeish, const QSet<QString> *paths = 0, const QVector<WorkingTreeFile> *changedFiles = 0) const;
+		/** Compares the index with the repository using Git, if it can not be done natively */
+		QList<StatusFile*> diffIndexUsingGit(const QString &treeish) const;
+		/** Reads the files from the -z output of "git diff-files" or "git diff-index" */
+		QList<StatusFile*> filesFromRawDiff(const QByteArray &output) const;
+		/**
+		 * @brief Prepares the job running the given query.
+		 *
+		 * @param treeish The tree to compare the index with (only used for diff-index).
+		 */
+		DvcsJob* gitJobFor(GitQuery query, const QString &treeish = QString()) const;
+		/**
+		 * @brief Returns the output of the given query.
+		 *
+		 * It is taken from the queries run by runGitQueries() or run right away.
+		 * The queries ask for NUL terminated (-z) output, so paths are not quoted.
+		 */
+		QByteArray gitOutputFor(GitQuery query, const QString &treeish = QString()) const;
+		/** Lists the ignored files and directories (the latter are not descended into) */
 		QList<StatusFile*> ignoredFiles() const;
-		QList<StatusFile*> lsFiles() const;
+		/** Lists the ignored files and directories using Git, if the index can not be read natively */
+		QList<StatusFile*> ignoredFilesUsingGit() const;
+		QList<StatusFile*> lsFiles(const QSet<QString> *paths = 0) const;
+		/** Lists the index entries using Git, if the index can not be read natively */
+		QList<StatusFile*> lsFilesUsingGit() const;
+		/**
+		 * @brief Runs the given independent queries in parallel and keeps their output.
+		 *
+		 * diff-index compares with HEAD.
+		 *
+		 * @see gitOutputFor()
+		 */
+		void runGitQueries(const QList<GitQuery> &queries) const;
 		StatusFile::Status statusFromString(const QString &status) const;
-		QString unescapeFileName(const QString &escapedName) const;
-		QList<StatusFile*> untrackedFiles() const;
+		/** Lists the files neither in the index nor ignored (optionally only of the given paths) */
+		QList<StatusFile*> untrackedFiles(const QSet<QString> *paths = 0) const;
+		/** Lists the untracked files using Git, if the index can not be read natively */
+		QList<StatusFile*> untrackedFilesUsingGit() const;
 
 	private:
+		/** The blocks all files of the status are allocated in */
+		QList<StatusFile*> m_fileBlocks;
 		QList<StatusFile*> m_files;
+		/** The files for each single status flag (see filesByStatus()) */
+		mutable QHash<int, QList<StatusFile*> > m_filesByStatus;
+		/** Whether m_filesByStatus, m_stagedFiles and m_unstagedFiles are up to date */
+		mutable bool m_filesSorted;
+		/** Files released by update() which can be reused */
+		QList<StatusFile*> m_freeFiles;
+		/** The finished jobs of runGitQueries() by their command line */
+		mutable QHash<QString, DvcsJob*> m_gitJobs;
+		Index *m_index;
 		const Repo *m_repo;
 		QHash<QString, QList<StatusFile*> > m_status;
+		mutable QList<StatusFile*> m_stagedFiles;
+		mutable QList<StatusFile*> m_unstagedFiles;
 
+		friend class Repo;
 		friend class ::StatusDeletedFileTest;
 		friend class ::StatusModifiedAddedFileTest;
 		friend class ::StatusModifiedFileTest;
@@ -140,4 +340,6 @@ class KDE_EXPORT Status : public QObject
 
 }
 
+Q_DECLARE_METATYPE(Git::StatusFile*)
+
 #endif // STATUS_H
@@ -26,10 +26,134 @@
 
 #include <QStringList>
 
+#include <string.h>
+
 using namespace Git;
 
 
 
+#define GitlinkMode  0160000
+#define TreeMode     0040000
+#define TypeMask     0170000
+#define Sha1Size     20
+
+
+
+/**
+ * Compares an entry's sort key with @a key like Git sorts tree entries
+ * (i.e. trees sort as if they had a trailing "/").
+ *
+ * The raw name is compared in place, so probing allocates nothing.
+ */
+static int compareWithKey(const TreeEntry &entry, const QByteArray &key)
+{
+	const QByteArray &name = entry.rawName;
+	int order = memcmp(name.constData(), key.constData(), qMin(name.size(), key.size()));
+	if (order != 0) {
+		return order;
+	}
+
+	if (name.size() > key.size()) {
+		return 1;
+	}
+	if (!entry.isTree()) {
+		return name.size() < key.size() ? -1 : 0;
+	}
+
+	// the tree's name goes on with a "/"
+	if (name.size() == key.size()) {
+		return 1;
+	}
+	order = '/' - uchar(key[name.size()]);
+	if (order != 0) {
+		return order;
+	}
+
+	return name.size() + 1 < key.size() ? -1 : 0;
+}
+
+/**
+ * Binary searches the sorted @a entries for the first one not sorting before @a key.
+ *
+ * @return The entry's position or the number of entries if there is none.
+ */
+static int lowerBoundOf(const QVector<TreeEntry> &entries, const QByteArray &key)
+{
+	int low = 0;
+	int high = entries.size();
+
+	while (low < high) {
+		int middle = (low + high) / 2;
+		if (compareWithKey(entries[middle], key) < 0) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * Looks up the entry named @a name in the sorted @a entries.
+ */
+static bool findEntryIn(const QVector<TreeEntry> &entries, const QString &name, TreeEntry &result)
+{
+	if (name.isEmpty() || name.contains('/')) {
+		return false;
+	}
+
+	// we do not know whether it is a tree, which sorts as "name/", so it may
+	// only come after the entries continuing the name with a character
+	// below "/" (e.g. "name.txt")
+	QByteArray rawName = name.toUtf8();
+	for (int position = lowerBoundOf(entries, rawName); position < entries.size(); ++position) {
+		const QByteArray &entryName = entries[position].rawName;
+		if (entryName == rawName) {
+			result = entries[position];
+			return true;
+		}
+
+		if (!entryName.startsWith(rawName) || uchar(entryName[rawName.size()]) > '/') {
+			break;
+		}
+	}
+
+	return false;
+}
+
+
+
+TreeEntry::TreeEntry()
+	: mode(0)
+	, name()
+	, rawName()
+{
+	memset(sha1, 0, Sha1Size);
+}
+
+bool TreeEntry::isBlob() const
+{
+	return !isGitlink() && !isTree();
+}
+
+bool TreeEntry::isGitlink() const
+{
+	return (mode & TypeMask) == GitlinkMode;
+}
+
+bool TreeEntry::isTree() const
+{
+	return (mode & TypeMask) == TreeMode;
+}
+
+QString TreeEntry::sha1String() const
+{
+	return QString::fromLatin1(QByteArray::fromRawData((const char*)sha1, Sha1Size).toHex());
+}
+
+
+
 Tree::Tree()
 	: RawObject()
 	, d(new TreePrivate(*RawObject::d))
@@ -65,9 +189,9 @@ const QList<Blob> Tree::blobs() const
 {
 	QList<Blob> result;
 
-	foreach (const RawObject &entry, entries()) {
-		if(entry.isBlob()) {
-			result << entry.toBlob();
+	foreach (const TreeEntry &entry, rawEntries()) {
+		if (entry.isBlob()) {
+			result << objectFor(entry).toBlob();
 		}
 	}
 
@@ -78,8 +202,10 @@ const QMap<QString, Blob> Tree::blobsByName() const
 {
 	QMap<QString, Blob> result;
 
-	foreach (const Blob &entry, blobs()) {
-		result[nameFor(entry)] = entry;
+	foreach (const TreeEntry &entry, rawEntries()) {
+		if (entry.isBlob()) {
+			result[entry.name] = objectFor(entry).toBlob();
+		}
 	}
 
 	return result;
@@ -87,19 +213,27 @@ const QMap<QString, Blob> Tree::blobsByName() const
 
 const QList<RawObject> Tree::entries() const
 {
-	((Tree*)this)->lazyLoad();  // non-const access
-	return d->entries;
+	QList<RawObject> result;
+
+	foreach (const TreeEntry &entry, rawEntries()) {
+		if (!entry.isGitlink()) {
+			result << objectFor(entry);
+		}
+	}
+
+	return result;
 }
 
 const QMap<QString, RawObject> Tree::entriesByName() const
 {
 	QMap<QString, RawObject> result;
 
-	foreach (const RawObject &entry, entries()) {
-		result[nameFor(entry)] = entry;
+	foreach (const TreeEntry &entry, rawEntries()) {
+		if (!entry.isGitlink()) {
+			result[entry.name] = objectFor(entry);
+		}
 	}
 
-
 	return result;
 }
 
@@ -107,29 +241,37 @@ void Tree::fillFromString(const QByteArray &raw)
 {
 	kDebug() << "fill tree" << id().toString();
 
-	int pos = 0;
-	int modeLen = 0;
-	int nameLen = 0;
+	d->entries = readEntries(raw);
+	d->isLoaded = true;
+}
 
-	d->entries.clear();
-	d->entryModes.clear();
-	d->entryNames.clear();
+bool Tree::findEntry(const QString &name, TreeEntry &result) const
+{
+	return findEntryIn(rawEntries(), name, result);
+}
 
-	while(pos < raw.size()) {
-		modeLen = raw.indexOf(" ", pos)-pos;
-		QString mode = raw.mid(pos, modeLen);
-		pos += modeLen+1; // skip the mode and the " "
-		nameLen = raw.indexOf('\0', pos)-pos;
-		QString name = raw.mid(pos, nameLen);
-		pos += nameLen+1; // skip the file name + "\0"
-		QString idString = raw.mid(pos, 20).toHex();
-		pos += 20; // skip the id
+bool Tree::findPath(const QString &path, TreeEntry &result) const
+{
+	QStringList components = path.split('/', QString::SkipEmptyParts);
+	if (components.isEmpty()) {
+		return false;
+	}
+
+	QVector<TreeEntry> entries = rawEntries();
+	for (int i=0; i < components.size(); ++i) {
+		if (!findEntryIn(entries, components[i], result)) {
+			return false;
+		}
 
-		RawObject &entry = repo().idFor(idString).object();
-		d->entries << entry;
-		d->entryModes[entry.id()] = mode;
-		d->entryNames[entry.id()] = name;
+		if (i < components.size() - 1) {
+			if (!result.isTree()) {
+				return false;
+			}
+			entries = repo().treeEntries(result.sha1String());
+		}
 	}
+
+	return true;
 }
 
 Tree& Tree::invalid()
@@ -141,7 +283,7 @@ Tree& Tree::invalid()
 void Tree::lazyLoad()
 {
 	// if tree has already been filled
-	if (d->entries.size() > 0) {
+	if (d->isLoaded) {
 		return;
 	}
 
@@ -150,8 +292,21 @@ void Tree::lazyLoad()
 
 const QString& Tree::nameFor(const Id &id) const
 {
-	((Tree*)this)->lazyLoad(); // non-const access
-	return d->entryNames[id];
+	static const QString noName;
+
+	QByteArray sha1 = QByteArray::fromHex(id.toSha1String().toLatin1());
+	if (sha1.size() != Sha1Size) {
+		return noName;
+	}
+
+	const QVector<TreeEntry> &entries = rawEntries();
+	for (int i=0; i < entries.size(); ++i) {
+		if (memcmp(entries[i].sha1, sha1.constData(), Sha1Size) == 0) {
+			return entries[i].name;
+		}
+	}
+
+	return noName;
 }
 
 const QString& Tree::nameFor(const RawObject &object) const
@@ -159,6 +314,21 @@ const QString& Tree::nameFor(const RawObject &object) const
 	return nameFor(object.id());
 }
 
+RawObject& Tree::objectAt(const QString &path) const
+{
+	TreeEntry entry;
+	if (!findPath(path, entry) || entry.isGitlink()) {
+		return RawObject::invalid();
+	}
+
+	return objectFor(entry);
+}
+
+RawObject& Tree::objectFor(const TreeEntry &entry) const
+{
+	return repo().idFor(entry.sha1String()).object();
+}
+
 Tree& Tree::operator=(const Tree &other)
 {
 	Q_ASSERT(&other != this);
@@ -170,13 +340,45 @@ Tree& Tree::operator=(const Tree &other)
 	return *this;
 }
 
+const QVector<TreeEntry>& Tree::rawEntries() const
+{
+	((Tree*)this)->lazyLoad();  // non-const access
+	return d->entries;
+}
+
+QVector<TreeEntry> Tree::readEntries(const QByteArray &raw)
+{
+	QVector<TreeEntry> entries;
+
+	int pos = 0;
+	while (pos < raw.size()) {
+		int space = raw.indexOf(' ', pos);
+		int nul = raw.indexOf('\0', space);
+		if (space < 0 || nul < 0 || nul + 1 + Sha1Size > raw.size()) {
+			kWarning() << "tree is truncated";
+			break;
+		}
+
+		TreeEntry entry;
+		entry.mode = raw.mid(pos, space - pos).toUInt(0, 8);
+		entry.rawName = QByteArray(raw.constData() + space + 1, nul - space - 1);
+		entry.name = QString::fromUtf8(entry.rawName);
+		memcpy(entry.sha1, raw.constData() + nul + 1, Sha1Size);
+		entries << entry;
+
+		pos = nul + 1 + Sha1Size;
+	}
+
+	return entries;
+}
+
 const QList<Tree> Tree::trees() const
 {
 	QList<Tree> result;
 
-	foreach (const RawObject &entry, entries()) {
+	foreach (const TreeEntry &entry, rawEntries()) {
 		if (entry.isTree()) {
-			result << entry.toTree();
+			result << objectFor(entry).toTree();
 		}
 	}
 
@@ -187,8 +389,10 @@ const QMap<QString, Tree> Tree::treesByName() const
 {
 	QMap<QString, Tree> result;
 
-	foreach(const Tree& entry, trees()) {
-		result[nameFor(entry)] = entry;
+	foreach (const TreeEntry &entry, rawEntries()) {
+		if (entry.isTree()) {
+			result[entry.name] = objectFor(entry).toTree();
+		}
 	}
 
 	return result;
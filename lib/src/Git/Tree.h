@@ -27,8 +27,10 @@
 
 #include "RawObject.h"
 
+#include <QByteArray>
 #include <QHash>
 #include <QMap>
+#include <QVector>
 
 
 
@@ -41,6 +43,39 @@ class TreePrivate;
 
 
 
+/**
+ * @brief An entry of a tree object as it is stored in the tree.
+ *
+ * It is only a few bytes, the entry's object is not loaded.
+ * Its type can be told by its mode.
+ */
+class KDE_EXPORT TreeEntry
+{
+	public:
+		TreeEntry();
+
+		/** @brief Is the entry a file or a symlink? */
+		bool isBlob() const;
+		/** @brief Is the entry a submodule's commit? */
+		bool isGitlink() const;
+		/** @brief Is the entry a subtree? */
+		bool isTree() const;
+
+		/**
+		 * @brief Returns the object's SHA1 as hex string.
+		 */
+		QString sha1String() const;
+
+		quint32 mode;
+		QString name;
+		/** The name as stored in the tree (UTF-8), which is what the entries are sorted by. */
+		QByteArray rawName;
+		/** The binary SHA1 of the entry's object. */
+		uchar   sha1[20];
+};
+
+
+
 /**
  * @brief A Git tree object.
  */
@@ -105,6 +140,7 @@ class KDE_EXPORT Tree : public RawObject
 		 * @brief Returns a list of all entries in this tree.
 		 *
 		 * Although it returns a list of objects these are only blobs and trees.
+		 * The objects are loaded, so use rawEntries() if you do not need them.
 		 *
 		 * @return The list of entries.
 		 *
@@ -121,6 +157,34 @@ class KDE_EXPORT Tree : public RawObject
 		 */
 		const QMap<QString, RawObject> entriesByName() const;
 
+		/**
+		 * @brief Looks up the entry with the given name in this tree.
+		 *
+		 * Git keeps the entries sorted, so it is a binary search that does not
+		 * load any objects (unlike the ByName() maps which are built on every call).
+		 *
+		 * @param name The entry's name (not a path).
+		 * @param result Is set to the entry if it has been found.
+		 * @return Whether there is an entry with this name.
+		 *
+		 * @see findPath(), rawEntries()
+		 */
+		bool findEntry(const QString &name, TreeEntry &result) const;
+
+		/**
+		 * @brief Looks up the entry for a path relative to this tree.
+		 *
+		 * Every subtree on the way is searched with findEntry(). Their entries
+		 * are cached by the repo, so resolving many paths only reads each subtree once.
+		 *
+		 * @param path The entry's path (e.g. "dir/file.txt").
+		 * @param result Is set to the entry if it has been found.
+		 * @return Whether there is an entry for this path.
+		 *
+		 * @see objectAt(), Repo::treeEntries()
+		 */
+		bool findPath(const QString &path, TreeEntry &result) const;
+
 		/**
 		 * @brief Returns the name that is associated with the given object in this tree.
 		 *
@@ -132,6 +196,16 @@ class KDE_EXPORT Tree : public RawObject
 		const QString& nameFor(const RawObject &object) const;
 		const QString& nameFor(const Id &id) const;
 
+		/**
+		 * @brief Returns the object for a path relative to this tree.
+		 *
+		 * @param path The entry's path (e.g. "dir/file.txt").
+		 * @return The blob or tree at @a path or an invalid object if there is none (or it is a submodule).
+		 *
+		 * @see findPath()
+		 */
+		RawObject& objectAt(const QString &path) const;
+
 		/**
 		 * @brief Assigns @a other to @a this.
 		 *
@@ -140,6 +214,15 @@ class KDE_EXPORT Tree : public RawObject
 		 */
 		Tree& operator=(const Tree &other);
 
+		/**
+		 * @brief Returns the entries without loading their objects.
+		 *
+		 * @return The entries in the order Git stores them.
+		 *
+		 * @see entries()
+		 */
+		const QVector<TreeEntry>& rawEntries() const;
+
 		/**
 		 * @brief Returns a list of all the (sub-)trees in this tree.
 		 *
@@ -168,6 +251,17 @@ class KDE_EXPORT Tree : public RawObject
 		 */
 		static Tree& invalid();
 
+		/**
+		 * @brief Extracts the entries from a tree's raw data.
+		 *
+		 * Unlike entries() this does not create any objects.
+		 * The entries are sorted like Git sorts them (i.e. trees sort as if they had a trailing "/").
+		 *
+		 * @param raw The raw tree data.
+		 * @return The entries in the order they are stored.
+		 */
+		static QVector<TreeEntry> readEntries(const QByteArray &raw);
+
 	private:
 		/**
 		 * @brief Populates the tree with the data extracted from the raw data.
@@ -185,6 +279,11 @@ class KDE_EXPORT Tree : public RawObject
 		 */
 		void lazyLoad();
 
+		/**
+		 * @brief Loads the object of the given entry.
+		 */
+		RawObject& objectFor(const TreeEntry &entry) const;
+
 	private:
 		QExplicitlySharedDataPointer<TreePrivate> d;
 
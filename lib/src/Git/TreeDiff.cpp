@@ -0,0 +1,747 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TreeDiff.h"
+
+#include "CatFileProcess.h"
+#include "Id.h"
+#include "LineDiff.h"
+#include "ObjectStorage.h"
+#include "Repo.h"
+
+#include <KDebug>
+
+#include <QMultiHash>
+#include <QtAlgorithms>
+#include <QtConcurrentMap>
+
+#include <string.h>
+
+using namespace Git;
+
+
+
+#define GitlinkMode  0160000
+#define FileMode     0100000
+#define TypeMask     0170000
+#define Sha1Size     20
+#define AbbreviatedIdSize  7
+#define EmptyBlobId  "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391"
+/** Similarities are scored like Git does it, i.e. MaxScore means identical. */
+#define MaxScore  60000
+#define SpanHashBase  107927
+#define MaxSpanSize  64
+/** Beyond this many sources times destinations only identical files are paired (like Git's diff.renameLimit). */
+#define RenameLimit  1000
+/** The number of blobs read (and kept in memory) at a time for scoring renames. */
+#define RenameBatchSize  256
+
+
+
+/**
+ * @brief A deleted, modified or added file taking part in rename detection.
+ */
+struct RenameCandidate
+{
+	RenameCandidate()
+		: change(-1)
+		, data()
+		, name()
+		, size(0)
+		, spans()
+	{}
+
+	/** The index of the file in the changes */
+	int change;
+	/** The content, only kept until the spans have been hashed */
+	QByteArray data;
+	QString name;
+	int size;
+	/** The hashes of the content's spans with the number of bytes falling into them, sorted by hash */
+	QVector<QPair<quint32, int> > spans;
+};
+
+/**
+ * @brief A possible pairing of a source and a destination file.
+ */
+struct RenameMatch
+{
+	RenameMatch()
+		: destination(-1)
+		, hasSameName(false)
+		, score(0)
+		, source(-1)
+	{}
+
+	bool operator<(const RenameMatch &other) const
+	{
+		// better matches come first
+		if (score != other.score) {
+			return score > other.score;
+		}
+		return hasSameName && !other.hasSameName;
+	}
+
+	int destination;
+	bool hasSameName;
+	int score;
+	int source;
+};
+
+/**
+ * @brief Scores a destination against all sources.
+ */
+struct RenameScoring
+{
+	RenameScoring()
+		: destination(0)
+		, matches()
+		, minimumScore(0)
+		, sources(0)
+	{}
+
+	const RenameCandidate *destination;
+	QVector<RenameMatch> matches;
+	int minimumScore;
+	const QVector<RenameCandidate> *sources;
+};
+
+
+
+/**
+ * Compares tree entries like Git sorts them (i.e. trees sort as if they had a trailing "/").
+ */
+static int compareEntries(const TreeEntry &a, const TreeEntry &b)
+{
+	bool aIsTree = a.isTree();
+	bool bIsTree = b.isTree();
+	if (aIsTree == bIsTree && a.name == b.name) {
+		return 0;
+	}
+
+	QByteArray aKey = a.name.toUtf8();
+	if (aIsTree) {
+		aKey += '/';
+	}
+	QByteArray bKey = b.name.toUtf8();
+	if (bIsTree) {
+		bKey += '/';
+	}
+
+	return aKey < bKey ? -1 : (aKey == bKey ? 0 : 1);
+}
+
+
+
+/**
+ * Returns the name of a file without its directory.
+ */
+static QString fileNameOf(const QString &path)
+{
+	return path.mid(path.lastIndexOf('/') + 1);
+}
+
+/**
+ * Splits the content of @a candidate into spans ending at line ends (or after 64 bytes) and counts the bytes of equal spans.
+ * It works like Git's spanhash, so the similarities match Git's.
+ */
+static void hashSpans(RenameCandidate *candidate)
+{
+	const QByteArray &data = candidate->data;
+	bool isText = !LineDiff::isBinary(data);
+
+	QHash<quint32, int> byteCounts;
+	quint32 accum1 = 0;
+	quint32 accum2 = 0;
+	int spanSize = 0;
+	for (int i=0; i < data.size(); ++i) {
+		uchar c = data[i];
+
+		// ignore the CR of CRLF line ends in texts
+		if (isText && c == '\r' && i + 1 < data.size() && data[i + 1] == '\n') {
+			continue;
+		}
+
+		quint32 oldAccum1 = accum1;
+		accum1 = (accum1 << 7) ^ (accum2 >> 25);
+		accum2 = (accum2 << 7) ^ (oldAccum1 >> 25);
+		accum1 += c;
+		if (++spanSize < MaxSpanSize && c != '\n') {
+			continue;
+		}
+
+		byteCounts[(accum1 + accum2 * 0x61) % SpanHashBase] += spanSize;
+		accum1 = 0;
+		accum2 = 0;
+		spanSize = 0;
+	}
+	if (spanSize > 0) {
+		byteCounts[(accum1 + accum2 * 0x61) % SpanHashBase] += spanSize;
+	}
+
+	candidate->spans.reserve(byteCounts.size());
+	QHash<quint32, int>::const_iterator span;
+	for (span = byteCounts.constBegin(); span != byteCounts.constEnd(); ++span) {
+		candidate->spans << qMakePair(span.key(), span.value());
+	}
+	qSort(candidate->spans);
+
+	candidate->size = data.size();
+	candidate->data.clear();
+}
+
+/**
+ * Scores how similar @a destination is to @a source.
+ *
+ * @return The score or 0 if it is below @a minimumScore.
+ */
+static int similarityOf(const RenameCandidate &source, const RenameCandidate &destination, int minimumScore)
+{
+	int maxSize = qMax(source.size, destination.size);
+	int sizeDifference = maxSize - qMin(source.size, destination.size);
+
+	// files that differ that much in size can not be similar enough
+	if (destination.size == 0 || qint64(maxSize) * (MaxScore - minimumScore) < qint64(sizeDifference) * MaxScore) {
+		return 0;
+	}
+
+	// count the bytes of the source that are still in the destination
+	qint64 copiedBytes = 0;
+	int sourcePos = 0;
+	int destinationPos = 0;
+	while (sourcePos < source.spans.size() && destinationPos < destination.spans.size()) {
+		const QPair<quint32, int> &sourceSpan = source.spans[sourcePos];
+		const QPair<quint32, int> &destinationSpan = destination.spans[destinationPos];
+
+		if (sourceSpan.first < destinationSpan.first) {
+			++sourcePos;
+		} else if (sourceSpan.first > destinationSpan.first) {
+			++destinationPos;
+		} else {
+			copiedBytes += qMin(sourceSpan.second, destinationSpan.second);
+			++sourcePos;
+			++destinationPos;
+		}
+	}
+
+	int score = copiedBytes * MaxScore / maxSize;
+	return score < minimumScore ? 0 : score;
+}
+
+/**
+ * Pairs the destinations with their best matching sources.
+ *
+ * A deleted file can only be renamed once. Further destinations become copies of it if @a findCopies is set.
+ */
+static void pairRenames(const QList<TreeChange> &changes, QVector<RenameMatch> &matches, bool findCopies, QVector<int> &pairedSources, QVector<int> &scores, QVector<int> &renamedTo)
+{
+	qStableSort(matches.begin(), matches.end());
+
+	foreach (const RenameMatch &match, matches) {
+		if (pairedSources[match.destination] >= 0) {
+			continue;
+		}
+
+		if (changes[match.source].type() == TreeChange::Deleted && renamedTo[match.source] < 0) {
+			renamedTo[match.source] = match.destination;
+		} else if (!findCopies) {
+			continue;
+		}
+
+		pairedSources[match.destination] = match.source;
+		scores[match.destination] = match.score;
+	}
+}
+
+/**
+ * Scores the destination of @a scoring against all its sources.
+ */
+static void scoreRenames(RenameScoring &scoring)
+{
+	for (int i=0; i < scoring.sources->size(); ++i) {
+		const RenameCandidate &source = scoring.sources->at(i);
+
+		int score = similarityOf(source, *scoring.destination, scoring.minimumScore);
+		if (score == 0) {
+			continue;
+		}
+
+		RenameMatch match;
+		match.destination = scoring.destination->change;
+		match.hasSameName = source.name == scoring.destination->name;
+		match.score = score;
+		match.source = source.change;
+		scoring.matches << match;
+	}
+}
+
+
+
+TreeChange::TreeChange()
+	: isCopy(false)
+	, oldId()
+	, oldMode(0)
+	, oldPath()
+	, newId()
+	, newMode(0)
+	, path()
+	, similarity(0)
+{
+}
+
+TreeChange::Type TreeChange::type() const
+{
+	if (!oldPath.isNull()) {
+		return isCopy ? Copied : Renamed;
+	} else if (oldId.isEmpty()) {
+		return Added;
+	} else if (newId.isEmpty()) {
+		return Deleted;
+	}
+
+	return Modified;
+}
+
+
+
+TreeDiff::TreeDiff(Repo &repo, const QString &oldTreeId, const QString &newTreeId)
+	: m_changes()
+	, m_fullIndex(false)
+	, m_repo(repo)
+{
+	compareTrees(oldTreeId, newTreeId, QString());
+}
+
+TreeDiff::TreeDiff(Repo &repo, const QList<TreeChange> &changes)
+	: m_changes(changes)
+	, m_fullIndex(false)
+	, m_repo(repo)
+{
+}
+
+void TreeDiff::addEntries(const QString &treeId, const QString &prefix, bool added)
+{
+	foreach (const TreeEntry &entry, Tree::readEntries(objectDataFor(treeId))) {
+		addEntry(entry, prefix, added);
+	}
+}
+
+void TreeDiff::addEntry(const TreeEntry &entry, const QString &prefix, bool added)
+{
+	if (entry.isTree()) {
+		addEntries(entry.sha1String(), prefix + entry.name + '/', added);
+		return;
+	}
+
+	TreeChange change;
+	change.path = prefix + entry.name;
+	if (added) {
+		change.newId = entry.sha1String();
+		change.newMode = entry.mode;
+	} else {
+		change.oldId = entry.sha1String();
+		change.oldMode = entry.mode;
+	}
+	m_changes << change;
+}
+
+void TreeDiff::applyRenames(const QVector<int> &pairedSources, const QVector<int> &scores, const QVector<int> &renamedTo)
+{
+	QList<TreeChange> changes;
+
+	for (int i=0; i < m_changes.size(); ++i) {
+		// the deleted file shows up as the destination it has been renamed to
+		if (renamedTo[i] >= 0) {
+			continue;
+		}
+
+		TreeChange change = m_changes[i];
+
+		int source = pairedSources[i];
+		if (source >= 0) {
+			const TreeChange &original = m_changes[source];
+			change.isCopy = renamedTo[source] != i;
+			change.oldId = original.oldId;
+			change.oldMode = original.oldMode;
+			change.oldPath = original.path;
+			change.similarity = scores[i] * 100 / MaxScore;
+		}
+
+		changes << change;
+	}
+
+	m_changes = changes;
+}
+
+const QList<TreeChange>& TreeDiff::changes() const
+{
+	return m_changes;
+}
+
+void TreeDiff::compareTrees(const QString &oldTreeId, const QString &newTreeId, const QString &prefix)
+{
+	QVector<TreeEntry> oldEntries;
+	if (!oldTreeId.isEmpty()) {
+		oldEntries = Tree::readEntries(objectDataFor(oldTreeId));
+	}
+	QVector<TreeEntry> newEntries;
+	if (!newTreeId.isEmpty()) {
+		newEntries = Tree::readEntries(objectDataFor(newTreeId));
+	}
+
+	int oldPos = 0;
+	int newPos = 0;
+	while (oldPos < oldEntries.size() || newPos < newEntries.size()) {
+		int order;
+		if (oldPos == oldEntries.size()) {
+			order = 1;
+		} else if (newPos == newEntries.size()) {
+			order = -1;
+		} else {
+			order = compareEntries(oldEntries[oldPos], newEntries[newPos]);
+		}
+
+		if (order < 0) {
+			addEntry(oldEntries[oldPos++], prefix, false);
+			continue;
+		} else if (order > 0) {
+			addEntry(newEntries[newPos++], prefix, true);
+			continue;
+		}
+
+		const TreeEntry &oldEntry = oldEntries[oldPos++];
+		const TreeEntry &newEntry = newEntries[newPos++];
+
+		// equal ids mean equal contents, so unchanged subtrees need not be read
+		if (memcmp(oldEntry.sha1, newEntry.sha1, Sha1Size) == 0 && oldEntry.mode == newEntry.mode) {
+			continue;
+		}
+
+		if (oldEntry.isTree()) {
+			compareTrees(oldEntry.sha1String(), newEntry.sha1String(), prefix + oldEntry.name + '/');
+			continue;
+		}
+
+		TreeChange change;
+		change.path = prefix + oldEntry.name;
+		change.oldId = oldEntry.sha1String();
+		change.oldMode = oldEntry.mode;
+		change.newId = newEntry.sha1String();
+		change.newMode = newEntry.mode;
+		m_changes << change;
+	}
+}
+
+void TreeDiff::detectRenames(bool findCopies, int minimumSimilarity)
+{
+	int minimumScore = minimumSimilarity * MaxScore / 100;
+
+	QList<int> sources;
+	QList<int> destinations;
+	for (int i=0; i < m_changes.size(); ++i) {
+		const TreeChange &change = m_changes[i];
+		if ((change.oldMode & TypeMask) == GitlinkMode || (change.newMode & TypeMask) == GitlinkMode) {
+			continue;
+		}
+
+		switch (change.type()) {
+		case TreeChange::Added:
+			if (change.newId != EmptyBlobId) {
+				destinations << i;
+			}
+			break;
+		case TreeChange::Deleted:
+			if (change.oldId != EmptyBlobId) {
+				sources << i;
+			}
+			break;
+		case TreeChange::Modified:
+			if (findCopies) {
+				sources << i;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (sources.isEmpty() || destinations.isEmpty()) {
+		return;
+	}
+
+	QVector<RenameMatch> matches;
+
+	// identical files are paired first
+	QMultiHash<QString, int> sourcesById;
+	foreach (int source, sources) {
+		sourcesById.insert(m_changes[source].oldId, source);
+	}
+	foreach (int destination, destinations) {
+		const TreeChange &change = m_changes[destination];
+		foreach (int source, sourcesById.values(change.newId)) {
+			if ((m_changes[source].oldMode & TypeMask) != (change.newMode & TypeMask)) {
+				continue;
+			}
+
+			RenameMatch match;
+			match.destination = destination;
+			match.hasSameName = fileNameOf(m_changes[source].path) == fileNameOf(change.path);
+			match.score = MaxScore;
+			match.source = source;
+			matches << match;
+		}
+	}
+
+	QVector<int> pairedSources(m_changes.size(), -1);
+	QVector<int> similarities(m_changes.size(), 0);
+	QVector<int> renamedTo(m_changes.size(), -1);
+	pairRenames(m_changes, matches, findCopies, pairedSources, similarities, renamedTo);
+
+	// score the similarities of the remaining regular files
+	QVector<RenameCandidate> sourceCandidates;
+	foreach (int source, sources) {
+		if ((m_changes[source].oldMode & TypeMask) != FileMode || (renamedTo[source] >= 0 && !findCopies)) {
+			continue;
+		}
+
+		RenameCandidate candidate;
+		candidate.change = source;
+		candidate.name = fileNameOf(m_changes[source].path);
+		sourceCandidates << candidate;
+	}
+	QVector<RenameCandidate> destinationCandidates;
+	foreach (int destination, destinations) {
+		if ((m_changes[destination].newMode & TypeMask) != FileMode || pairedSources[destination] >= 0) {
+			continue;
+		}
+
+		RenameCandidate candidate;
+		candidate.change = destination;
+		candidate.name = fileNameOf(m_changes[destination].path);
+		destinationCandidates << candidate;
+	}
+
+	if (sourceCandidates.isEmpty() || destinationCandidates.isEmpty()) {
+		applyRenames(pairedSources, similarities, renamedTo);
+		return;
+	}
+	if (qint64(sourceCandidates.size()) * destinationCandidates.size() > qint64(RenameLimit) * RenameLimit) {
+		kWarning() << "too many files for detecting inexact renames:" << sourceCandidates.size() << "sources," << destinationCandidates.size() << "destinations";
+		applyRenames(pairedSources, similarities, renamedTo);
+		return;
+	}
+
+	// the storages are not thread-safe, so only the hashing happens on all cores
+	QList<RenameCandidate*> candidates;
+	QStringList ids;
+	for (int i=0; i < sourceCandidates.size(); ++i) {
+		candidates << &sourceCandidates[i];
+		ids << m_changes[sourceCandidates[i].change].oldId;
+	}
+	for (int i=0; i < destinationCandidates.size(); ++i) {
+		candidates << &destinationCandidates[i];
+		ids << m_changes[destinationCandidates[i].change].newId;
+	}
+
+	// only a batch of blobs is kept in memory until its spans are known
+	for (int start=0; start < candidates.size(); start += RenameBatchSize) {
+		QList<RenameCandidate*> batch = candidates.mid(start, RenameBatchSize);
+		QList<QByteArray> data = objectDataFor(ids.mid(start, RenameBatchSize));
+		for (int i=0; i < batch.size(); ++i) {
+			batch[i]->data = data[i];
+		}
+		// leave the candidates holding the only references, so hashSpans() frees them
+		data = QList<QByteArray>();
+
+		QtConcurrent::blockingMap(batch, hashSpans);
+	}
+
+	QVector<RenameScoring> scorings(destinationCandidates.size());
+	for (int i=0; i < destinationCandidates.size(); ++i) {
+		scorings[i].destination = &destinationCandidates[i];
+		scorings[i].minimumScore = minimumScore;
+		scorings[i].sources = &sourceCandidates;
+	}
+	QtConcurrent::blockingMap(scorings, scoreRenames);
+
+	matches.clear();
+	foreach (const RenameScoring &scoring, scorings) {
+		matches += scoring.matches;
+	}
+	pairRenames(m_changes, matches, findCopies, pairedSources, similarities, renamedTo);
+
+	applyRenames(pairedSources, similarities, renamedTo);
+}
+
+QString TreeDiff::diffFor(const TreeChange &change) const
+{
+	return QString::fromUtf8(formatDiff(change));
+}
+
+QByteArray TreeDiff::formatDiff(const TreeChange &change) const
+{
+	// like Git show changes of the file type (e.g. to a symlink) as a deletion and an addition
+	if (change.type() == TreeChange::Modified && (change.oldMode & TypeMask) != (change.newMode & TypeMask)) {
+		TreeChange deletion = change;
+		deletion.newId = QString();
+		deletion.newMode = 0;
+		TreeChange addition = change;
+		addition.oldId = QString();
+		addition.oldMode = 0;
+		return formatDiff(deletion) + formatDiff(addition);
+	}
+
+	const QString &oldId = change.oldId;
+	const QString &newId = change.newId;
+	QByteArray oldPath = (change.oldPath.isNull() ? change.path : change.oldPath).toUtf8();
+	QByteArray newPath = change.path.toUtf8();
+	QByteArray diff = "diff --git a/" + oldPath + " b/" + newPath + "\n";
+
+	if (oldId.isEmpty()) {
+		diff += "new file mode " + QByteArray::number(change.newMode, 8) + "\n";
+	} else if (newId.isEmpty()) {
+		diff += "deleted file mode " + QByteArray::number(change.oldMode, 8) + "\n";
+	} else if (change.oldMode != change.newMode) {
+		diff += "old mode " + QByteArray::number(change.oldMode, 8) + "\n";
+		diff += "new mode " + QByteArray::number(change.newMode, 8) + "\n";
+	}
+
+	if (!change.oldPath.isNull()) {
+		QByteArray how = change.isCopy ? "copy" : "rename";
+		diff += "similarity index " + QByteArray::number(change.similarity) + "%\n";
+		diff += how + " from " + oldPath + "\n";
+		diff += how + " to " + newPath + "\n";
+	}
+
+	if (oldId == newId) {
+		// only the mode or the path has changed
+		return diff;
+	}
+
+	diff += "index " + indexIdFor(oldId).toLatin1() + ".." + indexIdFor(newId).toLatin1();
+	if (!oldId.isEmpty() && !newId.isEmpty() && change.oldMode == change.newMode) {
+		diff += " " + QByteArray::number(change.oldMode, 8);
+	}
+	diff += "\n";
+
+	QByteArray oldName = oldId.isEmpty() ? QByteArray("/dev/null") : "a/" + oldPath;
+	QByteArray newName = newId.isEmpty() ? QByteArray("/dev/null") : "b/" + newPath;
+
+	// submodules are shown by the commit they point to
+	QByteArray oldData;
+	if ((change.oldMode & TypeMask) == GitlinkMode) {
+		oldData = "Subproject commit " + oldId.toLatin1() + "\n";
+	} else if (!oldId.isEmpty()) {
+		oldData = objectDataFor(oldId);
+	}
+	QByteArray newData;
+	if ((change.newMode & TypeMask) == GitlinkMode) {
+		newData = "Subproject commit " + newId.toLatin1() + "\n";
+	} else if (!newId.isEmpty()) {
+		newData = objectDataFor(newId);
+	}
+
+	if (LineDiff::isBinary(oldData) || LineDiff::isBinary(newData)) {
+		diff += "Binary files " + oldName + " and " + newName + " differ\n";
+		return diff;
+	}
+
+	LineDiff lineDiff(oldData, newData);
+	if (lineDiff.hasChanges()) {
+		diff += "--- " + oldName + "\n";
+		diff += "+++ " + newName + "\n";
+		diff += lineDiff.unifiedDiff();
+	}
+
+	return diff;
+}
+
+QString TreeDiff::indexIdFor(const QString &id) const
+{
+	int size = m_fullIndex ? 40 : AbbreviatedIdSize;
+
+	if (id.isEmpty()) {
+		return QString(size, '0');
+	}
+
+	return id.left(size);
+}
+
+QByteArray TreeDiff::objectDataFor(const QString &id) const
+{
+	ObjectStorage *storage = m_repo.storageFor(id);
+	if (!storage) {
+		// e.g. it is in an alternate object database
+		QByteArray data = m_repo.catFileProcess()->readObject(id);
+		if (data.isNull()) {
+			kWarning() << "Could not find object" << id;
+		}
+		return data;
+	}
+
+	return storage->objectDataFor(Id(id, *storage));
+}
+
+QList<QByteArray> TreeDiff::objectDataFor(const QStringList &ids) const
+{
+	QList<QByteArray> data;
+	QStringList missingIds;
+	QList<int> missingPositions;
+
+	foreach (const QString &id, ids) {
+		ObjectStorage *storage = m_repo.storageFor(id);
+		if (storage) {
+			data << storage->objectDataFor(Id(id, *storage));
+		} else {
+			data << QByteArray();
+			missingIds << id;
+			missingPositions << data.size() - 1;
+		}
+	}
+
+	if (missingIds.isEmpty()) {
+		return data;
+	}
+
+	// the objects Git has to read are requested at once
+	QList<QByteArray> missingData = m_repo.catFileProcess()->readObjects(missingIds);
+	for (int i=0; i < missingIds.size(); ++i) {
+		if (missingData[i].isNull()) {
+			kWarning() << "Could not find object" << missingIds[i];
+		}
+		data[missingPositions[i]] = missingData[i];
+	}
+
+	return data;
+}
+
+void TreeDiff::setFullIndex(bool fullIndex)
+{
+	m_fullIndex = fullIndex;
+}
+
+QString TreeDiff::unifiedDiff() const
+{
+	QByteArray diff;
+
+	foreach (const TreeChange &change, m_changes) {
+		diff += formatDiff(change);
+	}
+
+	return QString::fromUtf8(diff);
+}
@@ -0,0 +1,199 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Compares two trees.
+ */
+
+#ifndef TREEDIFF_H
+#define TREEDIFF_H
+
+#include "Tree.h"
+
+#include <kdemacros.h>
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+
+class TreeDiffTest;
+
+namespace Git {
+
+class Repo;
+
+
+
+/**
+ * @brief A file that differs between two trees.
+ *
+ * A path that is a file in one tree and a directory in the other shows up
+ * as a deleted file and as added files (like in Git's diffs).
+ *
+ * @see TreeDiff::detectRenames()
+ */
+class KDE_EXPORT TreeChange
+{
+	public:
+		enum Type {
+			Added,
+			Deleted,
+			Modified,
+			Renamed,
+			Copied
+		};
+
+		TreeChange();
+
+		/**
+		 * @brief Returns whether the file has been added, deleted, modified, renamed or copied.
+		 */
+		Type type() const;
+
+		/** Whether the file is a copy of #oldPath (which still exists) */
+		bool isCopy;
+		/** The id in the old tree or a null string if the file has been added */
+		QString oldId;
+		quint32 oldMode;
+		/** The path the file has been renamed or copied from or a null string */
+		QString oldPath;
+		/** The id in the new tree or a null string if the file has been deleted */
+		QString newId;
+		quint32 newMode;
+		QString path;
+		/** How similar (in percent) a renamed or copied file is to its original */
+		int similarity;
+};
+
+
+
+/**
+ * @brief Compares two trees.
+ *
+ * Both trees are walked side by side in Git's sort order. Subtrees with the
+ * same id in both trees are skipped without being read, so the costs depend
+ * on how much has changed and not on the size of the trees.
+ *
+ * Only the changed paths are collected when the diff is constructed. The
+ * content of a file is only compared when its diff is requested:
+ * @code
+ *   TreeDiff diff(repo, oldTreeId, newTreeId);
+ *   foreach (const TreeChange &change, diff.changes()) {
+ *     list(change.path);
+ *   }
+ *   show(diff.diffFor(diff.changes()[selected]));
+ * @endcode
+ */
+class KDE_EXPORT TreeDiff
+{
+	public:
+		/**
+		 * @brief Compares the tree @a oldTreeId with the tree @a newTreeId.
+		 *
+		 * @param repo The repo the trees are in.
+		 * @param oldTreeId The old tree's id or a null string for an empty tree.
+		 * @param newTreeId The new tree's id or a null string for an empty tree.
+		 */
+		TreeDiff(Repo &repo, const QString &oldTreeId, const QString &newTreeId);
+
+		/**
+		 * @brief Takes the changes another diff has found.
+		 *
+		 * This is intended for diffs that have been computed (and had their
+		 * renames detected) with another repo object of the same repository,
+		 * e.g. in a background thread.
+		 *
+		 * @param repo The repo the changed files are in.
+		 * @param changes The other diff's changes().
+		 */
+		TreeDiff(Repo &repo, const QList<TreeChange> &changes);
+
+		/**
+		 * @brief Returns the changed files in the order Git lists them.
+		 */
+		const QList<TreeChange>& changes() const;
+
+		/**
+		 * @brief Formats the diff of a single file like "git diff" does.
+		 *
+		 * @param change One of changes().
+		 * @return The diff including its "diff --git" header.
+		 */
+		QString diffFor(const TreeChange &change) const;
+
+		/**
+		 * @brief Pairs deleted and added files with similar contents as renames.
+		 *
+		 * Like Git, files with the same id are paired first. The contents of the
+		 * remaining files are split into chunks at line ends (or every 64 bytes),
+		 * which are hashed and compared. The similarities are calculated on all
+		 * cores.
+		 *
+		 * Renamed or copied files replace the added files in changes(). The
+		 * deleted files they have been renamed from are removed.
+		 *
+		 * @param findCopies Whether added files may also be copies of modified or
+		 *   already renamed files (like "git diff -C").
+		 * @param minimumSimilarity How similar (in percent) the contents must at least be.
+		 */
+		void detectRenames(bool findCopies = false, int minimumSimilarity = 50);
+
+		/**
+		 * @brief Sets whether the "index" lines show full ids (like "git diff --full-index").
+		 *
+		 * They are abbreviated by default.
+		 */
+		void setFullIndex(bool fullIndex);
+
+		/**
+		 * @brief Formats the diffs of all files.
+		 *
+		 * @return The whole diff like "git diff" would output it.
+		 *
+		 * @see diffFor()
+		 */
+		QString unifiedDiff() const;
+
+	private:
+		void addEntries(const QString &treeId, const QString &prefix, bool added);
+		void addEntry(const TreeEntry &entry, const QString &prefix, bool added);
+		void applyRenames(const QVector<int> &pairedSources, const QVector<int> &scores, const QVector<int> &renamedTo);
+		void compareTrees(const QString &oldTreeId, const QString &newTreeId, const QString &prefix);
+		QByteArray formatDiff(const TreeChange &change) const;
+		QString indexIdFor(const QString &id) const;
+		/** Reads the object natively or else with Git (e.g. from alternates) */
+		QByteArray objectDataFor(const QString &id) const;
+		/** Like objectDataFor(), but the objects Git has to read are requested at once */
+		QList<QByteArray> objectDataFor(const QStringList &ids) const;
+
+	private:
+		QList<TreeChange> m_changes;
+		bool m_fullIndex;
+		Repo &m_repo;
+
+		friend class ::TreeDiffTest;
+};
+
+}
+
+#endif // TREEDIFF_H
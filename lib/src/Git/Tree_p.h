@@ -21,13 +21,13 @@
 
 #include "RawObject_p.h"
 
-#include <QHash>
+#include "Tree.h"
 
+#include <QVector>
 
 
-namespace Git {
 
-class Tree;
+namespace Git {
 
 
 
@@ -36,26 +36,22 @@ public:
 	TreePrivate()
 		: RawObjectPrivate()
 		, entries()
-		, entryModes()
-		, entryNames()
+		, isLoaded(false)
 	{}
 	TreePrivate(const RawObjectPrivate &other)
 		: RawObjectPrivate(other)
 		, entries()
-		, entryModes()
-		, entryNames()
+		, isLoaded(false)
 	{}
 	TreePrivate(const TreePrivate &other)
 		: RawObjectPrivate(other)
 		, entries(other.entries)
-		, entryModes(other.entryModes)
-		, entryNames(other.entryNames)
+		, isLoaded(other.isLoaded)
 	{}
 	~TreePrivate() {}
 
-	QList<RawObject>   entries;
-	QHash<Id, QString> entryModes;
-	QHash<Id, QString> entryNames;
+	QVector<TreeEntry> entries;
+	bool               isLoaded;
 };
 
 }
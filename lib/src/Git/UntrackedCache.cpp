@@ -0,0 +1,266 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "UntrackedCache.h"
+
+#include "IgnoreRules.h"
+#include "Index.h"
+#include "Repo.h"
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace Git;
+
+
+
+#define IgnoreFileName  ".gitignore"
+
+
+
+/**
+ * Returns the parts of the stat data that change when a directory's entries
+ * or a file's content change.
+ *
+ * @return The stat data or an empty array if @a path does not exist.
+ */
+static QByteArray statDataFor(const QByteArray &path)
+{
+	struct stat fileStat;
+	if (lstat(path.constData(), &fileStat) != 0) {
+		return QByteArray();
+	}
+
+	QByteArray statData;
+	statData.append(QByteArray::number(qint64(fileStat.st_mtim.tv_sec))).append('.');
+	statData.append(QByteArray::number(qint64(fileStat.st_mtim.tv_nsec))).append(':');
+	statData.append(QByteArray::number(qint64(fileStat.st_ctim.tv_sec))).append(':');
+	statData.append(QByteArray::number(quint64(fileStat.st_ino))).append(':');
+	statData.append(QByteArray::number(qint64(fileStat.st_size)));
+
+	return statData;
+}
+
+/**
+ * Checks whether the stat data still matches and can be trusted.
+ * Changes in the same second as the scan may not be visible in the stat data.
+ */
+static bool isUpToDate(const QByteArray &cachedStatData, const QByteArray &statData, uint scannedAt)
+{
+	return cachedStatData == statData && (statData.isEmpty() || statData.left(statData.indexOf('.')).toUInt() < scannedAt);
+}
+
+
+
+UntrackedCacheDirectory::UntrackedCacheDirectory()
+	: directoryStat()
+	, ignoreFileStat()
+	, scannedAt(0)
+	, files()
+	, ignoredFiles()
+	, ignoredDirectories()
+	, subdirectories()
+{
+}
+
+
+
+UntrackedCache::UntrackedCache(const QString &workingDir)
+	: m_directories()
+	, m_mutex()
+	, m_readDirectories(0)
+	, m_repoWideRulesStat()
+	, m_workingDir(QFile::encodeName(workingDir) + '/')
+{
+}
+
+
+
+void UntrackedCache::clear()
+{
+	QMutexLocker locker(&m_mutex);
+	m_directories.clear();
+	m_repoWideRulesStat.clear();
+}
+
+int UntrackedCache::count() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_directories.size();
+}
+
+QSharedPointer<UntrackedCache> UntrackedCache::forWorkingDir(const QString &workingDir)
+{
+	static QMutex cachesMutex;
+	static QHash<QString, QWeakPointer<UntrackedCache> > caches;
+
+	QMutexLocker locker(&cachesMutex);
+
+	QSharedPointer<UntrackedCache> cache = caches.value(workingDir).toStrongRef();
+	if (!cache) {
+		cache = QSharedPointer<UntrackedCache>(new UntrackedCache(workingDir));
+		caches.insert(workingDir, cache.toWeakRef());
+	}
+
+	return cache;
+}
+
+void UntrackedCache::invalidate(const QByteArray &directory)
+{
+	QMutexLocker locker(&m_mutex);
+	m_directories.remove(directory);
+}
+
+void UntrackedCache::readDirectory(const QByteArray &directory, IgnoreRules &rules, UntrackedCacheDirectory &cached)
+{
+	++m_readDirectories;
+
+	cached.files.clear();
+	cached.ignoredFiles.clear();
+	cached.ignoredDirectories.clear();
+	cached.subdirectories.clear();
+
+	DIR *dir = opendir((m_workingDir + directory).constData());
+	if (!dir) {
+		return;
+	}
+
+	struct dirent *dirEntry;
+	while ((dirEntry = readdir(dir)) != 0) {
+		const char *name = dirEntry->d_name;
+		if (qstrcmp(name, ".") == 0 || qstrcmp(name, "..") == 0 || qstrcmp(name, ".git") == 0) {
+			continue;
+		}
+
+		QByteArray path = directory + name;
+
+		// some file systems don't tell the type
+		bool isDirectory = dirEntry->d_type == DT_DIR;
+		if (dirEntry->d_type == DT_UNKNOWN) {
+			struct stat fileStat;
+			isDirectory = lstat((m_workingDir + path).constData(), &fileStat) == 0 && S_ISDIR(fileStat.st_mode);
+		}
+
+		if (isDirectory) {
+			if (rules.isIgnored(path, true)) {
+				cached.ignoredDirectories << name;
+			} else {
+				cached.subdirectories << name;
+			}
+		} else if (rules.isIgnored(path, false)) {
+			cached.ignoredFiles << name;
+		} else {
+			cached.files << name;
+		}
+	}
+	closedir(dir);
+}
+
+void UntrackedCache::scan(const Repo &repo, const Index &index, QList<QByteArray> *untracked, QList<QByteArray> *ignored)
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_readDirectories = 0;
+
+	IgnoreRules rules(repo);
+
+	// everything depends on the global and repo wide rules
+	QByteArray repoWideRulesStat;
+	foreach (const QString &file, rules.repoWideFiles()) {
+		repoWideRulesStat.append(statDataFor(QFile::encodeName(file))).append('|');
+	}
+	bool rulesChanged = repoWideRulesStat != m_repoWideRulesStat;
+	m_repoWideRulesStat = repoWideRulesStat;
+
+	scanDirectory(QByteArray(), index, rules, rulesChanged, untracked, ignored);
+
+	if (untracked) {
+		qSort(*untracked);
+	}
+	if (ignored) {
+		qSort(*ignored);
+	}
+}
+
+void UntrackedCache::scanDirectory(const QByteArray &directory, const Index &index, IgnoreRules &rules, bool rulesChanged, QList<QByteArray> *untracked, QList<QByteArray> *ignored)
+{
+	QByteArray directoryStat = statDataFor(m_workingDir + directory);
+	if (directoryStat.isEmpty()) {
+		m_directories.remove(directory);
+		return;
+	}
+	QByteArray ignoreFileStat = statDataFor(m_workingDir + directory + IgnoreFileName);
+
+	rules.enterDirectory(directory);
+
+	UntrackedCacheDirectory &cached = m_directories[directory];
+	bool ignoreFileChanged = rulesChanged || !isUpToDate(cached.ignoreFileStat, ignoreFileStat, cached.scannedAt);
+	if (ignoreFileChanged || !isUpToDate(cached.directoryStat, directoryStat, cached.scannedAt)) {
+		cached.directoryStat = directoryStat;
+		cached.ignoreFileStat = ignoreFileStat;
+		cached.scannedAt = time(0);
+		readDirectory(directory, rules, cached);
+	}
+
+	// copy the names, the cache may grow while descending
+	UntrackedCacheDirectory current = cached;
+
+	// tracked files are left out
+	foreach (const QByteArray &name, current.files) {
+		QByteArray path = directory + name;
+		if (untracked && index.indexOf(QString::fromUtf8(path)) < 0) {
+			*untracked << path;
+		}
+	}
+	foreach (const QByteArray &name, current.ignoredFiles) {
+		QByteArray path = directory + name;
+		if (ignored && index.indexOf(QString::fromUtf8(path)) < 0) {
+			*ignored << path;
+		}
+	}
+	foreach (const QByteArray &name, current.ignoredDirectories) {
+		if (ignored) {
+			*ignored << directory + name + '/';
+		}
+	}
+
+	foreach (const QByteArray &name, current.subdirectories) {
+		QByteArray path = directory + name;
+
+		if (index.indexOf(QString::fromUtf8(path)) >= 0) {
+			// a submodule
+			continue;
+		} else if (access((m_workingDir + path + "/.git").constData(), F_OK) == 0) {
+			// nested repositories are reported as a whole
+			if (untracked) {
+				*untracked << path + '/';
+			}
+		} else {
+			// subdirectories have to be read again if the rules have changed
+			scanDirectory(path + '/', index, rules, ignoreFileChanged, untracked, ignored);
+		}
+	}
+
+	rules.leaveDirectory();
+}
@@ -0,0 +1,157 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Remembers the untracked files of the working directory between scans.
+ */
+
+#ifndef UNTRACKEDCACHE_H
+#define UNTRACKEDCACHE_H
+
+#include <kdemacros.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+
+
+
+class UntrackedCacheTest;
+
+namespace Git {
+
+class IgnoreRules;
+class Index;
+class Repo;
+
+
+
+/**
+ * @brief The scan results of a single directory.
+ */
+class KDE_EXPORT UntrackedCacheDirectory
+{
+	public:
+		UntrackedCacheDirectory();
+
+		/** The stat data of the directory when it was read. */
+		QByteArray directoryStat;
+		/** The stat data of the directory's .gitignore when it was read (empty if there is none). */
+		QByteArray ignoreFileStat;
+		/** When the directory was read (in seconds since the epoch). */
+		uint scannedAt;
+
+		/** The names of the files that are not ignored. Tracked files are included. */
+		QList<QByteArray> files;
+		/** The names of the ignored files. Tracked files are included. */
+		QList<QByteArray> ignoredFiles;
+		/** The names of the ignored subdirectories. */
+		QList<QByteArray> ignoredDirectories;
+		/** The names of the other subdirectories. */
+		QList<QByteArray> subdirectories;
+};
+
+
+
+/**
+ * @brief Remembers the untracked files of the working directory between scans.
+ *
+ * Like Git's untracked cache it records the results for every directory
+ * together with the directory's modification time. A directory is only read
+ * again if files have been added to or removed from it since, or if its
+ * ignore rules may have changed. So a scan after staging a file only has to
+ * stat the directories.
+ *
+ * Whether a file is tracked is decided when reading the cache, so changes
+ * of the index do not invalidate it.
+ *
+ * The cache is shared by all repo objects of a working directory (e.g. the
+ * ones used for loading the status in the background) and can be used from
+ * several threads.
+ *
+ * @see Repo::untrackedCache()
+ */
+class KDE_EXPORT UntrackedCache
+{
+	public:
+		/**
+		 * @brief Returns the cache of @a workingDir.
+		 *
+		 * It lives as long as any repo object of the working directory.
+		 */
+		static QSharedPointer<UntrackedCache> forWorkingDir(const QString &workingDir);
+
+		/**
+		 * @brief Forgets everything.
+		 */
+		void clear();
+
+		/**
+		 * @brief Returns the number of cached directories.
+		 */
+		int count() const;
+
+		/**
+		 * @brief Forces @a directory to be read again by the next scan.
+		 *
+		 * This is intended for change notifications (e.g. from a
+		 * QFileSystemWatcher) that arrive faster than the file system's
+		 * timestamp granularity.
+		 *
+		 * @param directory The directory relative to the working directory ("" for the root, otherwise with a trailing "/").
+		 */
+		void invalidate(const QByteArray &directory);
+
+		/**
+		 * @brief Finds the untracked and ignored files of the working tree.
+		 *
+		 * Only directories that have changed since the last scan are read.
+		 * Ignored directories are reported as a whole (with a trailing "/")
+		 * and are not descended into. The results are sorted.
+		 *
+		 * @param repo The repo of the working tree.
+		 * @param index The repo's index for deciding which files are tracked.
+		 * @param untracked Will receive the untracked files (may be 0).
+		 * @param ignored Will receive the ignored files and directories (may be 0).
+		 */
+		void scan(const Repo &repo, const Index &index, QList<QByteArray> *untracked, QList<QByteArray> *ignored);
+
+	private:
+		explicit UntrackedCache(const QString &workingDir);
+
+		void readDirectory(const QByteArray &directory, IgnoreRules &rules, UntrackedCacheDirectory &cached);
+		void scanDirectory(const QByteArray &directory, const Index &index, IgnoreRules &rules, bool rulesChanged, QList<QByteArray> *untracked, QList<QByteArray> *ignored);
+
+	private:
+		QHash<QByteArray, UntrackedCacheDirectory> m_directories;
+		mutable QMutex m_mutex;
+		/** The number of directories read by the last scan. */
+		int m_readDirectories;
+		QByteArray m_repoWideRulesStat;
+		QByteArray m_workingDir;
+
+		friend class ::UntrackedCacheTest;
+};
+
+}
+
+#endif // UNTRACKEDCACHE_H
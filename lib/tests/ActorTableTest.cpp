@@ -0,0 +1,92 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/ActorTable.h"
+#include "Git/Commit.h"
+
+
+
+class ActorTableTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("CommitListingTestRepo");
+		}
+
+
+
+		void shouldBeEmptyInitially() {
+			QCOMPARE(repo->actors()->count(), 0);
+			QVERIFY(repo->actors()->m_ids.isEmpty());
+		}
+
+		void shouldInternEqualActorsOnce() {
+			Git::ActorTable *actors = repo->actors();
+
+			int me = actors->idFor("Me <me@some.tld>");
+			int you = actors->idFor("You <you@some.tld>");
+
+			QVERIFY(me != you);
+			QCOMPARE(actors->idFor(QString("Me <me@some.tld>")), me);
+			QCOMPARE(actors->count(), 2);
+			QCOMPARE(actors->nameFor(me), QString("Me <me@some.tld>"));
+			QCOMPARE(actors->nameFor(you), QString("You <you@some.tld>"));
+		}
+
+		void shouldNotInternEmptyActors() {
+			QCOMPARE(repo->actors()->idFor(QString()), -1);
+			QCOMPARE(repo->actors()->count(), 0);
+			QVERIFY(repo->actors()->nameFor(-1).isNull());
+		}
+
+		void shouldShareActorsBetweenCommits() {
+			QList<Git::Commit> commits = repo->commits("master");
+			QCOMPARE(commits.size(), 4);
+
+			int authorId = commits.first().authorId();
+			foreach (Git::Commit commit, commits) {
+				QCOMPARE(commit.authorId(), authorId);
+				QCOMPARE(commit.committerId(), authorId);
+			}
+
+			QCOMPARE(repo->actors()->count(), 1);
+			QCOMPARE(repo->actors()->nameFor(authorId), QString("Riyad Preukschas <riyad@informatik.uni-bremen.de>"));
+		}
+
+		void shouldGroupCommitsByAuthor() {
+			QList<Git::Commit> commits = repo->commits("master");
+			int authorId = commits.first().authorId();
+
+			QStringList authoredCommits = repo->actors()->commitsAuthoredBy(authorId);
+			QCOMPARE(repo->actors()->commitCountBy(authorId), 4);
+			QCOMPARE(authoredCommits.size(), 4);
+			foreach (Git::Commit commit, commits) {
+				QVERIFY(authoredCommits.contains(commit.id().toSha1String()));
+			}
+		}
+};
+
+QTEST_KDEMAIN_CORE(ActorTableTest)
+
+#include "ActorTableTest.moc"
@@ -0,0 +1,85 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/CatFileProcess.h"
+
+
+
+class CatFileProcessTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("RawObjectTestRepo");
+		}
+
+
+
+		void shouldNotStartGitBeforeFirstRead() {
+			QCOMPARE(repo->catFileProcess()->state(), QProcess::NotRunning);
+		}
+
+		void shouldReadObject() {
+			QByteArray type;
+			QByteArray data = repo->catFileProcess()->readObject("86e041dad66a19b9518b83b78865015f62662f75", &type);
+
+			QCOMPARE(type, QByteArray("blob"));
+			QCOMPARE(data, QByteArray("foo\nbar\nbaz\n"));
+			QCOMPARE(repo->catFileProcess()->state(), QProcess::Running);
+		}
+
+		void shouldReturnNullForMissingObject() {
+			QByteArray type("blob");
+			QByteArray data = repo->catFileProcess()->readObject("0123456789012345678901234567890123456789", &type);
+
+			QVERIFY(data.isNull());
+			QVERIFY(type.isEmpty());
+		}
+
+		void shouldKeepProcessRunningBetweenReads() {
+			Git::CatFileProcess *process = repo->catFileProcess();
+			process->readObject("86e041dad66a19b9518b83b78865015f62662f75");
+			Q_PID pid = process->pid();
+
+			process->readObject("5b36b1f1641c26c8bee07c40e2577be81a22c73d");
+
+			QCOMPARE(process->pid(), pid);
+			QVERIFY(process->m_buffer.isEmpty());
+		}
+
+		void shouldReadObjectsInOrder() {
+			QList<QByteArray> objects = repo->catFileProcess()->readObjects(QStringList()
+				<< "5b36b1f1641c26c8bee07c40e2577be81a22c73d"
+				<< "0123456789012345678901234567890123456789"
+				<< "86e041dad66a19b9518b83b78865015f62662f75");
+
+			QCOMPARE(objects.size(), 3);
+			QCOMPARE(objects[0].size(), 41);
+			QVERIFY(objects[1].isNull());
+			QCOMPARE(objects[2], QByteArray("foo\nbar\nbaz\n"));
+		}
+};
+
+QTEST_KDEMAIN_CORE(CatFileProcessTest)
+
+#include "CatFileProcessTest.moc"
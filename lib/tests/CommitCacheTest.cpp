@@ -0,0 +1,172 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/ActorTable.h"
+#include "Git/Commit.h"
+#include "Git/CommitCache.h"
+
+
+
+class CommitCacheTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private:
+		void reopenRepo() {
+			GitTestBase::cleanup();
+			GitTestBase::init();
+		}
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("CommitListingTestRepo");
+		}
+
+		void init() {
+			GitTestBase::init();
+			QFile::remove(repo->commitCache()->fileName());
+		}
+
+
+
+		void shouldBeEmptyInitially() {
+			QCOMPARE(repo->commitCache()->count(), 0);
+			QVERIFY(!repo->commitCache()->isDirty());
+		}
+
+		void shouldCacheLoadedCommits() {
+			foreach (Git::Commit commit, repo->commits("master")) {
+				commit.summary();
+			}
+
+			QCOMPARE(repo->commitCache()->count(), 4);
+			QVERIFY(repo->commitCache()->isDirty());
+		}
+
+		void shouldKeepCommitsAcrossSessions() {
+			QList<Git::Commit> commits = repo->commits("master");
+			foreach (Git::Commit commit, commits) {
+				commit.summary();
+			}
+			Git::Commit first = commits.first();
+			QString summary = first.summary();
+			QString message = first.message();
+			QString author = first.author();
+			KDateTime authoredAt = first.authoredAt();
+			QString parentId = first.parents().first().id().toSha1String();
+			QString treeId = first.tree().id().toSha1String();
+
+			reopenRepo();
+
+			QVERIFY(QFile::exists(repo->commitCache()->fileName()));
+			QCOMPARE(repo->commitCache()->count(), 4);
+			QVERIFY(!repo->commitCache()->isDirty());
+
+			Git::Commit cached = repo->commits("master").first();
+			QVERIFY(repo->commitCache()->m_records.contains(QByteArray::fromHex(cached.id().toSha1String().toLatin1())));
+			QCOMPARE(cached.summary(), summary);
+			QCOMPARE(cached.message(), message);
+			QCOMPARE(cached.author(), author);
+			QCOMPARE(cached.authoredAt(), authoredAt);
+			QCOMPARE(cached.parents().first().id().toSha1String(), parentId);
+			QCOMPARE(cached.tree().id().toSha1String(), treeId);
+
+			// the repo's actor table is filled from the cache
+			QCOMPARE(repo->actors()->commitCountBy(cached.authorId()), 4);
+			QVERIFY(!repo->commitCache()->isDirty());
+		}
+
+		void shouldIgnoreCacheOfOtherVersion() {
+			QDir().mkpath(QFileInfo(repo->commitCache()->fileName()).path());
+			QFile file(repo->commitCache()->fileName());
+			file.open(QFile::WriteOnly);
+			file.write("some other format");
+			file.close();
+
+			reopenRepo();
+
+			QCOMPARE(repo->commitCache()->count(), 0);
+			QCOMPARE(repo->commits("master").first().summary(), QString("Merge branch 'branch'"));
+			QCOMPARE(repo->commitCache()->count(), 4);
+		}
+
+		void shouldBeSharedByReposOfTheSameGitDir() {
+			Git::Repo other(repo->workingDir());
+
+			QCOMPARE(other.commitCache(), repo->commitCache());
+		}
+
+		void shouldAppendCommitsToFile() {
+			QList<Git::Commit> commits = repo->commits("master");
+			commits.first().summary();
+			QVERIFY(repo->commitCache()->save());
+			qint64 size = QFileInfo(repo->commitCache()->fileName()).size();
+
+			commits.last().summary();
+			QByteArray firstId = QByteArray::fromHex(commits.first().id().toSha1String().toLatin1());
+			QByteArray lastId = QByteArray::fromHex(commits.last().id().toSha1String().toLatin1());
+			QVERIFY(repo->commitCache()->isDirty());
+			QVERIFY(repo->commitCache()->save());
+			QVERIFY(!repo->commitCache()->isDirty());
+			QVERIFY(QFileInfo(repo->commitCache()->fileName()).size() > size);
+
+			reopenRepo();
+
+			QCOMPARE(repo->commitCache()->count(), 2);
+			QVERIFY(repo->commitCache()->m_records.contains(firstId));
+			QVERIFY(repo->commitCache()->m_records.contains(lastId));
+		}
+
+		void shouldPruneUnusedCommitsOfLargeFile() {
+			QList<Git::Commit> commits = repo->commits("master");
+			for (int i = 0; i < 3; ++i) {
+				commits[i].summary();
+			}
+
+			reopenRepo();
+
+			QCOMPARE(repo->commitCache()->count(), 3);
+			repo->commitCache()->m_maxFileSize = 0;
+
+			// one cached commit is used and one is added
+			commits = repo->commits("master");
+			commits[0].summary();
+			commits[3].summary();
+			QCOMPARE(repo->commitCache()->count(), 4);
+
+			QByteArray usedId = QByteArray::fromHex(commits[0].id().toSha1String().toLatin1());
+			QByteArray addedId = QByteArray::fromHex(commits[3].id().toSha1String().toLatin1());
+
+			QVERIFY(repo->commitCache()->save());
+			QCOMPARE(repo->commitCache()->count(), 2);
+
+			reopenRepo();
+
+			QCOMPARE(repo->commitCache()->count(), 2);
+			QVERIFY(repo->commitCache()->m_records.contains(usedId));
+			QVERIFY(repo->commitCache()->m_records.contains(addedId));
+		}
+};
+
+QTEST_KDEMAIN_CORE(CommitCacheTest)
+
+#include "CommitCacheTest.moc"
@@ -52,9 +52,9 @@ class CommitPopulationTest : public GitTestBase
 
 
 		void shouldNotPopulateOnConstruction() {
-			QVERIFY( commit->d->author.isNull());
+			QCOMPARE( commit->d->authorId, -1);
 			QVERIFY( commit->d->authoredAt.isNull());
-			QVERIFY( commit->d->committer.isNull());
+			QCOMPARE( commit->d->committerId, -1);
 			QVERIFY( commit->d->committedAt.isNull());
 			QVERIFY( commit->d->message.isNull());
 			QVERIFY( commit->d->parentIds.isEmpty());
@@ -65,9 +65,9 @@ class CommitPopulationTest : public GitTestBase
 		void shouldPopulateOnPropertyAccess() {
 			commit->message();
 
-			QVERIFY(!commit->d->author.isEmpty());
+			QVERIFY( commit->d->authorId != -1);
 			QVERIFY(!commit->d->authoredAt.isNull());
-			QVERIFY(!commit->d->committer.isEmpty());
+			QVERIFY( commit->d->committerId != -1);
 			QVERIFY(!commit->d->committedAt.isNull());
 			QVERIFY(!commit->d->message.isEmpty());
 			QVERIFY(!commit->d->parentIds.isEmpty());
@@ -0,0 +1,125 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/IgnoreRules.h"
+
+
+
+class IgnoreRulesTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("IgnoreRulesTestRepo");
+		}
+
+
+
+		void shouldSkipBlankLinesAndComments() {
+			QVERIFY(!Git::IgnorePattern("").isValid());
+			QVERIFY(!Git::IgnorePattern("   ").isValid());
+			QVERIFY(!Git::IgnorePattern("# comment").isValid());
+			QVERIFY(Git::IgnorePattern("\\#file").isValid());
+			QVERIFY(Git::IgnorePattern("\\#file").matches("#file", false));
+		}
+
+		void shouldMatchNamesAtAnyDepth() {
+			Git::IgnorePattern pattern("*.o");
+
+			QVERIFY(pattern.matches("main.o", false));
+			QVERIFY(pattern.matches("src/main.o", false));
+			QVERIFY(!pattern.matches("src/main.c", false));
+			QVERIFY(!pattern.matches("main.o/file", false));
+		}
+
+		void shouldMatchPathsRelativeToBaseDirectory() {
+			Git::IgnorePattern pattern("/doc/*.txt", "src/");
+
+			QVERIFY(pattern.matches("src/doc/a.txt", false));
+			QVERIFY(!pattern.matches("doc/a.txt", false));
+			QVERIFY(!pattern.matches("src/doc/more/a.txt", false));
+		}
+
+		void shouldMatchDirectoriesOnlyWithTrailingSlash() {
+			Git::IgnorePattern pattern("build/");
+
+			QVERIFY(pattern.matches("build", true));
+			QVERIFY(pattern.matches("src/build", true));
+			QVERIFY(!pattern.matches("build", false));
+		}
+
+		void shouldMatchDoubleAsterisks() {
+			QVERIFY(Git::IgnorePattern::wildcardMatch("**/foo", "foo"));
+			QVERIFY(Git::IgnorePattern::wildcardMatch("**/foo", "a/b/foo"));
+			QVERIFY(Git::IgnorePattern::wildcardMatch("a/**/b", "a/b"));
+			QVERIFY(Git::IgnorePattern::wildcardMatch("a/**/b", "a/x/y/b"));
+			QVERIFY(Git::IgnorePattern::wildcardMatch("a/**", "a/x/y"));
+			QVERIFY(!Git::IgnorePattern::wildcardMatch("a*b", "a/b"));
+			QVERIFY(Git::IgnorePattern::wildcardMatch("[a-c]x", "bx"));
+			QVERIFY(!Git::IgnorePattern::wildcardMatch("[!a-c]x", "bx"));
+		}
+
+		void shouldLetLaterPatternsWin() {
+			Git::IgnoreRules rules(*repo);
+			rules.enterDirectory("");
+
+			QVERIFY(rules.isIgnored("main.o", false));
+			QVERIFY(!rules.isIgnored("keep.o", false));
+			QVERIFY(rules.isIgnored("secret.txt", false));
+			QVERIFY(rules.isIgnored("root-only.txt", false));
+			QVERIFY(!rules.isIgnored("src/root-only.txt", false));
+		}
+
+		void shouldOnlyApplyIgnoreFilesOfEnteredDirectories() {
+			Git::IgnoreRules rules(*repo);
+			rules.enterDirectory("");
+
+			QVERIFY(!rules.isIgnored("src/a.tmp", false));
+
+			rules.enterDirectory("src/");
+			QVERIFY(rules.isIgnored("src/a.tmp", false));
+			QVERIFY(!rules.isIgnored("src/important.tmp", false));
+			QVERIFY(rules.isIgnored("src/generated", true));
+			QVERIFY(rules.isIgnored("src/main.o", false));
+
+			rules.leaveDirectory();
+			QVERIFY(!rules.isIgnored("src/a.tmp", false));
+			QVERIFY(rules.isIgnored("secret.txt", false));
+		}
+
+		void shouldListUntrackedFiles() {
+			QStringList untrackedFiles;
+			foreach (Git::StatusFile *file, repo->status()->files()) {
+				if (file->isUntracked()) {
+					untrackedFiles << file->path();
+				}
+			}
+			untrackedFiles.sort();
+
+			QCOMPARE(untrackedFiles, QStringList() << "keep.o" << "new.txt" << "src/important.tmp" << "src/root-only.txt");
+		}
+};
+
+QTEST_KDEMAIN_CORE(IgnoreRulesTest)
+
+#include "IgnoreRulesTest.moc"
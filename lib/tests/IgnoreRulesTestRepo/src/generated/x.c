@@ -0,0 +1 @@
+src/generated/x.c
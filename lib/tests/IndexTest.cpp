@@ -0,0 +1,169 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/Index.h"
+
+
+
+class IndexTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("IndexTestRepo");
+		}
+
+
+
+		void shouldReadAllEntries() {
+			Git::Index index(*repo);
+
+			QVERIFY(index.isValid());
+			QCOMPARE(index.version(), quint32(2));
+			QCOMPARE(index.entries().size(), 4);
+			QCOMPARE(index.entries()[0].path, QString("a.txt"));
+			QCOMPARE(index.entries()[1].path, QString("dir/b.txt"));
+			QCOMPARE(index.entries()[2].path, QString("dir/sub/c.txt"));
+			QCOMPARE(index.entries()[3].path, QString("run.sh"));
+		}
+
+		void shouldReadEntryData() {
+			Git::Index index(*repo);
+
+			const Git::IndexEntry &entry = index.entries()[3];
+			QCOMPARE(entry.sha1String(), QString("1a2485251c33a70432394c93fb89330ef214bfc9"));
+			QCOMPARE(entry.mode, quint32(0100755));
+			QCOMPARE(entry.modeString(), QString("100755"));
+			QCOMPARE(entry.size, quint32(10));
+			QCOMPARE(entry.stage(), 0);
+			QVERIFY(!entry.isAssumeValid());
+			QVERIFY(!entry.isIntentToAdd());
+			QVERIFY(!entry.isSkipWorktree());
+		}
+
+		void shouldFindEntries() {
+			Git::Index index(*repo);
+
+			QCOMPARE(index.indexOf("a.txt"), 0);
+			QCOMPARE(index.indexOf("dir/sub/c.txt"), 2);
+			QCOMPARE(index.indexOf("run.sh"), 3);
+			QCOMPARE(index.indexOf("dir"), -1);
+			QCOMPARE(index.indexOf("zzz"), -1);
+		}
+
+		void shouldFindFirstEntryOfDirectory() {
+			Git::Index index(*repo);
+
+			QCOMPARE(index.lowerBound("dir/"), 1);
+			QCOMPARE(index.lowerBound("dir/sub/"), 2);
+			QCOMPARE(index.lowerBound("zzz"), 4);
+		}
+
+		void shouldReadCachedTrees() {
+			Git::Index index(*repo);
+
+			QCOMPARE(index.cachedTreeId(""), QString("6ff464d1dc69a413c82a12d1d36b2307b3ac307d"));
+			QCOMPARE(index.cachedTreeEntryCount(""), 4);
+			QCOMPARE(index.cachedTreeId("dir"), QString("599511c27b74ef04c05974548e873d3ea85cc94a"));
+			QCOMPARE(index.cachedTreeEntryCount("dir"), 2);
+			QCOMPARE(index.cachedTreeId("dir/sub"), QString("aa0285fd1f07513ffb743820cf729d3fe1343e2f"));
+			QCOMPARE(index.cachedTreeEntryCount("dir/sub"), 1);
+			QVERIFY(index.cachedTreeId("a.txt").isNull());
+			QCOMPARE(index.cachedTreeEntryCount("a.txt"), -1);
+		}
+
+		void shouldBeInvalidWithoutIndexFile() {
+			Git::Index index(pathTo(".git/no_index"));
+
+			QVERIFY(!index.isValid());
+			QCOMPARE(index.version(), quint32(0));
+			QVERIFY(index.entries().isEmpty());
+		}
+
+		void shouldBeInvalidWithTooManyEntries() {
+			QByteArray header("DIRC");
+			header += QByteArray::fromHex("00000002ffffffff");
+			header += QByteArray(20, '\0');
+			writeToFile(".git/huge_index", header);
+
+			Git::Index index(pathTo(".git/huge_index"));
+
+			QVERIFY(!index.isValid());
+			QVERIFY(index.entries().isEmpty());
+		}
+
+		void shouldComparePathsByTheirBytes() {
+			QString privateUse = QString(QChar(0xe000));
+			QString emoji = QString::fromUtf8("\xf0\x9f\x98\x80");
+
+			QVERIFY(Git::Index::comparePaths("a", "b") < 0);
+			QVERIFY(Git::Index::comparePaths("a", "a/b") < 0);
+			QCOMPARE(Git::Index::comparePaths("a", "a"), 0);
+			// UTF-16 would sort the surrogates before U+E000
+			QVERIFY(Git::Index::comparePaths(privateUse, emoji) < 0);
+			QVERIFY(privateUse.toUtf8() < emoji.toUtf8());
+		}
+
+		void shouldReadPrefixCompressedPaths() {
+			QProcess::execute("git", gitBasicOpts() << "update-index" << "--index-version" << "4");
+
+			Git::Index index(*repo);
+
+			QVERIFY(index.isValid());
+			QCOMPARE(index.version(), quint32(4));
+			QCOMPARE(index.entries().size(), 4);
+			QCOMPARE(index.entries()[0].path, QString("a.txt"));
+			QCOMPARE(index.entries()[1].path, QString("dir/b.txt"));
+			QCOMPARE(index.entries()[2].path, QString("dir/sub/c.txt"));
+			QCOMPARE(index.entries()[3].path, QString("run.sh"));
+			QCOMPARE(index.entries()[2].sha1String(), QString("76018072e09c5d31c8c6e3113b8aa0fe625195ca"));
+		}
+
+		void shouldReadExtendedFlags() {
+			QProcess::execute("git", gitBasicOpts() << "update-index" << "--skip-worktree" << "a.txt");
+
+			Git::Index index(*repo);
+
+			QVERIFY(index.isValid());
+			QVERIFY(index.entries()[0].isSkipWorktree());
+			QVERIFY(!index.entries()[1].isSkipWorktree());
+			QCOMPARE(index.entries()[1].path, QString("dir/b.txt"));
+		}
+
+		void shouldInvalidateCachedTreesOfChangedDirectories() {
+			writeToFile("dir/sub/c.txt", "changed\n");
+			QProcess::execute("git", gitBasicOpts() << "add" << "dir/sub/c.txt");
+
+			Git::Index index(*repo);
+
+			QVERIFY(index.isValid());
+			QVERIFY(index.cachedTreeId("").isNull());
+			QVERIFY(index.cachedTreeId("dir").isNull());
+			QVERIFY(index.cachedTreeId("dir/sub").isNull());
+			QCOMPARE(index.cachedTreeEntryCount("dir/sub"), -1);
+		}
+};
+
+QTEST_KDEMAIN_CORE(IndexTest)
+
+#include "IndexTest.moc"
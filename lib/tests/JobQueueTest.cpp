@@ -0,0 +1,206 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/JobQueue.h"
+#include "Git/3rdparty/gitrunner.h"
+
+#include <QPointer>
+#include <QProcess>
+#include <QSignalSpy>
+
+
+
+class JobQueueTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private:
+		DvcsJob* newRevListJob() {
+			GitRunner runner;
+			runner.setDirectory(repo->workingDir());
+			runner.setAsynchronous(true);
+
+			runner.revList(QStringList() << "--all");
+
+			DvcsJob *job = runner.takeJob();
+			job->setAutoDelete(false);
+
+			return job;
+		}
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			qRegisterMetaType<DvcsJob*>("DvcsJob*");
+
+			cloneFrom("CommitListingTestRepo");
+		}
+
+
+
+		void shouldOnlyPrepareJobsInAsynchronousMode() {
+			GitRunner runner;
+			runner.setDirectory(repo->workingDir());
+			runner.setAsynchronous(true);
+
+			QCOMPARE(runner.revList(), DvcsJob::JobNotStarted);
+
+			DvcsJob *job = runner.takeJob();
+			QVERIFY(job);
+			QCOMPARE(job->status(), DvcsJob::JobNotStarted);
+			QVERIFY(!runner.takeJob());
+
+			delete job;
+		}
+
+		void shouldStreamOutput() {
+			DvcsJob *job = newRevListJob();
+			QSignalSpy outputSpy(job, SIGNAL(receivedOutput(DvcsJob*, const QByteArray&)));
+			QSignalSpy resultSpy(job, SIGNAL(result(KJob*)));
+
+			job->start();
+			QCOMPARE(job->status(), DvcsJob::JobRunning);
+			QVERIFY(job->waitForFinished());
+
+			QCOMPARE(resultSpy.count(), 1);
+			QVERIFY(outputSpy.count() > 0);
+
+			QByteArray output;
+			for (int i = 0; i < outputSpy.count(); ++i) {
+				output.append(outputSpy.at(i).at(1).toByteArray());
+			}
+			QCOMPARE(output, job->rawOutput());
+			QCOMPARE(job->status(), DvcsJob::JobSucceeded);
+
+			delete job;
+		}
+
+		void shouldBoundRunningJobs() {
+			Git::JobQueue queue;
+			queue.setMaxRunningJobs(2);
+			QSignalSpy finishedSpy(&queue, SIGNAL(finished()));
+
+			QList<DvcsJob*> jobs;
+			for (int i = 0; i < 3; ++i) {
+				jobs << newRevListJob();
+				queue.enqueue(jobs.last());
+			}
+
+			QCOMPARE(queue.runningJobs(), 2);
+			QCOMPARE(queue.queuedJobs(), 1);
+			QCOMPARE(jobs.last()->status(), DvcsJob::JobNotStarted);
+
+			queue.waitForFinished();
+
+			QVERIFY(queue.isEmpty());
+			QCOMPARE(finishedSpy.count(), 1);
+			foreach (DvcsJob *job, jobs) {
+				QCOMPARE(job->status(), DvcsJob::JobSucceeded);
+				QCOMPARE(job->output().split("\n", QString::SkipEmptyParts).size(), 4);
+			}
+
+			qDeleteAll(jobs);
+		}
+
+		void shouldCancelRunningAndQueuedJobs() {
+			Git::JobQueue queue;
+			queue.setMaxRunningJobs(1);
+			QSignalSpy finishedSpy(&queue, SIGNAL(finished()));
+
+			QList<DvcsJob*> jobs;
+			jobs << newRevListJob() << newRevListJob();
+			foreach (DvcsJob *job, jobs) {
+				queue.enqueue(job);
+			}
+			QCOMPARE(queue.runningJobs(), 1);
+
+			queue.cancel();
+
+			QVERIFY(queue.isEmpty());
+			QCOMPARE(finishedSpy.count(), 1);
+			foreach (DvcsJob *job, jobs) {
+				QCOMPARE(job->status(), DvcsJob::JobCancelled);
+				QCOMPARE(job->error(), (int)KJob::KilledJobError);
+			}
+
+			qDeleteAll(jobs);
+		}
+
+		void shouldReadOutputOfAllRunningJobs() {
+			// more than fits into a pipe, so jobs block if their output isn't read
+			QByteArray content;
+			for (int i = 0; i < 16*1024; ++i) {
+				content += QByteArray::number(i).rightJustified(15, '0') + '\n';
+			}
+			writeToFile("large.txt", content);
+			QProcess::execute("git", gitBasicOpts() << "add" << "large.txt");
+
+			Git::JobQueue queue;
+			queue.setMaxRunningJobs(4);
+
+			QList<DvcsJob*> jobs;
+			for (int i = 0; i < 4; ++i) {
+				GitRunner runner;
+				runner.setDirectory(repo->workingDir());
+				runner.setAsynchronous(true);
+				runner.catFile(":large.txt", QStringList() << "blob");
+
+				jobs << runner.takeJob();
+				jobs.last()->setAutoDelete(false);
+				queue.enqueue(jobs.last());
+			}
+			QCOMPARE(queue.runningJobs(), 4);
+
+			queue.waitForFinished();
+
+			QVERIFY(queue.isEmpty());
+			foreach (DvcsJob *job, jobs) {
+				QCOMPARE(job->status(), DvcsJob::JobSucceeded);
+				QCOMPARE(job->rawOutput().size(), content.size());
+				QVERIFY(job->rawOutput() == content);
+			}
+
+			qDeleteAll(jobs);
+		}
+
+		void shouldNotDispatchEventsWhileWaiting() {
+			Git::JobQueue queue;
+
+			DvcsJob *job = newRevListJob();
+			queue.enqueue(job);
+
+			QPointer<QObject> object = new QObject();
+			object->deleteLater();
+
+			queue.waitForFinished();
+
+			QVERIFY(queue.isEmpty());
+			QCOMPARE(job->status(), DvcsJob::JobSucceeded);
+			QVERIFY(!object.isNull());
+
+			delete object;
+			delete job;
+		}
+};
+
+QTEST_KDEMAIN_CORE(JobQueueTest)
+
+#include "JobQueueTest.moc"
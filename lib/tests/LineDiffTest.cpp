@@ -0,0 +1,141 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QObject>
+
+#include "Git/LineDiff.h"
+
+#include <qtest_kde.h>
+
+
+
+class LineDiffTest : public QObject
+{
+	Q_OBJECT
+
+	private:
+		QByteArray numberedLines(int count) {
+			QByteArray lines;
+			for (int i=1; i <= count; ++i) {
+				lines += "line " + QByteArray::number(i) + "\n";
+			}
+			return lines;
+		}
+
+	private slots:
+		void shouldFindNoChangesInEqualTexts() {
+			Git::LineDiff diff("foo\nbar\n", "foo\nbar\n");
+
+			QVERIFY(!diff.hasChanges());
+			QVERIFY(diff.unifiedDiff().isEmpty());
+		}
+
+		void shouldHashEqualLinesToTheSameNumber() {
+			Git::LineDiff diff("foo\nbar\nfoo\n", "bar\nbaz\n");
+
+			QCOMPARE(diff.m_oldLines.size(), 3);
+			QCOMPARE(diff.m_newLines.size(), 2);
+			QCOMPARE(diff.m_oldLines[0], diff.m_oldLines[2]);
+			QCOMPARE(diff.m_oldLines[1], diff.m_newLines[0]);
+			QVERIFY(diff.m_newLines[1] != diff.m_oldLines[0]);
+		}
+
+		void shouldFormatHunksLikeGit() {
+			QCOMPARE(Git::LineDiff("foo\nbar", "foo\nbar\nbaz\n").unifiedDiff(),
+				QByteArray("@@ -1,2 +1,3 @@\n foo\n-bar\n\\ No newline at end of file\n+bar\n+baz\n"));
+			QCOMPARE(Git::LineDiff("foo\nbar\nbaz\n", "").unifiedDiff(),
+				QByteArray("@@ -1,3 +0,0 @@\n-foo\n-bar\n-baz\n"));
+			QCOMPARE(Git::LineDiff("", "foo").unifiedDiff(),
+				QByteArray("@@ -0,0 +1 @@\n+foo\n\\ No newline at end of file\n"));
+		}
+
+		void shouldOnlyShowContextAroundChanges() {
+			QByteArray oldText = numberedLines(20);
+			QByteArray newText = oldText;
+			newText.replace("line 5\n", "line five\n");
+
+			QCOMPARE(Git::LineDiff(oldText, newText).unifiedDiff(),
+				QByteArray("@@ -2,7 +2,7 @@\n line 2\n line 3\n line 4\n-line 5\n+line five\n line 6\n line 7\n line 8\n"));
+		}
+
+		void shouldFormatHunksOneAtATime() {
+			QByteArray oldText = numberedLines(20);
+			QByteArray newText = oldText;
+			newText.replace("line 2\n", "line two\n");
+			newText.replace("line 18\n", "line eighteen\n");
+
+			Git::LineDiff diff(oldText, newText);
+			Git::DiffHunk hunk;
+
+			QVERIFY(diff.nextHunk(hunk));
+			QCOMPARE(hunk.oldStart, 1);
+			QCOMPARE(hunk.oldCount, 5);
+			QCOMPARE(hunk.newStart, 1);
+			QCOMPARE(hunk.newCount, 5);
+			QCOMPARE(hunk.text, QByteArray("@@ -1,5 +1,5 @@\n line 1\n-line 2\n+line two\n line 3\n line 4\n line 5\n"));
+
+			QVERIFY(diff.nextHunk(hunk));
+			QCOMPARE(hunk.oldStart, 15);
+			QCOMPARE(hunk.text, QByteArray("@@ -15,6 +15,6 @@\n line 15\n line 16\n line 17\n-line 18\n+line eighteen\n line 19\n line 20\n"));
+
+			QVERIFY(!diff.nextHunk(hunk));
+		}
+
+		void shouldMergeCloseChangesIntoOneHunk() {
+			QByteArray oldText = numberedLines(20);
+			QByteArray newText = oldText;
+			newText.replace("line 5\n", "line five\n");
+			newText.replace("line 11\n", "line eleven\n");
+
+			Git::LineDiff diff(oldText, newText);
+			Git::DiffHunk hunk;
+
+			QVERIFY(diff.nextHunk(hunk));
+			QCOMPARE(hunk.oldStart, 2);
+			QCOMPARE(hunk.oldCount, 13);
+			QVERIFY(!diff.nextHunk(hunk));
+		}
+
+		void shouldFindTheSmallestNumberOfChangesWithMyers() {
+			Git::LineDiff diff("a\nb\nc\na\nb\nb\na\n", "c\nb\na\nb\na\nc\n");
+
+			QCOMPARE(diff.m_oldChanged.count(true) + diff.m_newChanged.count(true), 5);
+		}
+
+		void shouldAlignRareLinesWithHistogram() {
+			QByteArray oldText("}\n}\nunique\n");
+			QByteArray newText("{\n{\nunique\n{\n}\n}\n");
+
+			Git::LineDiff myersDiff(oldText, newText, Git::LineDiff::Myers);
+			QVERIFY(myersDiff.m_oldChanged[2]);
+
+			Git::LineDiff histogramDiff(oldText, newText, Git::LineDiff::Histogram);
+			QVERIFY(!histogramDiff.m_oldChanged[2]);
+			QCOMPARE(histogramDiff.unifiedDiff(),
+				QByteArray("@@ -1,3 +1,6 @@\n-}\n-}\n+{\n+{\n unique\n+{\n+}\n+}\n"));
+		}
+
+		void shouldDetectBinaryData() {
+			QVERIFY(!Git::LineDiff::isBinary("foo\nbar\n"));
+			QVERIFY(Git::LineDiff::isBinary(QByteArray("foo\0bar", 7)));
+		}
+};
+
+QTEST_KDEMAIN_CORE(LineDiffTest)
+
+#include "LineDiffTest.moc"
@@ -20,6 +20,8 @@
 
 #include "Git/PackedStorage.h"
 
+#include <QBuffer>
+
 
 
 class PackedStorageNormalExtractionTest : public GitTestBase
@@ -81,6 +83,16 @@ class PackedStorageNormalExtractionTest : public GitTestBase
 			QCOMPARE(QTest::toHexRepresentation(data, 12), QTest::toHexRepresentation("tree 5b36b1f", 12));
 			QCOMPARE(data.size(), 212);
 		}
+
+		void shouldWriteNormalObject() {
+			Git::Id id = repo->idFor("b7566b7");
+
+			QBuffer buffer;
+			buffer.open(QIODevice::WriteOnly);
+			QVERIFY(storage->writeObjectDataTo(id, buffer));
+
+			QCOMPARE(buffer.data(), storage->objectDataFor(id));
+		}
 };
 
 QTEST_KDEMAIN_CORE(PackedStorageNormalExtractionTest)
@@ -0,0 +1,210 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/Commit.h"
+#include "Git/Ref.h"
+#include "Git/RefDatabase.h"
+
+#include <QSignalSpy>
+
+
+
+class RefDatabaseTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("RefDatabaseTestRepo");
+		}
+
+
+
+		void shouldReadPackedRefs() {
+			Git::RefDatabase *refs = repo->refDatabase();
+
+			QCOMPARE(refs->m_packedRefs.size(), 7);
+			QCOMPARE(refs->idFor("refs/heads/packed-branch"), QString("73dde7da9239b2933905e6591497c96dbe4acb7b"));
+			QCOMPARE(refs->idFor("refs/heads/master"), QString("89bc08ed8dece36d2aa285131565fe5800f57aee"));
+			QVERIFY(refs->contains("refs/heads/feature/nested"));
+		}
+
+		void shouldIgnorePeeledIds() {
+			QCOMPARE(repo->refDatabase()->idFor("refs/tags/annotated-tag"), QString("8b13a2b87e279aef6be59fc916188ed2acd5a967"));
+		}
+
+		void shouldPreferLooseRefs() {
+			QCOMPARE(repo->refDatabase()->idFor("refs/heads/overridden"), QString("89bc08ed8dece36d2aa285131565fe5800f57aee"));
+		}
+
+		void shouldFollowSymbolicRefs() {
+			Git::RefDatabase *refs = repo->refDatabase();
+
+			QCOMPARE(refs->idFor("refs/remotes/origin/HEAD"), QString("73dde7da9239b2933905e6591497c96dbe4acb7b"));
+			QCOMPARE(refs->idFor("HEAD"), QString("89bc08ed8dece36d2aa285131565fe5800f57aee"));
+		}
+
+		void shouldNotFindMissingRefs() {
+			Git::RefDatabase *refs = repo->refDatabase();
+
+			QVERIFY(!refs->contains("refs/heads/none"));
+			QVERIFY(!refs->contains("master"));
+			QVERIFY(!refs->contains("ORIG_HEAD"));
+			QVERIFY(refs->idFor("refs/heads/none").isNull());
+		}
+
+		void shouldListNamesWithPrefix() {
+			QStringList names;
+			names << "refs/heads/feature/nested";
+			names << "refs/heads/loose-branch";
+			names << "refs/heads/master";
+			names << "refs/heads/overridden";
+			names << "refs/heads/packed-branch";
+
+			QCOMPARE(repo->refDatabase()->names("refs/heads/"), names);
+			QCOMPARE(repo->refDatabase()->names().size(), 9);
+		}
+
+		void shouldFindFullNames_data() {
+			QTest::addColumn<QString>("name");
+			QTest::addColumn<QString>("fullName");
+
+			QTest::newRow("head")     << QString("master")            << QString("refs/heads/master");
+			QTest::newRow("nested")   << QString("feature/nested")    << QString("refs/heads/feature/nested");
+			QTest::newRow("prefixed") << QString("heads/loose-branch") << QString("refs/heads/loose-branch");
+			QTest::newRow("tag")      << QString("light-tag")         << QString("refs/tags/light-tag");
+			QTest::newRow("remote")   << QString("origin/master")     << QString("refs/remotes/origin/master");
+			QTest::newRow("origin")   << QString("origin")            << QString("refs/remotes/origin/HEAD");
+			QTest::newRow("full")     << QString("refs/heads/master") << QString("refs/heads/master");
+			QTest::newRow("none")     << QString("none")              << QString();
+		}
+
+		void shouldFindFullNames() {
+			QFETCH(QString, name);
+			QFETCH(QString, fullName);
+
+			QCOMPARE(Git::Ref::fullNameFor(name, *repo), fullName);
+		}
+
+		void shouldFindPackedHeads() {
+			QList<Git::Ref> heads = Git::Ref(*repo).allHeads();
+
+			QCOMPARE(heads.size(), 5);
+			QCOMPARE(heads[0].name(), QString("feature/nested"));
+			QCOMPARE(heads[2].name(), QString("master"));
+			QCOMPARE(heads[0].commit().id().toShortSha1String(), QLatin1String("73dde7d"));
+		}
+
+		void shouldFindCurrentHeadWhenPacked() {
+			const Git::Ref &head = repo->currentHead();
+
+			QCOMPARE(head.fullName(), QLatin1String("refs/heads/master"));
+			QCOMPARE(head.commit().id().toShortSha1String(), QLatin1String("89bc08e"));
+		}
+
+		void shouldNotSignalAnythingWithoutChanges() {
+			Git::RefDatabase refs(repo->gitDir());
+			QSignalSpy refAddedSpy(&refs, SIGNAL(refAdded(QString,QString)));
+			QSignalSpy refDeletedSpy(&refs, SIGNAL(refDeleted(QString,QString)));
+			QSignalSpy refMovedSpy(&refs, SIGNAL(refMoved(QString,QString,QString)));
+
+			refs.refresh();
+
+			QCOMPARE(refAddedSpy.size(), 0);
+			QCOMPARE(refDeletedSpy.size(), 0);
+			QCOMPARE(refMovedSpy.size(), 0);
+		}
+
+		void shouldSignalChangedRefsOnRefresh() {
+			Git::RefDatabase refs(repo->gitDir());
+			QSignalSpy refAddedSpy(&refs, SIGNAL(refAdded(QString,QString)));
+			QSignalSpy refDeletedSpy(&refs, SIGNAL(refDeleted(QString,QString)));
+			QSignalSpy refMovedSpy(&refs, SIGNAL(refMoved(QString,QString,QString)));
+
+			deleteFile(".git/refs/heads/loose-branch");
+			writeToFile(".git/refs/heads/loose-branch", "73dde7da9239b2933905e6591497c96dbe4acb7b\n");
+			writeToFile(".git/refs/heads/new-branch", "89bc08ed8dece36d2aa285131565fe5800f57aee\n");
+			// the packed ref shows through again
+			deleteFile(".git/refs/heads/overridden");
+			deleteFile(".git/refs/remotes/origin/HEAD");
+
+			refs.refresh();
+
+			QCOMPARE(refAddedSpy.size(), 1);
+			QCOMPARE(refAddedSpy[0][0].toString(), QString("refs/heads/new-branch"));
+			QCOMPARE(refAddedSpy[0][1].toString(), QString("89bc08ed8dece36d2aa285131565fe5800f57aee"));
+
+			QCOMPARE(refDeletedSpy.size(), 1);
+			QCOMPARE(refDeletedSpy[0][0].toString(), QString("refs/remotes/origin/HEAD"));
+
+			QCOMPARE(refMovedSpy.size(), 2);
+			QCOMPARE(refMovedSpy[0][0].toString(), QString("refs/heads/loose-branch"));
+			QCOMPARE(refMovedSpy[0][1].toString(), QString("89bc08ed8dece36d2aa285131565fe5800f57aee"));
+			QCOMPARE(refMovedSpy[0][2].toString(), QString("73dde7da9239b2933905e6591497c96dbe4acb7b"));
+			QCOMPARE(refMovedSpy[1][0].toString(), QString("refs/heads/overridden"));
+
+			QCOMPARE(refs.idFor("refs/heads/overridden"), QString("73dde7da9239b2933905e6591497c96dbe4acb7b"));
+		}
+
+		void shouldSignalRefsOfChangedPackedRefs() {
+			Git::RefDatabase refs(repo->gitDir());
+			QSignalSpy refDeletedSpy(&refs, SIGNAL(refDeleted(QString,QString)));
+			QSignalSpy refMovedSpy(&refs, SIGNAL(refMoved(QString,QString,QString)));
+
+			deleteFile(".git/packed-refs");
+			writeToFile(".git/packed-refs",
+				"# pack-refs with: peeled fully-peeled sorted \n"
+				"89bc08ed8dece36d2aa285131565fe5800f57aee refs/heads/master\n");
+
+			refs.refresh();
+
+			// packed-branch is gone, overridden is no longer covered by a loose ref
+			QStringList deletedRefs;
+			for (int i=0; i < refDeletedSpy.size(); ++i) {
+				deletedRefs << refDeletedSpy[i][0].toString();
+			}
+			QVERIFY(deletedRefs.contains("refs/heads/packed-branch"));
+			QVERIFY(deletedRefs.contains("refs/heads/overridden"));
+			QVERIFY(!deletedRefs.contains("refs/heads/master"));
+			QCOMPARE(refMovedSpy.size(), 0);
+		}
+
+		void shouldSortUnsortedPackedRefs() {
+			deleteFile(".git/packed-refs");
+			writeToFile(".git/packed-refs",
+				"# pack-refs with: peeled \n"
+				"89bc08ed8dece36d2aa285131565fe5800f57aee refs/tags/light-tag\n"
+				"73dde7da9239b2933905e6591497c96dbe4acb7b refs/heads/packed-branch\n"
+				"89bc08ed8dece36d2aa285131565fe5800f57aee refs/heads/master\n");
+
+			Git::RefDatabase refs(repo->gitDir());
+
+			QCOMPARE(refs.m_packedRefs.size(), 3);
+			QCOMPARE(refs.m_packedRefs[0].name, QByteArray("refs/heads/master"));
+			QCOMPARE(refs.idFor("refs/heads/packed-branch"), QString("73dde7da9239b2933905e6591497c96dbe4acb7b"));
+			QCOMPARE(refs.idFor("refs/tags/light-tag"), QString("89bc08ed8dece36d2aa285131565fe5800f57aee"));
+		}
+};
+
+QTEST_KDEMAIN_CORE(RefDatabaseTest)
+
+#include "RefDatabaseTest.moc"
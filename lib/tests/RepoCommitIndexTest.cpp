@@ -19,6 +19,8 @@
 #include "GitTestBase.h"
 
 #include "Git/Commit.h"
+#include "Git/RefDatabase.h"
+#include "Git/Repo_p.h"
 
 
 
@@ -71,6 +73,65 @@ class RepoCommitIndexTest : public GitTestBase
 
 			QCOMPARE(repo->commits()[0].message(), QLatin1String("Added some_file.txt"));
 		}
+
+		void shouldWriteObjectsGitCanRead() {
+			QDir(workingDir).mkpath("dir/sub");
+			writeToFile("dir/sub/other_file.txt", "other\n");
+			repo->stageFiles(QStringList() << pathTo("some_file.txt") << pathTo("dir/sub/other_file.txt"));
+			repo->commitIndex("Added files.\n\n\nIn subdirectories.  \n\n");
+
+			QCOMPARE(QProcess::execute("git", gitBasicOpts() << "fsck" << "--strict" << "--no-dangling"), 0);
+
+			QProcess git;
+			git.start("git", gitBasicOpts() << "log" << "-1" << "--format=%B");
+			git.waitForFinished();
+			QCOMPARE(git.readAllStandardOutput(), QByteArray("Added files.\n\nIn subdirectories.\n\n"));
+
+			git.start("git", gitBasicOpts() << "ls-tree" << "-r" << "--name-only" << "HEAD");
+			git.waitForFinished();
+			QCOMPARE(git.readAllStandardOutput(), QByteArray("dir/sub/other_file.txt\nsome_file.txt\n"));
+
+			QVERIFY(!QFile::exists(workingDir + "/.git/refs/heads/master.lock"));
+		}
+
+		void shouldKeepHistoryWhenCommitting() {
+			QList<Git::Commit> history = repo->commits();
+			QCOMPARE(history.size(), 1);
+
+			repo->stageFiles(QStringList() << pathTo("some_file.txt"));
+			repo->commitIndex("Added some file.");
+
+			QVERIFY(repo->d->commits.contains("refs/heads/master"));
+			QList<Git::Commit> commits = repo->commits();
+			QCOMPARE(commits.size(), 2);
+			QCOMPARE(commits[1].id().toSha1String(), history[0].id().toSha1String());
+			QCOMPARE(commits[0].parents().first().id().toSha1String(), history[0].id().toSha1String());
+		}
+
+		void shouldNotCommitWhileRefIsLocked() {
+			writeToFile(".git/refs/heads/master.lock", "");
+			QString head = repo->refDatabase()->idFor("refs/heads/master");
+
+			repo->stageFiles(QStringList() << pathTo("some_file.txt"));
+			repo->commitIndex("Added some file.");
+
+			QCOMPARE(repo->refDatabase()->idFor("refs/heads/master"), head);
+		}
+
+		void shouldRunHooksFromHooksPath() {
+			QDir(workingDir).mkpath("hooks");
+			writeToFile("hooks/pre-commit", "#!/bin/sh\nexit 1\n");
+			QFile::setPermissions(pathTo("hooks/pre-commit"), QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+			QProcess::execute("git", gitBasicOpts() << "config" << "core.hooksPath" << "hooks");
+			QString head = repo->refDatabase()->idFor("refs/heads/master");
+
+			repo->stageFiles(QStringList() << pathTo("some_file.txt"));
+			repo->commitIndex("Added some file.");
+
+			// the hook refuses the commit
+			QCOMPARE(repo->refDatabase()->idFor("refs/heads/master"), head);
+			QCOMPARE(repo->commits().size(), 1);
+		}
 };
 
 QTEST_KDEMAIN_CORE(RepoCommitIndexTest)
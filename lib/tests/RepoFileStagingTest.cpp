@@ -20,6 +20,8 @@
 
 #include "Git/Status.h"
 
+#include <QSignalSpy>
+
 
 
 class RepoFileStagingTest : public GitTestBase
@@ -117,6 +119,74 @@ class RepoFileStagingTest : public GitTestBase
 			QCOMPARE(status->stagedFiles()[1]->path(), QLatin1String("file2.txt"));
 		}
 
+		void shouldUpdateExistingStatusWhenStaging() {
+			qRegisterMetaType<Git::StatusFile*>();
+			Git::Status *status = repo->status();
+			QCOMPARE(status->unstagedFiles().size(), 4);
+			int fileCount = status->files().size();
+
+			QSignalSpy statusUpdatedSpy(repo, SIGNAL(statusUpdated()));
+			QSignalSpy indexChangedSpy(repo, SIGNAL(indexChanged()));
+			QSignalSpy fileChangedSpy(status, SIGNAL(fileChanged(Git::StatusFile*)));
+			QSignalSpy fileAddedSpy(status, SIGNAL(fileAdded(Git::StatusFile*)));
+			QSignalSpy fileRemovedSpy(status, SIGNAL(fileAboutToBeRemoved(Git::StatusFile*)));
+			Git::StatusFile *file = status->forFile("file2.txt").first();
+
+			repo->stageFiles(QStringList() << "file2.txt");
+
+			QCOMPARE(repo->status(), status);
+			QCOMPARE(statusUpdatedSpy.size(), 1);
+			QCOMPARE(indexChangedSpy.size(), 0);
+			QCOMPARE(fileChangedSpy.size(), 1);
+			QCOMPARE(fileChangedSpy.first().first().value<Git::StatusFile*>(), file);
+			QCOMPARE(fileAddedSpy.size(), 0);
+			QCOMPARE(fileRemovedSpy.size(), 0);
+
+			QCOMPARE(status->files().size(), fileCount);
+			QCOMPARE(status->stagedFiles().size(), 1);
+			QCOMPARE(status->stagedFiles()[0], file);
+			QVERIFY(file->isAdded());
+			QCOMPARE(status->unstagedFiles().size(), 3);
+		}
+
+		void shouldReadBlobsWrittenByStaging() {
+			Git::Status *status = repo->status();
+			repo->storages(); // the loose objects are listed before staging
+
+			repo->stageFiles(QStringList() << "file2.txt");
+
+			Git::StatusFile *file = status->forFile("file2.txt").first();
+			QVERIFY(!file->blob("index").isEmpty());
+			QCOMPARE(file->blob("index"), file->blob("file"));
+		}
+
+		void shouldUpdateExistingStatusWhenStagingDirectory() {
+			Git::Status *status = repo->status();
+
+			repo->stageFiles(QStringList() << "some_dir");
+
+			QCOMPARE(repo->status(), status);
+			QCOMPARE(status->stagedFiles().size(), 2);
+			QCOMPARE(status->forFile("some_dir/file3.txt").size(), 1);
+			QVERIFY(status->forFile("some_dir/file3.txt").first()->changesStaged());
+			QVERIFY(status->forFile("some_dir/file4.txt").first()->changesStaged());
+			QVERIFY(!status->forFile("some_dir/commited_file2.txt").first()->hasChanged());
+		}
+
+		void shouldUpdateExistingStatusWhenUnstaging() {
+			repo->stageFiles(QStringList() << "file1.txt" << "file2.txt" << "some_dir");
+			Git::Status *status = repo->status();
+			QCOMPARE(status->stagedFiles().size(), 4);
+
+			repo->unstageFiles(QStringList() << "some_dir" << "file2.txt");
+
+			QCOMPARE(repo->status(), status);
+			QCOMPARE(status->stagedFiles().size(), 1);
+			QCOMPARE(status->stagedFiles()[0]->path(), QLatin1String("file1.txt"));
+			QCOMPARE(status->filesByStatus(Git::StatusFile::Untracked).size(), 3);
+			QVERIFY(status->forFile("file2.txt").first()->isUntracked());
+		}
+
 		void shouldNotUnstageInEmptyIndex() {
 			repo->unstageFiles(QStringList() << "some_dir");
 			Git::Status *status = repo->status();
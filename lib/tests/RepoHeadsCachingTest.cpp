@@ -20,6 +20,8 @@
 
 #include "Git/Repo_p.h"
 
+#include <QSignalSpy>
+
 
 
 class RepoHeadsCachingTest : public GitTestBase
@@ -65,8 +67,49 @@ class RepoHeadsCachingTest : public GitTestBase
 			repo->heads();
 			QVERIFY(!repo->d->refs.isEmpty());
 
+			// unchanged refs stay cached
 			repo->reset();
-			QVERIFY(repo->d->refs.isEmpty());
+			QVERIFY(repo->d->refs.contains("refs/heads/master"));
+		}
+
+		void shouldUpdateHeadsOnRefresh() {
+			QCOMPARE(repo->heads().size(), 1);
+			QSignalSpy refAddedSpy(repo, SIGNAL(refAdded(QString,QString)));
+			QSignalSpy refDeletedSpy(repo, SIGNAL(refDeleted(QString,QString)));
+
+			writeToFile(".git/refs/heads/other", "4e197dd07d00665e2c5f96a03bf21873a4692278\n");
+			repo->refreshRefs();
+
+			QCOMPARE(refAddedSpy.size(), 1);
+			QCOMPARE(refAddedSpy[0][0].toString(), QString("refs/heads/other"));
+			QCOMPARE(repo->heads().size(), 2);
+
+			deleteFile(".git/refs/heads/other");
+			repo->refreshRefs();
+
+			QCOMPARE(refDeletedSpy.size(), 1);
+			QCOMPARE(refDeletedSpy[0][0].toString(), QString("refs/heads/other"));
+			QCOMPARE(repo->heads().size(), 1);
+		}
+
+		void shouldForgetMovedRefsOnRefresh() {
+			repo->heads();
+			QVERIFY(repo->d->refs.contains("refs/heads/master"));
+			QSignalSpy refMovedSpy(repo, SIGNAL(refMoved(QString,QString,QString)));
+
+			deleteFile(".git/refs/heads/master");
+			writeToFile(".git/refs/heads/master", "0123456789012345678901234567890123456789\n");
+			repo->refreshRefs();
+
+			// HEAD points to master, so it has moved, too
+			QCOMPARE(refMovedSpy.size(), 2);
+			QCOMPARE(refMovedSpy[0][0].toString(), QString("HEAD"));
+			QCOMPARE(refMovedSpy[1][0].toString(), QString("refs/heads/master"));
+			QCOMPARE(refMovedSpy[1][2].toString(), QString("0123456789012345678901234567890123456789"));
+			QVERIFY(!repo->d->refs.contains("refs/heads/master"));
+
+			deleteFile(".git/refs/heads/master");
+			writeToFile(".git/refs/heads/master", "4e197dd07d00665e2c5f96a03bf21873a4692278\n");
 		}
 };
 
@@ -68,6 +68,27 @@ class RepoStatusCachingTest : public GitTestBase
 			repo->reset();
 			QVERIFY(repo->d->status == 0);
 		}
+
+		void testSetStatus() {
+			QVERIFY(repo->d->status == 0);
+
+			Git::Status *status;
+			{
+				Git::Repo otherRepo(repo->workingDir());
+				status = otherRepo.status();
+				status->setParent(0);
+			}
+
+			repo->setStatus(status);
+			QVERIFY(repo->d->status == status);
+			QVERIFY(repo->status() == status);
+			QVERIFY(status->parent() == repo);
+
+			QCOMPARE(status->files().size(), 1);
+			foreach (Git::StatusFile *file, status->files()) {
+				QVERIFY(file->parent() == status);
+			}
+		}
 };
 
 QTEST_KDEMAIN_CORE(RepoStatusCachingTest)
@@ -0,0 +1,149 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/Commit.h"
+#include "Git/Ref.h"
+#include "Git/RevisionWalker.h"
+
+
+
+class RevisionWalkerTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private:
+		/**
+		 * Writes a commit with "git commit-tree" dated to the same second
+		 * as all others written by it.
+		 */
+		QString commitTree(const QStringList &arguments) {
+			QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+			env.insert("GIT_AUTHOR_NAME", "Me");
+			env.insert("GIT_AUTHOR_EMAIL", "me@some.tld");
+			env.insert("GIT_AUTHOR_DATE", "1267549200 +0000");
+			env.insert("GIT_COMMITTER_NAME", "Me");
+			env.insert("GIT_COMMITTER_EMAIL", "me@some.tld");
+			env.insert("GIT_COMMITTER_DATE", "1267549200 +0000");
+
+			QProcess git;
+			git.setProcessEnvironment(env);
+			git.start("git", gitBasicOpts() << "commit-tree" << arguments);
+			git.waitForFinished();
+
+			return QString::fromLatin1(git.readAllStandardOutput().trimmed());
+		}
+
+		QStringList idsOf(const QList<Git::Commit> &commits) {
+			QStringList ids;
+			foreach (const Git::Commit &commit, commits) {
+				ids << commit.id().toSha1String();
+			}
+
+			return ids;
+		}
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("CommitListingTestRepo");
+		}
+
+
+
+		void shouldStartWithTheRefCommit() {
+			Git::RevisionWalker walker(repo->currentHead());
+
+			QVERIFY(!walker.atEnd());
+			QCOMPARE(walker.count(), 0);
+			QCOMPARE(walker.next(), repo->currentHead().commit());
+			QCOMPARE(walker.count(), 1);
+		}
+
+		void shouldOnlyKeepTheFringe() {
+			Git::RevisionWalker walker(repo->currentHead());
+			QCOMPARE(walker.m_fringe.size(), 1);
+
+			// the merge commit has two parents
+			walker.next();
+			QCOMPARE(walker.m_fringe.size(), 2);
+			QCOMPARE(walker.m_seen.size(), 3);
+
+			// the parents share the inital commit
+			walker.next();
+			walker.next();
+			QCOMPARE(walker.m_fringe.size(), 1);
+			QCOMPARE(walker.m_seen.size(), 4);
+		}
+
+		void shouldProduceCommitsInPages() {
+			Git::RevisionWalker walker(Git::Ref::head("master", *repo));
+
+			QCOMPARE(walker.next(3).size(), 3);
+			QVERIFY(!walker.atEnd());
+
+			QCOMPARE(walker.next(3).size(), 1);
+			QVERIFY(walker.atEnd());
+			QCOMPARE(walker.count(), 4);
+
+			QVERIFY(walker.next(3).isEmpty());
+			QVERIFY(!walker.next().isValid());
+		}
+
+		void shouldWalkLikeGitRevList() {
+			// git rev-list --date-order master
+			QStringList expectedIds;
+			expectedIds << "b462958a492e9abaaa3bd2725639932b5fd551d9";
+			expectedIds << "abffc0ae9ba476fe1e9a30fa2c8903113dbadb3d";
+			expectedIds << "6421f09a627d8ea6a85a9155e481cae7ed483b50";
+			expectedIds << "4262f0d5b0d062a0d655f16c2fc372c92689c853";
+
+			Git::RevisionWalker walker(Git::Ref::head("master", *repo));
+
+			QCOMPARE(idsOf(walker.next(10)), expectedIds);
+		}
+
+		void shouldWalkCommitsWithEqualDatesLikeGitRevList() {
+			QString branchCommitId = "6421f09a627d8ea6a85a9155e481cae7ed483b50";
+			QString treeId = "4b825dc642cb6eb9a060e54bf8d69288fbee4904";
+			QString firstId = commitTree(QStringList() << treeId << "-p" << branchCommitId << "-m" << "Same date one.");
+			QString secondId = commitTree(QStringList() << treeId << "-p" << branchCommitId << "-m" << "Same date two.");
+			QString mergeId = commitTree(QStringList() << treeId << "-p" << firstId << "-p" << secondId << "-m" << "Same date merge.");
+			QProcess::execute("git", gitBasicOpts() << "update-ref" << "refs/heads/same_date" << mergeId);
+
+			// git rev-list --date-order same_date
+			QStringList expectedIds;
+			expectedIds << "8322936b1989e7b5fc691954f281675d8176ab7c";
+			expectedIds << "5cc6906f1191c0ff5bcccf1005375879dd94cb64";
+			expectedIds << "d9ec43a74d79a615ccb593d010d80cb3c40356db";
+			expectedIds << "6421f09a627d8ea6a85a9155e481cae7ed483b50";
+			expectedIds << "4262f0d5b0d062a0d655f16c2fc372c92689c853";
+			QCOMPARE(mergeId, expectedIds.first());
+
+			Git::Repo sameDateRepo(workingDir);
+			Git::RevisionWalker walker(Git::Ref::head("same_date", sameDateRepo));
+
+			QCOMPARE(idsOf(walker.next(10)), expectedIds);
+		}
+};
+
+QTEST_KDEMAIN_CORE(RevisionWalkerTest)
+
+#include "RevisionWalkerTest.moc"
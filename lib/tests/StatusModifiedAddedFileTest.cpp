@@ -18,6 +18,8 @@
 
 #include "GitTestBase.h"
 
+#include <QBuffer>
+
 
 
 class StatusModifiedAddedFileTest : public GitTestBase
@@ -48,6 +50,7 @@ class StatusModifiedAddedFileTest : public GitTestBase
 		void testRemodifiedFileIsStagedAndUnstaged();
 		void testUnstagedRemodifiedFileBlobsAreCorrect();
 		void testStagedRemodifiedFileBlobsAreCorrect();
+		void testUnstagedRemodifiedFileBlobsCanBeWritten();
 		void testUnstagedRemodifiedFileDiffIsCorrect();
 		void testStagedRemodifiedFileDiffIsCorrect();
 
@@ -176,6 +179,21 @@ void StatusModifiedAddedFileTest::testStagedRemodifiedFileBlobsAreCorrect()
 	QVERIFY(file->blob("repo").isNull());
 }
 
+void StatusModifiedAddedFileTest::testUnstagedRemodifiedFileBlobsCanBeWritten()
+{
+	Git::StatusFile *file = status->unstagedFiles()[0];
+
+	QBuffer fileBuffer;
+	fileBuffer.open(QIODevice::WriteOnly);
+	QVERIFY(file->writeBlobTo(fileBuffer, "file"));
+	QCOMPARE(fileBuffer.data(), QByteArray("foo\nbar\n", 8));
+
+	QBuffer indexBuffer;
+	indexBuffer.open(QIODevice::WriteOnly);
+	QVERIFY(file->writeBlobTo(indexBuffer, "index"));
+	QCOMPARE(indexBuffer.data(), QByteArray("foo", 3));
+}
+
 void StatusModifiedAddedFileTest::testUnstagedRemodifiedFileDiffIsCorrect()
 {
 	Git::StatusFile *file = status->unstagedFiles()[0];
@@ -41,6 +41,7 @@ class StatusNewFileTest : public GitTestBase
 		void testNewFile_diffFiles();
 		void testNewFile_diffIndex();
 		void testNewFile_diffUntrackedFiles();
+		void testNewFile_diffUntrackedFilesUsingGit();
 		void testNewFile_diffIgnoredFiles();
 
 		void testNewFileHasStatus();
@@ -99,6 +100,23 @@ void StatusNewFileTest::testNewFile_diffUntrackedFiles()
 	QCOMPARE(file->status(), Git::StatusFile::Untracked);
 }
 
+void StatusNewFileTest::testNewFile_diffUntrackedFilesUsingGit()
+{
+	// Git would quote this name without -z
+	QString specialName = QString::fromUtf8("sp\xc3\xa9cial\t\"name\".txt");
+	writeToFile(specialName, "foo\n");
+
+	QList<Git::StatusFile*> files = status->untrackedFilesUsingGit();
+	deleteFile(specialName);
+
+	QCOMPARE(files.size(), 2);
+	QCOMPARE(files[0]->path(), specialName);
+	QCOMPARE(files[0]->status(), Git::StatusFile::Untracked);
+	QCOMPARE(files[1]->path(), QString("untracked.txt"));
+
+	qDeleteAll(files);
+}
+
 void StatusNewFileTest::testNewFile_diffIgnoredFiles()
 {
 	QVERIFY(status->ignoredFiles().isEmpty());
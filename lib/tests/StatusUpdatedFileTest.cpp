@@ -39,6 +39,8 @@ class StatusUpdatedFileTest : public GitTestBase
 
 		void testUpdatedFile_lsFiles();
 		void testUpdatedFile_diffFiles();
+		void testUpdatedFile_diffFilesWithoutFileMode();
+		void testUpdatedFile_diffFilesWithAutoCrLf();
 		void testUpdatedFile_diffIndex();
 		void testUpdatedFile_diffUntrackedFiles();
 		void testUpdatedFile_diffIgnoredFiles();
@@ -103,6 +105,39 @@ void StatusUpdatedFileTest::testUpdatedFile_diffFiles()
 	QVERIFY(status->diffFiles().isEmpty());
 }
 
+void StatusUpdatedFileTest::testUpdatedFile_diffFilesWithoutFileMode()
+{
+	QProcess::execute("git", gitBasicOpts() << "config" << "core.fileMode" << "false");
+	QProcess::execute("chmod", QStringList() << "+x" << pathTo("updated.txt"));
+
+	QVERIFY(status->diffFiles().isEmpty());
+
+	QProcess::execute("git", gitBasicOpts() << "config" << "core.fileMode" << "true");
+
+	QCOMPARE(status->diffFiles().size(), 1);
+	QCOMPARE(status->diffFiles()[0]->status(), Git::StatusFile::Modified);
+
+	QProcess::execute("chmod", QStringList() << "-x" << pathTo("updated.txt"));
+}
+
+void StatusUpdatedFileTest::testUpdatedFile_diffFilesWithAutoCrLf()
+{
+	QProcess::execute("git", gitBasicOpts() << "config" << "core.autocrlf" << "true");
+	writeToFile("updated.txt", "foo\r\nbar\r\nbaz\r\n");
+
+	QVERIFY(status->diffFiles().isEmpty());
+
+	writeToFile("updated.txt", "foo\r\nbar\r\nqux\r\n");
+
+	QCOMPARE(status->diffFiles().size(), 1);
+	QCOMPARE(status->diffFiles()[0]->status(), Git::StatusFile::Modified);
+
+	QProcess::execute("git", gitBasicOpts() << "config" << "core.autocrlf" << "false");
+	deleteFile("updated.txt");
+	writeToFile("updated.txt", "foo\nbar\nbaz\n");
+	QProcess::execute("git", gitBasicOpts() << "add" << "updated.txt");
+}
+
 void StatusUpdatedFileTest::testUpdatedFile_diffIndex()
 {
 	QVERIFY(status->diffIndex("HEAD").size() == 1);
@@ -0,0 +1,137 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/TreeDiff.h"
+
+
+
+#define OldTreeId  "fdcc20331643634239e14f4d3aea740bc8c79c6d"
+#define NewTreeId  "b9d0e21b1fbbfcec3a59bb75f7983351313c500d"
+
+
+
+class TreeDiffRenameDetectionTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private:
+		QStringList changesIn(const Git::TreeDiff &diff) {
+			QStringList changes;
+			foreach (const Git::TreeChange &change, diff.changes()) {
+				switch (change.type()) {
+				case Git::TreeChange::Added:
+					changes << "A " + change.path;
+					break;
+				case Git::TreeChange::Deleted:
+					changes << "D " + change.path;
+					break;
+				case Git::TreeChange::Modified:
+					changes << "M " + change.path;
+					break;
+				case Git::TreeChange::Renamed:
+					changes << QString("R%1 %2 %3").arg(change.similarity).arg(change.oldPath).arg(change.path);
+					break;
+				case Git::TreeChange::Copied:
+					changes << QString("C%1 %2 %3").arg(change.similarity).arg(change.oldPath).arg(change.path);
+					break;
+				}
+			}
+			return changes;
+		}
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("TreeDiffRenameDetectionTestRepo");
+		}
+
+
+
+		void shouldNotDetectRenamesByDefault() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+
+			QCOMPARE(changesIn(diff), QStringList()
+				<< "A README" << "D big" << "D docs/readme" << "M lib.c" << "A lib_copy.c"
+				<< "A moved/big" << "D removed" << "A unrelated");
+		}
+
+		void shouldDetectRenamesLikeGit() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+			diff.detectRenames();
+
+			// like "git diff -M --name-status"
+			QCOMPARE(changesIn(diff), QStringList()
+				<< "R100 docs/readme README" << "M lib.c" << "A lib_copy.c"
+				<< "R95 big moved/big" << "D removed" << "A unrelated");
+		}
+
+		void shouldDetectCopiesLikeGit() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+			diff.detectRenames(true);
+
+			// like "git diff -C --name-status"
+			QCOMPARE(changesIn(diff), QStringList()
+				<< "R100 docs/readme README" << "M lib.c" << "C93 lib.c lib_copy.c"
+				<< "R95 big moved/big" << "D removed" << "A unrelated");
+		}
+
+		void shouldKeepBothIdsOfRenamedFiles() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+			diff.detectRenames();
+
+			const Git::TreeChange &change = diff.changes()[3];
+			QCOMPARE(change.oldId, QString("669c9d7d72a048725237ecf9ffe09aa84c23edd2"));
+			QCOMPARE(change.newId, QString("e673fdff1869588aa5a9f33ea7178833d610baa4"));
+		}
+
+		void shouldRespectTheMinimumSimilarity() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+			diff.detectRenames(true, 94);
+
+			QStringList changes = changesIn(diff);
+			QVERIFY(changes.contains("R95 big moved/big"));
+			QVERIFY(changes.contains("A lib_copy.c"));
+		}
+
+		void shouldFormatRenamesLikeGit() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+			diff.detectRenames();
+
+			QCOMPARE(diff.diffFor(diff.changes()[0]),
+				QString("diff --git a/docs/readme b/README\nsimilarity index 100%\nrename from docs/readme\nrename to README\n"));
+			QCOMPARE(diff.diffFor(diff.changes()[3]),
+				QString("diff --git a/big b/moved/big\nsimilarity index 95%\nrename from big\nrename to moved/big\nindex 669c9d7..e673fdf 100644\n"
+					"--- a/big\n+++ b/moved/big\n@@ -1,6 +1,6 @@\n line number 1\n line number 2\n-line number 3\n+changed 3\n line number 4\n line number 5\n line number 6\n"));
+		}
+
+		void shouldFormatCopiesLikeGit() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+			diff.detectRenames(true);
+
+			QVERIFY(diff.diffFor(diff.changes()[2]).startsWith(
+				"diff --git a/lib.c b/lib_copy.c\nsimilarity index 93%\ncopy from lib.c\ncopy to lib_copy.c\nindex 3302ab4..150bc60 100644\n"
+				"--- a/lib.c\n+++ b/lib_copy.c\n@@ -1,4 +1,4 @@\n-int function1() { return 1; }\n+int first() { return 1; }\n"));
+		}
+};
+
+QTEST_KDEMAIN_CORE(TreeDiffRenameDetectionTest)
+
+#include "TreeDiffRenameDetectionTest.moc"
@@ -0,0 +1,16 @@
+int function1() { return 1; }
+int function2() { return 2; }
+int function3() { return 3; }
+int function4() { return 4; }
+int function5() { return 5; }
+int function6() { return 6; }
+int function7() { return 7; }
+int function8() { return 8; }
+int function9() { return 9; }
+int function10() { return 10; }
+int function11() { return 11; }
+int function12() { return 12; }
+int function13() { return 13; }
+int function14() { return 14; }
+int function15() { return 15; }
+int function16() { return 0; }
@@ -0,0 +1,182 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/Commit.h"
+#include "Git/TreeDiff.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+
+
+#define OldTreeId  "fe5823e3eeb40072a109d6a666deceb064eac07f"
+#define NewTreeId  "232b7c6bd6c1306976dbadb2339dff8805a2cdab"
+
+
+
+class TreeDiffTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private:
+		const Git::TreeChange* changeFor(const Git::TreeDiff &diff, const QString &path) {
+			for (int i=0; i < diff.changes().size(); ++i) {
+				if (diff.changes()[i].path == path) {
+					return &diff.changes()[i];
+				}
+			}
+
+			return 0;
+		}
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("TreeDiffTestRepo");
+		}
+
+
+
+		void shouldFindNoChangesInEqualTrees() {
+			Git::TreeDiff diff(*repo, OldTreeId, OldTreeId);
+
+			QVERIFY(diff.changes().isEmpty());
+			QVERIFY(diff.unifiedDiff().isEmpty());
+		}
+
+		void shouldListChangedFilesInGitOrder() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+
+			QStringList paths;
+			foreach (const Git::TreeChange &change, diff.changes()) {
+				paths << change.path;
+			}
+
+			QCOMPARE(paths, QStringList() << "dir0/new" << "empty" << "file1" << "file2" << "script" << "thing" << "thing/inner");
+		}
+
+		void shouldTellTheTypesOfChanges() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+
+			QCOMPARE(changeFor(diff, "dir0/new")->type(), Git::TreeChange::Added);
+			QCOMPARE(changeFor(diff, "file1")->type(), Git::TreeChange::Modified);
+			QCOMPARE(changeFor(diff, "file2")->type(), Git::TreeChange::Deleted);
+
+			const Git::TreeChange *script = changeFor(diff, "script");
+			QCOMPARE(script->type(), Git::TreeChange::Modified);
+			QCOMPARE(script->oldMode, quint32(0100644));
+			QCOMPARE(script->newMode, quint32(0100755));
+			QCOMPARE(script->oldId, script->newId);
+		}
+
+		void shouldNotListUnchangedFiles() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+
+			QVERIFY(!changeFor(diff, "dir0/file0"));
+			QVERIFY(!changeFor(diff, "dir1/same"));
+		}
+
+		void shouldListAllFilesWhenComparingWithAnEmptyTree() {
+			Git::TreeDiff diff(*repo, QString(), OldTreeId);
+
+			QCOMPARE(diff.changes().size(), 6);
+			foreach (const Git::TreeChange &change, diff.changes()) {
+				QCOMPARE(change.type(), Git::TreeChange::Added);
+			}
+			QCOMPARE(diff.changes().first().path, QString("dir0/file0"));
+			QCOMPARE(diff.changes().first().newId, QString("257cc5642cb1a054f08cc83f2d943e56fd3ebe99"));
+		}
+
+		void shouldFormatFileDiffsLikeGit() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+
+			QCOMPARE(diff.diffFor(*changeFor(diff, "dir0/new")),
+				QString("diff --git a/dir0/new b/dir0/new\nnew file mode 100644\nindex 0000000..3e75765\n--- /dev/null\n+++ b/dir0/new\n@@ -0,0 +1 @@\n+new\n"));
+			QCOMPARE(diff.diffFor(*changeFor(diff, "empty")),
+				QString("diff --git a/empty b/empty\nnew file mode 100644\nindex 0000000..e69de29\n"));
+			QCOMPARE(diff.diffFor(*changeFor(diff, "file2")),
+				QString("diff --git a/file2 b/file2\ndeleted file mode 100644\nindex e2994c5..0000000\n--- a/file2\n+++ /dev/null\n@@ -1,2 +0,0 @@\n-bar\n-baz\n"));
+			QCOMPARE(diff.diffFor(*changeFor(diff, "script")),
+				QString("diff --git a/script b/script\nold mode 100644\nnew mode 100755\n"));
+		}
+
+		void shouldFormatModifiedFilesWithTheirMode() {
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+
+			QString fileDiff = diff.diffFor(*changeFor(diff, "file1"));
+
+			QVERIFY(fileDiff.startsWith("diff --git a/file1 b/file1\nindex fa2da6e..8476ff2 100644\n--- a/file1\n+++ b/file1\n@@ -2,7 +2,7 @@"));
+			QVERIFY(fileDiff.endsWith(" line 4\n-line 5\n+line five\n line 6\n line 7\n line 8\n"));
+		}
+
+		void shouldShowFullIdsInCommitDiffs() {
+			Git::Commit commit = repo->commits("master").first();
+
+			QString diff = commit.diff();
+
+			QVERIFY(diff.startsWith("diff --git a/dir0/new b/dir0/new\n"));
+			QVERIFY(diff.contains("diff --git a/thing b/thing\ndeleted file mode 100644\nindex 27ee7381f2b2bfaa33dc9aa425d38905080d1cd2..0000000000000000000000000000000000000000\n"));
+			QVERIFY(diff.contains("diff --git a/thing/inner b/thing/inner\nnew file mode 100644\nindex 0000000000000000000000000000000000000000..f05648e753bc95da97c2b753903c1111061d67af\n"));
+		}
+
+		void shouldCompareTheFirstCommitWithAnEmptyTree() {
+			Git::Commit commit = repo->commits("master").last();
+
+			QVERIFY(commit.parents().isEmpty());
+			QCOMPARE(commit.diff().count("new file mode"), 6);
+		}
+
+		void shouldReadObjectsFromAlternates() {
+			QString alternateDir = workingDir + "_alternate";
+			QProcess::execute("git", QStringList() << "init" << "-q" << "--bare" << alternateDir);
+
+			writeToFile("alternate", "only in the alternate\n");
+			QProcess hashObject;
+			hashObject.start("git", QStringList() << "--git-dir=" + alternateDir << "hash-object" << "-w" << pathTo("alternate"));
+			hashObject.waitForFinished();
+			QString alternateId = QString::fromLatin1(hashObject.readAllStandardOutput().trimmed());
+			deleteFile("alternate");
+
+			QFile alternates(repo->gitDir() + "/objects/info/alternates");
+			QDir().mkpath(QFileInfo(alternates).path());
+			alternates.open(QFile::WriteOnly);
+			alternates.write(QFile::encodeName(alternateDir) + "/objects\n");
+			alternates.close();
+
+			Git::TreeDiff diff(*repo, OldTreeId, NewTreeId);
+			QString nativeId = "f05648e753bc95da97c2b753903c1111061d67af";
+
+			QCOMPARE(diff.objectDataFor(alternateId), QByteArray("only in the alternate\n"));
+
+			QList<QByteArray> data = diff.objectDataFor(QStringList() << alternateId << nativeId);
+			QCOMPARE(data.size(), 2);
+			QCOMPARE(data[0], QByteArray("only in the alternate\n"));
+			QCOMPARE(data[1], diff.objectDataFor(nativeId));
+
+			alternates.remove();
+			QProcess::execute("rm", QStringList() << "-rf" << alternateDir);
+		}
+};
+
+QTEST_KDEMAIN_CORE(TreeDiffTest)
+
+#include "TreeDiffTest.moc"
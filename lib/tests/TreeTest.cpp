@@ -19,6 +19,7 @@
 #include "GitTestBase.h"
 
 #include "Git/Blob.h"
+#include "Git/Commit.h"
 #include "Git/Tree.h"
 #include "Git/Tree_p.h"
 #include "Git/RawObject.h"
@@ -80,8 +81,7 @@ class TreeTest : public GitTestBase
 			Git::Tree *tree = (Git::Tree*)Git::RawObject::newInstance(id);
 
 			QVERIFY( tree->d->entries.isEmpty());
-			QVERIFY( tree->d->entryModes.isEmpty());
-			QVERIFY( tree->d->entryNames.isEmpty());
+			QVERIFY(!tree->d->isLoaded);
 		}
 
 		void shouldPopulateOnPropertyAccess() {
@@ -90,8 +90,7 @@ class TreeTest : public GitTestBase
 			tree->entries();
 
 			QVERIFY(!tree->d->entries.isEmpty());
-			QVERIFY(!tree->d->entryModes.isEmpty());
-			QVERIFY(!tree->d->entryNames.isEmpty());
+			QVERIFY( tree->d->isLoaded);
 		}
 
 		void shouldHaveCorrectNumberOfEntries() {
@@ -114,6 +113,28 @@ class TreeTest : public GitTestBase
 			}
 		}
 
+		void shouldHaveCorrectRawEntries() {
+			Git::Tree tree = repo->tree(repo->idFor("273b4fb"));
+			const QVector<Git::TreeEntry> &entries = tree.rawEntries();
+
+			QCOMPARE(entries.size(), 3);
+
+			QCOMPARE(entries[0].name, QString("dir0"));
+			QCOMPARE(entries[0].mode, (quint32)0040000);
+			QCOMPARE(entries[0].sha1String(), QString("5b51924c72272342a7490dd267ed022e90174480"));
+			QVERIFY( entries[0].isTree());
+			QVERIFY(!entries[0].isBlob());
+
+			QCOMPARE(entries[1].name, QString("file1"));
+			QCOMPARE(entries[1].mode, (quint32)0100644);
+			QCOMPARE(entries[1].sha1String(), QString("a907ec3f431eeb6b1c75799a7e4ba73ca6dc627a"));
+			QVERIFY( entries[1].isBlob());
+			QVERIFY(!entries[1].isTree());
+
+			QCOMPARE(entries[2].name, QString("file2"));
+			QCOMPARE(entries[2].sha1String(), QString("eb697c0d58b8e5fce1855b606a665c4a2ad3a1c7"));
+		}
+
 		void shouldHaveCorrectEntryNames_data() {
 			QTest::addColumn<QString>("entryName");
 			QTest::addColumn<QString>("entryId");
@@ -134,6 +155,85 @@ class TreeTest : public GitTestBase
 			QVERIFY(!entries["none_existent"].isValid());
 		}
 
+		void shouldFindEntriesInGitOrder_data() {
+			QTest::addColumn<QString>("entryName");
+			QTest::addColumn<QString>("entryId");
+
+			// "dir0" sorts like "dir0/", i.e. after "dir0.txt" and before "dir00"
+			QTest::newRow("dir0-x")   << QString("dir0-x"  ) << QString("a907ec3f431eeb6b1c75799a7e4ba73ca6dc627a");
+			QTest::newRow("dir0.txt") << QString("dir0.txt") << QString("eb697c0d58b8e5fce1855b606a665c4a2ad3a1c7");
+			QTest::newRow("dir0")     << QString("dir0"    ) << QString("5b51924c72272342a7490dd267ed022e90174480");
+			QTest::newRow("dir00")    << QString("dir00"   ) << QString("257cc5642cb1a054f08cc83f2d943e56fd3ebe99");
+		}
+
+		void shouldFindEntriesInGitOrder() {
+			Git::Tree tree = repo->tree(repo->idFor("e94be0a"));
+			QFETCH(QString, entryName);
+			QFETCH(QString, entryId);
+
+			Git::TreeEntry entry;
+			QVERIFY(tree.findEntry(entryName, entry));
+			QCOMPARE(entry.name, entryName);
+			QCOMPARE(entry.sha1String(), entryId);
+		}
+
+		void shouldNotFindMissingEntries() {
+			Git::Tree tree = repo->tree(repo->idFor("e94be0a"));
+			Git::TreeEntry entry;
+
+			QVERIFY(!tree.findEntry("dir", entry));
+			QVERIFY(!tree.findEntry("dir0/", entry));
+			QVERIFY(!tree.findEntry("dir0/file0", entry));
+			QVERIFY(!tree.findEntry("zzz", entry));
+			QVERIFY(!tree.findEntry(QString(), entry));
+		}
+
+		void shouldFindPaths() {
+			Git::Tree tree = repo->tree(repo->idFor("273b4fb"));
+			Git::TreeEntry entry;
+
+			QVERIFY(tree.findPath("dir0/file0", entry));
+			QCOMPARE(entry.name, QString("file0"));
+			QCOMPARE(entry.sha1String(), QString("257cc5642cb1a054f08cc83f2d943e56fd3ebe99"));
+
+			QVERIFY(tree.findPath("dir0", entry));
+			QVERIFY(entry.isTree());
+
+			QVERIFY(!tree.findPath("dir0/none", entry));
+			QVERIFY(!tree.findPath("file1/file0", entry));
+			QVERIFY(!tree.findPath(QString(), entry));
+		}
+
+		void shouldReturnObjectsAtPaths() {
+			Git::Tree tree = repo->tree(repo->idFor("273b4fb"));
+
+			Git::RawObject &object = tree.objectAt("dir0/file0");
+			QVERIFY(object.isBlob());
+			QCOMPARE(object.id().toSha1String(), QString("257cc5642cb1a054f08cc83f2d943e56fd3ebe99"));
+
+			QVERIFY(tree.objectAt("dir0").isTree());
+			QVERIFY(!tree.objectAt("dir0/none").isValid());
+		}
+
+		void shouldResolvePathsInCommits() {
+			Git::Commit commit = repo->commit(repo->idFor("1dbe8f6"));
+			Git::TreeEntry entry;
+
+			QVERIFY(commit.findPath("file2", entry));
+			QCOMPARE(entry.sha1String(), QString("eb697c0d58b8e5fce1855b606a665c4a2ad3a1c7"));
+			QCOMPARE(commit.objectAt("dir0/file0").id().toSha1String(), QString("257cc5642cb1a054f08cc83f2d943e56fd3ebe99"));
+		}
+
+		void shouldCacheTreeEntries() {
+			const QVector<Git::TreeEntry> entries = repo->treeEntries("5b51924c72272342a7490dd267ed022e90174480");
+
+			QCOMPARE(entries.size(), 1);
+			QCOMPARE(entries[0].name, QString("file0"));
+			QCOMPARE(repo->treeEntries("5b51924c72272342a7490dd267ed022e90174480").constData(), entries.constData());
+
+			QVERIFY(repo->treeEntries("257cc5642cb1a054f08cc83f2d943e56fd3ebe99").isEmpty());
+		}
+
 		void shouldHaveCorrectNumberOfTrees() {
 			Git::Tree tree = repo->tree(repo->idFor("273b4fb"));
 
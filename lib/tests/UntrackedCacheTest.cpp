@@ -0,0 +1,120 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTestBase.h"
+
+#include "Git/Index.h"
+#include "Git/UntrackedCache.h"
+
+
+
+class UntrackedCacheTest : public GitTestBase
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase() {
+			GitTestBase::initTestCase();
+
+			cloneFrom("IgnoreRulesTestRepo");
+		}
+
+
+
+		void shouldBeSharedBetweenRepos() {
+			Git::Repo otherRepo(workingDir);
+
+			QCOMPARE(otherRepo.untrackedCache(), repo->untrackedCache());
+		}
+
+		void shouldOnlyReadChangedDirectories() {
+			backdate();
+			Git::UntrackedCache *cache = repo->untrackedCache();
+			Git::Index index(*repo);
+			QList<QByteArray> untracked;
+
+			cache->scan(*repo, index, &untracked, 0);
+			QCOMPARE(cache->m_readDirectories, 2);
+			QCOMPARE(cache->count(), 2);
+			QCOMPARE(untracked, QList<QByteArray>() << "keep.o" << "new.txt" << "src/important.tmp" << "src/root-only.txt");
+
+			untracked.clear();
+			cache->scan(*repo, index, &untracked, 0);
+			QCOMPARE(cache->m_readDirectories, 0);
+			QCOMPARE(untracked, QList<QByteArray>() << "keep.o" << "new.txt" << "src/important.tmp" << "src/root-only.txt");
+
+			writeToFile("src/another.txt", "another\n");
+
+			untracked.clear();
+			cache->scan(*repo, index, &untracked, 0);
+			QCOMPARE(cache->m_readDirectories, 1);
+			QVERIFY(untracked.contains("src/another.txt"));
+
+			deleteFile("src/another.txt");
+		}
+
+		void shouldLeaveOutFilesAddedToTheIndex() {
+			backdate();
+			Git::UntrackedCache *cache = repo->untrackedCache();
+			QList<QByteArray> untracked;
+
+			cache->scan(*repo, Git::Index(*repo), &untracked, 0);
+			QVERIFY(untracked.contains("new.txt"));
+
+			QProcess::execute("git", gitBasicOpts() << "add" << "new.txt");
+
+			untracked.clear();
+			cache->scan(*repo, Git::Index(*repo), &untracked, 0);
+			QCOMPARE(cache->m_readDirectories, 0);
+			QVERIFY(!untracked.contains("new.txt"));
+		}
+
+		void shouldReadAllDirectoriesIfIgnoreRulesChange() {
+			backdate();
+			Git::UntrackedCache *cache = repo->untrackedCache();
+			Git::Index index(*repo);
+			QList<QByteArray> untracked;
+			QList<QByteArray> ignored;
+
+			cache->scan(*repo, index, &untracked, &ignored);
+			QVERIFY(untracked.contains("src/important.tmp"));
+
+			writeToFile(".gitignore", "*.o\nbuild/\n!keep.o\n/root-only.txt\n*.tmp\n# changed rules\n");
+
+			untracked.clear();
+			ignored.clear();
+			cache->scan(*repo, index, &untracked, &ignored);
+			QCOMPARE(cache->m_readDirectories, 2);
+			QVERIFY(untracked.contains("src/important.tmp")); // re-included by src/.gitignore
+			QCOMPARE(ignored, QList<QByteArray>() << "build/" << "root-only.txt" << "secret.txt" << "src/a.tmp" << "src/generated/" << "src/main.o");
+		}
+
+	private:
+		/**
+		 * Moves the modification times out of the racy window of the scans.
+		 */
+		void backdate() {
+			QStringList paths;
+			paths << workingDir << pathTo(".gitignore") << pathTo("src") << pathTo("src/.gitignore") << pathTo(".git/info/exclude");
+			QProcess::execute("touch", QStringList() << "-d" << "@1300000000" << paths);
+		}
+};
+
+QTEST_KDEMAIN_CORE(UntrackedCacheTest)
+
+#include "UntrackedCacheTest.moc"
@@ -20,12 +20,17 @@
 #include "ui_CommitInfoWidget.h"
 
 #include "Git/Commit.h"
+#include "Git/Repo.h"
+#include "Git/TreeDiff.h"
+
+#include <QtConcurrentRun>
 
 
 
 CommitInfoWidget::CommitInfoWidget(QWidget *parent)
 	: QWidget(parent)
 	, m_commitId()
+	, m_diffLoader(0)
 	, ui(new Ui::CommitInfoWidget)
 {
 	ui->setupUi(this);
@@ -38,12 +43,57 @@ CommitInfoWidget::~CommitInfoWidget()
 
 void CommitInfoWidget::clear()
 {
+	// a diff still being loaded is of no use any more
+	m_diffLoader = 0;
+
 	ui->idLabel->clear();
 	ui->authorLabel->clear();
 	ui->messageLabel->clear();
 	ui->diffView->clear();
 }
 
+void CommitInfoWidget::diffLoaded()
+{
+	QFutureWatcher<QStringList> *loader = static_cast<QFutureWatcher<QStringList>*>(sender());
+	loader->deleteLater();
+
+	// ignore results of stale loads
+	if (loader != m_diffLoader) {
+		return;
+	}
+	m_diffLoader = 0;
+
+	// the view only classifies the lines it shows
+	foreach (const QString &diff, loader->result()) {
+		ui->diffView->appendDiff(diff);
+	}
+}
+
+QStringList CommitInfoWidget::diffsFor(const QString &workingDir, const QString &commitId)
+{
+	// the commit's repo must not be used from another thread
+	Git::Repo repo(workingDir);
+	Git::Commit commit = repo.commit(repo.idFor(commitId));
+
+	// like Commit::diff() the first commit is compared with an empty tree
+	QString parentTreeId;
+	QList<Git::Commit> parents = commit.parents();
+	if (!parents.isEmpty()) {
+		parentTreeId = parents.first().tree().id().toSha1String();
+	}
+
+	Git::TreeDiff treeDiff(repo, parentTreeId, commit.tree().id().toSha1String());
+	treeDiff.detectRenames();
+	treeDiff.setFullIndex(true);
+
+	QStringList diffs;
+	foreach (const Git::TreeChange &change, treeDiff.changes()) {
+		diffs << treeDiff.diffFor(change);
+	}
+
+	return diffs;
+}
+
 void CommitInfoWidget::updateView()
 {
 	Git::Commit commit = m_commitId.object().toCommit();
@@ -55,7 +105,12 @@ void CommitInfoWidget::updateView()
 	ui->idLabel->setText(m_commitId.toSha1String());
 	ui->authorLabel->setText(i18n("%1 %2", commit.author(), commit.authoredAt().toString()));
 	ui->messageLabel->setText(commit.message());
-	ui->diffView->setDiff(commit.diff());
+	ui->diffView->clear();
+
+	// detecting renames reads the changed files, which may take a while
+	m_diffLoader = new QFutureWatcher<QStringList>(this);
+	connect(m_diffLoader, SIGNAL(finished()), this, SLOT(diffLoaded()));
+	m_diffLoader->setFuture(QtConcurrent::run(&CommitInfoWidget::diffsFor, m_commitId.repo().workingDir(), m_commitId.toSha1String()));
 }
 
 void CommitInfoWidget::setCommit(const Git::Commit &commit)
@@ -29,6 +29,9 @@
 
 #include "Git/Id.h"
 
+#include <QFutureWatcher>
+#include <QStringList>
+
 namespace Git {
 	class Commit;
 }
@@ -56,8 +59,18 @@ class CommitInfoWidget : public QWidget
 		void clear();
 		void updateView();
 
+	private slots:
+		void diffLoaded();
+
+	private:
+		/**
+		 * @brief Formats the diffs of the files the commit has changed (in a background thread).
+		 */
+		static QStringList diffsFor(const QString &workingDir, const QString &commitId);
+
 	private:
 		Git::Id m_commitId;
+		QFutureWatcher<QStringList> *m_diffLoader;
 		Ui::CommitInfoWidget *ui;
 };
 
@@ -58,8 +58,8 @@ void CommitWidget::commit()
 	QString message = ui->commitMessageTextEdit->toPlainText();
 	m_repo->commitIndex(message);
 
+	// we will be reloaded once the new status is available
 	clear();
-	reload();
 }
 
 void CommitWidget::enableCommit()
@@ -89,8 +89,10 @@ void CommitWidget::on_commitButton_clicked()
 
 void CommitWidget::on_Repo_indexChanged()
 {
+	// the new status is loaded in the background
+	// we will be reloaded once it is available
 	m_status = 0;
-	enableCommit();
+	ui->commitButton->setEnabled(false);
 }
 
 void CommitWidget::reload()
@@ -117,8 +119,9 @@ void CommitWidget::setRepository(Git::Repo *repo)
 
 	connect(m_repo, SIGNAL(indexChanged()), this, SLOT(on_Repo_indexChanged()));
 
+	// we will be reloaded once the status is available
 	clear();
-	reload();
+	ui->commitButton->setEnabled(false);
 }
 
 #include "CommitWidget.moc"
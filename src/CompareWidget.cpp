@@ -22,9 +22,13 @@
 #include "Git/Commit.h"
 #include "Git/Ref.h"
 #include "Git/Repo.h"
+#include "Git/TreeDiff.h"
 
 #include "GitBranchesModel.h"
 #include "GitHistoryModel.h"
+#include "GitTreeChangesModel.h"
+
+#include <QtConcurrentRun>
 
 
 
@@ -32,7 +36,9 @@ CompareWidget::CompareWidget(QWidget *parent)
 	: QWidget(parent)
 	, m_commitAId()
 	, m_commitBId()
+	, m_changesLoader(0)
 	, m_repo(0)
+	, m_treeDiff(0)
 	, ui(new Ui::CompareWidget)
 {
 	ui->setupUi(this);
@@ -40,14 +46,43 @@ CompareWidget::CompareWidget(QWidget *parent)
 
 CompareWidget::~CompareWidget()
 {
+	delete m_treeDiff;
 	delete ui;
 }
 
+QList<Git::TreeChange> CompareWidget::changesBetween(const QString &workingDir, const QString &oldTreeId, const QString &newTreeId)
+{
+	// the repo of the widget must not be used from another thread
+	Git::Repo repo(workingDir);
+
+	Git::TreeDiff treeDiff(repo, oldTreeId, newTreeId);
+	treeDiff.detectRenames();
+
+	return treeDiff.changes();
+}
+
+void CompareWidget::changesLoaded()
+{
+	QFutureWatcher<QList<Git::TreeChange> > *loader = static_cast<QFutureWatcher<QList<Git::TreeChange> >*>(sender());
+	loader->deleteLater();
+
+	// ignore results of stale comparisons
+	if (loader != m_changesLoader) {
+		return;
+	}
+	m_changesLoader = 0;
+
+	// only list the changed files, their diffs are formatted when they get selected
+	m_treeDiff = new Git::TreeDiff(*m_repo, loader->result());
+	m_changesModel->setChanges(m_treeDiff->changes());
+}
+
 void CompareWidget::loadModels()
 {
 	m_branchesModel = new GitBranchesModel(*m_repo, this);
 	m_historyAModel = new GitHistoryModel(*m_repo, this);
 	m_historyBModel = new GitHistoryModel(*m_repo, this);
+	m_changesModel = new GitTreeChangesModel(this);
 
 	ui->branchAComboBox->setModel(m_branchesModel);
 	ui->branchBComboBox->setModel(m_branchesModel);
@@ -55,6 +90,8 @@ void CompareWidget::loadModels()
 	ui->historyAView->setModel(m_historyAModel);
 	ui->historyBView->setModel(m_historyBModel);
 
+	ui->changesView->setModel(m_changesModel);
+
 	QModelIndex currentHistoryIndex = m_historyAModel->index(0, 0);
 	ui->historyAView->setCurrentIndex(currentHistoryIndex);
 	ui->historyBView->setCurrentIndex(currentHistoryIndex);
@@ -74,6 +111,16 @@ void CompareWidget::on_branchBComboBox_currentIndexChanged(const QString &branch
 	m_historyBModel->setBranch(m_repo->ref(branchName).name());
 }
 
+void CompareWidget::on_changesView_clicked(const QModelIndex &index)
+{
+	const Git::TreeChange *change = m_changesModel->mapToChange(index);
+	if (!change || !m_treeDiff) {
+		return;
+	}
+
+	ui->diffWidget->setDiff(m_treeDiff->diffFor(*change));
+}
+
 void CompareWidget::on_historyAView_clicked(const QModelIndex &index)
 {
 	m_commitAId = m_historyAModel->mapToCommit(index).id();
@@ -112,7 +159,15 @@ void CompareWidget::updateComparison()
 	Git::Commit commitA = m_commitAId.object().toCommit();
 	Git::Commit commitB = m_commitBId.object().toCommit();
 
-	ui->diffWidget->setDiff(m_repo->diff(commitA, commitB));
+	delete m_treeDiff;
+	m_treeDiff = 0;
+	m_changesModel->setChanges(QList<Git::TreeChange>());
+	ui->diffWidget->setDiff(QString());
+
+	// detecting renames reads the changed files, which may take a while
+	m_changesLoader = new QFutureWatcher<QList<Git::TreeChange> >(this);
+	connect(m_changesLoader, SIGNAL(finished()), this, SLOT(changesLoaded()));
+	m_changesLoader->setFuture(QtConcurrent::run(&CompareWidget::changesBetween, m_repo->workingDir(), commitA.tree().id().toSha1String(), commitB.tree().id().toSha1String()));
 }
 
 #include "CompareWidget.moc"
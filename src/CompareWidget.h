@@ -28,6 +28,9 @@
 #include <QWidget>
 
 #include "Git/Id.h"
+#include "Git/TreeDiff.h"
+
+#include <QFutureWatcher>
 
 namespace Git {
 	class Repo;
@@ -39,6 +42,7 @@ namespace Ui {
 
 class GitBranchesModel;
 class GitHistoryModel;
+class GitTreeChangesModel;
 
 class QModelIndex;
 
@@ -58,23 +62,32 @@ class CompareWidget : public QWidget
 		void setRepository(Git::Repo *repo);
 
 	private:
+		/**
+		 * @brief Compares the trees and detects renames (in a background thread).
+		 */
+		static QList<Git::TreeChange> changesBetween(const QString &workingDir, const QString &oldTreeId, const QString &newTreeId);
 		void loadModels();
 		void showCurrentBranch();
 		void updateComparison();
 
 	private slots:
+		void changesLoaded();
 		void on_branchAComboBox_currentIndexChanged(const QString&);
 		void on_branchBComboBox_currentIndexChanged(const QString&);
+		void on_changesView_clicked(const QModelIndex &index);
 		void on_historyAView_clicked(const QModelIndex &index);
 		void on_historyBView_clicked(const QModelIndex &index);
 
 	private:
 		GitBranchesModel *m_branchesModel;
+		QFutureWatcher<QList<Git::TreeChange> > *m_changesLoader;
+		GitTreeChangesModel *m_changesModel;
 		GitHistoryModel *m_historyAModel;
 		GitHistoryModel *m_historyBModel;
 		Git::Id m_commitAId;
 		Git::Id m_commitBId;
 		Git::Repo *m_repo;
+		Git::TreeDiff *m_treeDiff;
 		Ui::CompareWidget *ui;
 };
 
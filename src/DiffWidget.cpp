@@ -18,53 +18,74 @@
 
 #include "DiffWidget.h"
 
+#include "GitDiffModel.h"
+
+#include <KGlobalSettings>
+
+#include <QApplication>
+#include <QClipboard>
+#include <QHeaderView>
+#include <QKeyEvent>
+#include <QtAlgorithms>
+
 DiffWidget::DiffWidget(QWidget *parent)
-	: KTextBrowser(parent)
+	: QTreeView(parent)
+	, m_model(new GitDiffModel(this))
+{
+	setModel(m_model);
+
+	setFont(KGlobalSettings::fixedFont());
+	setHeaderHidden(true);
+	setItemsExpandable(false);
+	setRootIsDecorated(false);
+	setSelectionMode(QAbstractItemView::ExtendedSelection);
+	setTextElideMode(Qt::ElideNone);
+	// all lines have the same height, so the view need not look at the lines outside of the viewport
+	setUniformRowHeights(true);
+
+	connect(m_model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(updateLineWidth()));
+	connect(m_model, SIGNAL(modelReset()), this, SLOT(updateLineWidth()));
+}
+
+void DiffWidget::appendDiff(const QString &diffString)
 {
-	setLineWrapMode(QTextEdit::NoWrap);
+	m_model->appendDiff(diffString);
 }
 
-const QString DiffWidget::format(const QString &unformattedDiff) const
+void DiffWidget::clear()
 {
-	QStringList lines = Qt::escape(unformattedDiff).split("\n");
-
-	for(int i=0; i < lines.size(); ++i) {
-		lines[i] = lines[i].replace(QRegExp("^(diff --git .*)"),   "<div class=\"header\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(index .*)"),        "<div class=\"header info\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(new file .*)"),     "<div class=\"header add\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(deleted file .*)"), "<div class=\"header remove\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(\\+\\+\\+ .*)"),    "<div class=\"header add\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(--- .*)"),          "<div class=\"header remove\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(\\+.*)"),           "<div class=\"add\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(-.*)"),             "<div class=\"remove\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(@@.*)"),            "<div class=\"info\">\\1</div>");
-		lines[i] = lines[i].replace(QRegExp("^(\\.*)"),            "<div class=\"warning\">\\1</div>");
+	m_model->clear();
+}
+
+void DiffWidget::keyPressEvent(QKeyEvent *event)
+{
+	if (event->matches(QKeySequence::Copy)) {
+		// the rows are listed in the order they have been selected
+		QList<int> rows;
+		foreach (const QModelIndex &index, selectionModel()->selectedRows()) {
+			rows << index.row();
+		}
+		qSort(rows);
+
+		QStringList lines;
+		foreach (int row, rows) {
+			lines << m_model->line(row);
+		}
+		QApplication::clipboard()->setText(lines.join("\n"));
+		return;
 	}
 
-	QString fullyFormattedDiff =
-	"<?xml version=\"1.0\" ?>\n"
-	"<html>\n"
-	"<head>\n"
-	"	 <style type=\"text/css\">\n"
-	"	   pre {\n"
-	"      font-family: 'Droid Sans Mono';\n"
-	"    }\n"
-	"    .add { color: #008C00; }\n"
-	"    .header { background-color: #EEEEEE; }\n"
-	"    .info { color: #0057AE; }\n"
-	"    .remove { color: #BF0303; }\n"
-	"    .warning { color: #FFAA00; }\n"
-	"  </style>\n"
-	"</head>\n"
-	"<body>\n"
-	"<pre>%1</pre>\n"
-	"</body>\n"
-	"</html>\n";
-
-	return fullyFormattedDiff.arg(lines.join("\n"));
+	QTreeView::keyPressEvent(event);
 }
 
 void DiffWidget::setDiff(const QString &diffString)
 {
-	setHtml(format(diffString));
+	m_model->clear();
+	m_model->appendDiff(diffString);
+}
+
+void DiffWidget::updateLineWidth()
+{
+	// the font is fixed width, so the longest line tells the width needed without measuring every line
+	setColumnWidth(0, (m_model->maxLineLength() + 1) * fontMetrics().width('x'));
 }
@@ -25,23 +25,44 @@
 #ifndef DIFFWIDGET_H
 #define DIFFWIDGET_H
 
-#include <KTextBrowser>
+#include <QTreeView>
+
+class GitDiffModel;
+
 
 
 /**
  * @brief A widget to show a formatted diff output.
+ *
+ * The lines are shown as rows of a view, so only the visible lines get laid
+ * out and painted, no matter how big the diff is.
  */
-class DiffWidget : public KTextBrowser
+class DiffWidget : public QTreeView
 {
 	Q_OBJECT
 
 	public:
 		explicit DiffWidget(QWidget *parent = 0);
 
+		/**
+		 * @brief Appends more of the diff (e.g. the next file or hunk).
+		 *
+		 * @param diffString Complete lines of the diff.
+		 */
+		void appendDiff(const QString &diffString);
 		void setDiff(const QString &diffString);
 
+	public slots:
+		void clear();
+
+	protected:
+		void keyPressEvent(QKeyEvent *event);
+
+	private slots:
+		void updateLineWidth();
+
 	private:
-		const QString format(const QString &rawDiffString) const;
+		GitDiffModel *m_model;
 };
 
 #endif // DIFFWIDGET_H
@@ -27,6 +27,7 @@
 FileStatusWidget::FileStatusWidget(QWidget *parent)
 		: QWidget(parent)
 		, m_byteArray(0)
+		, m_file(0)
 		, m_repo(0)
 		, ui(new Ui::FileStatusWidget)
 {
@@ -95,6 +96,11 @@ KMimeType::Ptr FileStatusWidget::mimeType()
 	return KMimeType::findByNameAndContent(m_file->path(), byteArray());
 }
 
+const Git::StatusFile* FileStatusWidget::file() const
+{
+	return m_file;
+}
+
 void FileStatusWidget::setFile(const Git::StatusFile &file)
 {
 	m_file = &file;
@@ -111,6 +117,8 @@ void FileStatusWidget::setRepository(Git::Repo *repo)
 	m_repo = repo;
 
 	connect(m_repo, SIGNAL(historyChanged()), this, SLOT(clear()));
+	// the shown file belongs to the status which is replaced when the index changes
+	connect(m_repo, SIGNAL(indexChanged()), this, SLOT(clear()));
 
 	clear();
 }
@@ -130,7 +138,7 @@ void FileStatusWidget::showFileStatus()
 	QString fileInfo;
 	if (!isBinary()) {
 		if (m_file->isUntracked()) {
-			fileInfo = i18n("%1 lines", m_file->blob().split('\n').size());
+			fileInfo = i18n("%1 lines", byteArray().split('\n').size());
 		} else {
 			int insertions = 0;
 			int  deletions = 0;
@@ -52,6 +52,10 @@ class FileStatusWidget : public QWidget
 		explicit FileStatusWidget(QWidget *parent = 0);
 		~FileStatusWidget();
 
+		/**
+		 * @brief Returns the file last set with setFile() or 0.
+		 */
+		const Git::StatusFile* file() const;
 		void setFile(const Git::StatusFile &file);
 
 	public slots:
@@ -23,17 +23,56 @@
 
 #include <KLocalizedString>
 
+#include <QtAlgorithms>
+#include <QtConcurrentRun>
+
+
+
+#define HeadsPrefix  "refs/heads/"
+
 
 
 GitBranchesModel::GitBranchesModel(Git::Repo &repo, QObject *parent)
 	: QAbstractTableModel(parent)
+	, m_branches()
+	, m_loader(0)
 	, m_repo(repo)
 {
-	connect(&m_repo, SIGNAL(headsChanged()), this, SLOT(reset()));
+	// only the changed branches are updated
+	connect(&m_repo, SIGNAL(refAdded(QString,QString)), this, SLOT(refAdded(QString)));
+	connect(&m_repo, SIGNAL(refDeleted(QString,QString)), this, SLOT(refDeleted(QString)));
 
 	loadBranches();
 }
 
+QStringList GitBranchesModel::branchNamesIn(const QString &workingDir)
+{
+	Git::Repo repo(workingDir);
+
+	QStringList names;
+	foreach (const Git::Ref &head, repo.heads()) {
+		names << head.name();
+	}
+
+	return names;
+}
+
+void GitBranchesModel::branchesLoaded()
+{
+	QFutureWatcher<QStringList> *loader = static_cast<QFutureWatcher<QStringList>*>(sender());
+	loader->deleteLater();
+
+	// ignore results of stale loads
+	if (loader != m_loader) {
+		return;
+	}
+	m_loader = 0;
+
+	beginResetModel();
+	m_branches = loader->result();
+	endResetModel();
+}
+
 int GitBranchesModel::columnCount(const QModelIndex &parent) const
 {
 	Q_UNUSED(parent);
@@ -60,7 +99,7 @@ QVariant GitBranchesModel::data(const QModelIndex &index, int role) const
 	QString data;
 	switch (index.column()) {
 	case 0:
-		data = m_branches[index.row()].name();
+		data = m_branches[index.row()];
 		break;
 	}
 
@@ -88,14 +127,49 @@ QVariant GitBranchesModel::headerData(int section, Qt::Orientation orientation,
 
 void GitBranchesModel::loadBranches()
 {
-	m_branches = m_repo.heads();
+	m_loader = new QFutureWatcher<QStringList>(this);
+	connect(m_loader, SIGNAL(finished()), this, SLOT(branchesLoaded()));
+	m_loader->setFuture(QtConcurrent::run(&GitBranchesModel::branchNamesIn, m_repo.workingDir()));
+}
+
+void GitBranchesModel::refAdded(const QString &fullName)
+{
+	if (!fullName.startsWith(HeadsPrefix)) {
+		return;
+	}
+
+	QString name = fullName.mid(QString(HeadsPrefix).size());
+	QStringList::iterator position = qLowerBound(m_branches.begin(), m_branches.end(), name);
+	if (position != m_branches.end() && *position == name) {
+		return;
+	}
+
+	int row = position - m_branches.begin();
+	beginInsertRows(QModelIndex(), row, row);
+	m_branches.insert(row, name);
+	endInsertRows();
+}
+
+void GitBranchesModel::refDeleted(const QString &fullName)
+{
+	if (!fullName.startsWith(HeadsPrefix)) {
+		return;
+	}
+
+	int row = m_branches.indexOf(fullName.mid(QString(HeadsPrefix).size()));
+	if (row < 0) {
+		return;
+	}
+
+	beginRemoveRows(QModelIndex(), row, row);
+	m_branches.removeAt(row);
+	endRemoveRows();
 }
 
 void GitBranchesModel::reset()
 {
-	beginResetModel();
+	// the old branches stay visible until the new ones have been loaded
 	loadBranches();
-	endResetModel();
 }
 
 int GitBranchesModel::rowCount(const QModelIndex &parent) const
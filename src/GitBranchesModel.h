@@ -21,8 +21,7 @@
 
 #include <QAbstractTableModel>
 
-#include "Git/Ref.h"
-
+#include <QFutureWatcher>
 #include <QStringList>
 
 namespace Git {
@@ -47,11 +46,27 @@ class GitBranchesModel : public QAbstractTableModel
 	protected slots:
 		void reset();
 
+	private slots:
+		void branchesLoaded();
+		/** @brief Inserts a row for a newly created branch. */
+		void refAdded(const QString &fullName);
+		/** @brief Removes the row of a deleted branch. */
+		void refDeleted(const QString &fullName);
+
 	private:
 		void loadBranches();
 
+	// static
+		/**
+		 * @brief Lists the names of the branches in the given working dir.
+		 *
+		 * It is run in a background thread and uses its own repo object.
+		 */
+		static QStringList branchNamesIn(const QString &workingDir);
+
 	private:
-		QList<Git::Ref> m_branches;
+		QStringList m_branches;
+		QFutureWatcher<QStringList> *m_loader;
 		Git::Repo &m_repo;
 };
 
@@ -0,0 +1,235 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitDiffModel.h"
+
+#include <QBrush>
+#include <QColor>
+
+/** The number of lines classified at once. */
+static const int LinesPerPage = 1000;
+static const int TabWidth = 8;
+
+
+
+/**
+ * Replaces the tabs in @a line with spaces up to the next tab stop.
+ */
+static QString expandTabs(const QString &line)
+{
+	if (!line.contains('\t')) {
+		return line;
+	}
+
+	QString expanded;
+	foreach (const QChar &c, line) {
+		if (c == '\t') {
+			expanded += QString(TabWidth - expanded.size() % TabWidth, ' ');
+		} else {
+			expanded += c;
+		}
+	}
+
+	return expanded;
+}
+
+
+
+GitDiffModel::GitDiffModel(QObject *parent)
+	: QAbstractListModel(parent)
+	, m_inHeader(false)
+	, m_lines()
+	, m_lineTypes()
+	, m_maxLineLength(0)
+	, m_pendingLines()
+	, m_pendingOffset(0)
+{
+}
+
+void GitDiffModel::appendDiff(const QString &diff)
+{
+	QStringList lines = diff.split('\n');
+	if (diff.endsWith('\n')) {
+		lines.removeLast();
+	}
+
+	m_pendingLines << lines;
+
+	// show the first page as soon as possible
+	if (m_lines.size() < LinesPerPage) {
+		fetchMore(QModelIndex());
+	}
+}
+
+bool GitDiffModel::canFetchMore(const QModelIndex &parent) const
+{
+	if (parent.isValid()) {
+		return false;
+	}
+
+	return m_pendingOffset < m_pendingLines.size();
+}
+
+GitDiffModel::LineType GitDiffModel::classify(const QString &line)
+{
+	if (line.isEmpty()) {
+		return m_inHeader ? InfoHeaderLine : ContextLine;
+	}
+
+	// hunks can contain lines looking like header lines (e.g. removed "-- foo" lines)
+	switch (line[0].unicode()) {
+	case ' ':
+		return ContextLine;
+	case '+':
+		return m_inHeader && line.startsWith("+++ ") ? AddedHeaderLine : AddedLine;
+	case '-':
+		// diffs of single files start with the "---" line
+		if ((m_inHeader || m_lines.isEmpty()) && line.startsWith("--- ")) {
+			m_inHeader = true;
+			return RemovedHeaderLine;
+		}
+		return RemovedLine;
+	case '@':
+		if (line.startsWith("@@")) {
+			m_inHeader = false;
+			return HunkLine;
+		}
+		break;
+	case '\\':
+		return WarningLine;
+	case 'd':
+		if (line.startsWith("diff ")) {
+			m_inHeader = true;
+			return HeaderLine;
+		} else if (m_inHeader && line.startsWith("deleted file")) {
+			return RemovedHeaderLine;
+		}
+		break;
+	case 'n':
+		if (m_inHeader && line.startsWith("new file")) {
+			return AddedHeaderLine;
+		}
+		break;
+	}
+
+	return m_inHeader ? InfoHeaderLine : ContextLine;
+}
+
+void GitDiffModel::clear()
+{
+	beginResetModel();
+	m_inHeader = false;
+	m_lines.clear();
+	m_lineTypes.clear();
+	m_maxLineLength = 0;
+	m_pendingLines.clear();
+	m_pendingOffset = 0;
+	endResetModel();
+}
+
+QVariant GitDiffModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid()) {
+		return QVariant();
+	}
+
+	LineType type = m_lineTypes[index.row()];
+
+	switch (role) {
+	case Qt::DisplayRole:
+		return QVariant(expandTabs(m_lines[index.row()]));
+	case Qt::ForegroundRole:
+		switch (type) {
+		case AddedLine:
+		case AddedHeaderLine:
+			return QVariant(QBrush(QColor("#008C00")));
+		case RemovedLine:
+		case RemovedHeaderLine:
+			return QVariant(QBrush(QColor("#BF0303")));
+		case HunkLine:
+		case InfoHeaderLine:
+			return QVariant(QBrush(QColor("#0057AE")));
+		case WarningLine:
+			return QVariant(QBrush(QColor("#FFAA00")));
+		default:
+			return QVariant();
+		}
+	case Qt::BackgroundRole:
+		switch (type) {
+		case HeaderLine:
+		case AddedHeaderLine:
+		case RemovedHeaderLine:
+		case InfoHeaderLine:
+			return QVariant(QBrush(QColor("#EEEEEE")));
+		default:
+			return QVariant();
+		}
+	default:
+		return QVariant();
+	}
+}
+
+void GitDiffModel::fetchMore(const QModelIndex &parent)
+{
+	if (!canFetchMore(parent)) {
+		return;
+	}
+
+	// erasing from the front would move all the other pending lines every time
+	int end = qMin(m_pendingOffset + LinesPerPage, m_pendingLines.size());
+
+	beginInsertRows(QModelIndex(), m_lines.size(), m_lines.size() + end - m_pendingOffset - 1);
+	for (; m_pendingOffset < end; ++m_pendingOffset) {
+		const QString &line = m_pendingLines[m_pendingOffset];
+		m_lineTypes << classify(line);
+		m_lines << line;
+		m_maxLineLength = qMax(m_maxLineLength, line.size() + line.count('\t') * (TabWidth - 1));
+	}
+	endInsertRows();
+
+	if (m_pendingOffset == m_pendingLines.size()) {
+		m_pendingLines.clear();
+		m_pendingOffset = 0;
+	}
+}
+
+const QString& GitDiffModel::line(int row) const
+{
+	return m_lines[row];
+}
+
+GitDiffModel::LineType GitDiffModel::lineType(int row) const
+{
+	return m_lineTypes[row];
+}
+
+int GitDiffModel::maxLineLength() const
+{
+	return m_maxLineLength;
+}
+
+int GitDiffModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid()) {
+		return 0;
+	}
+
+	return m_lines.size();
+}
+
+#include "GitDiffModel.moc"
@@ -0,0 +1,90 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GITDIFFMODEL_H
+#define GITDIFFMODEL_H
+
+#include <QAbstractListModel>
+
+#include <QStringList>
+#include <QVector>
+
+
+
+/**
+ * @brief Holds the lines of a diff for DiffWidget.
+ *
+ * Every line is classified once by its first character. Lines that are
+ * appended are only classified when the view fetches them, a page at a
+ * time.
+ */
+class GitDiffModel : public QAbstractListModel
+{
+	Q_OBJECT
+
+	public:
+		enum LineType {
+			ContextLine,
+			AddedLine,
+			RemovedLine,
+			HunkLine,
+			HeaderLine,
+			AddedHeaderLine,
+			RemovedHeaderLine,
+			InfoHeaderLine,
+			WarningLine
+		};
+
+		explicit GitDiffModel(QObject *parent = 0);
+
+		/**
+		 * @brief Appends more of the diff (e.g. the next file or hunk).
+		 *
+		 * @param diff Complete lines of the diff.
+		 */
+		void appendDiff(const QString &diff);
+		bool canFetchMore(const QModelIndex &parent) const;
+		void clear();
+		QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+		void fetchMore(const QModelIndex &parent);
+		/**
+		 * @brief Returns the line as it is in the diff (the display role has its tabs expanded).
+		 */
+		const QString& line(int row) const;
+		LineType lineType(int row) const;
+		/**
+		 * @brief Returns the number of characters of the longest fetched line.
+		 */
+		int maxLineLength() const;
+		int rowCount(const QModelIndex &parent = QModelIndex()) const;
+
+	private:
+		LineType classify(const QString &line);
+
+	private:
+		/** Whether the lines being classified belong to a file header */
+		bool m_inHeader;
+		QStringList m_lines;
+		QVector<LineType> m_lineTypes;
+		int m_maxLineLength;
+		/** Lines that have been appended but not yet fetched by the view (from m_pendingOffset on). */
+		QStringList m_pendingLines;
+		int m_pendingOffset;
+};
+
+#endif // GITDIFFMODEL_H
@@ -28,12 +28,31 @@
 
 GitFileStatusModel::GitFileStatusModel(Git::StatusFile::Status fileStatus, Git::Repo *repo, QObject *parent)
 	: QAbstractTableModel(parent)
+	, m_files()
 	, m_fileStatus(fileStatus)
 	, m_repo(repo)
+	, m_rows()
 {
-	connect(m_repo, SIGNAL(indexChanged()), this, SLOT(reset()));
+}
 
-	loadFiles();
+void GitFileStatusModel::addFile(Git::StatusFile *file)
+{
+	if (!file->hasStatus(m_fileStatus)) {
+		return;
+	}
+
+	beginInsertRows(QModelIndex(), m_files.size(), m_files.size());
+	m_files << file;
+	updateRows(m_files.size() - 1);
+	endInsertRows();
+}
+
+void GitFileStatusModel::clear()
+{
+	beginResetModel();
+	m_files.clear();
+	m_rows.clear();
+	endResetModel();
 }
 
 int GitFileStatusModel::columnCount(const QModelIndex &parent) const
@@ -112,17 +131,18 @@ QVariant GitFileStatusModel::headerData(int section, Qt::Orientation orientation
 void GitFileStatusModel::loadFiles()
 {
 	m_files = m_repo->status()->filesByStatus(m_fileStatus);
+	m_rows.clear();
+	updateRows();
 }
 
-QModelIndex GitFileStatusModel::mapToIndex(const Git::StatusFile &file) const
+QModelIndex GitFileStatusModel::mapToIndex(const QString &path) const
 {
-	for (int i=0; i < m_files.size(); ++i) {
-		if (m_files[i]->path() == file.path()) {
-			return index(i, 0);
-		}
+	int row = m_rows.value(path, -1);
+	if (row < 0) {
+		return QModelIndex();
 	}
 
-	return QModelIndex();
+	return index(row, 0);
 }
 
 const Git::StatusFile* GitFileStatusModel::mapToStatusFile(const QModelIndex &index) const
@@ -135,10 +155,31 @@ const Git::StatusFile* GitFileStatusModel::mapToStatusFile(const QModelIndex &in
 }
 
 
+void GitFileStatusModel::removeFile(Git::StatusFile *file)
+{
+	int row = rowOf(file);
+	if (row < 0) {
+		return;
+	}
+
+	beginRemoveRows(QModelIndex(), row, row);
+	m_rows.remove(file->path());
+	m_files.removeAt(row);
+	updateRows(row);
+	endRemoveRows();
+}
+
 void GitFileStatusModel::reset()
 {
+	beginResetModel();
 	loadFiles();
-	QAbstractItemModel::reset();
+	endResetModel();
+
+	// follow (un)staging without reloading everything
+	Git::Status *status = m_repo->status();
+	connect(status, SIGNAL(fileAdded(Git::StatusFile*)), this, SLOT(addFile(Git::StatusFile*)), Qt::UniqueConnection);
+	connect(status, SIGNAL(fileAboutToBeRemoved(Git::StatusFile*)), this, SLOT(removeFile(Git::StatusFile*)), Qt::UniqueConnection);
+	connect(status, SIGNAL(fileChanged(Git::StatusFile*)), this, SLOT(updateFile(Git::StatusFile*)), Qt::UniqueConnection);
 }
 
 int GitFileStatusModel::rowCount(const QModelIndex &parent) const
@@ -148,4 +189,33 @@ int GitFileStatusModel::rowCount(const QModelIndex &parent) const
 	return m_files.size();
 }
 
+int GitFileStatusModel::rowOf(const Git::StatusFile *file) const
+{
+	int row = m_rows.value(file->path(), -1);
+	if (row < 0 || m_files[row] != file) {
+		return -1;
+	}
+
+	return row;
+}
+
+void GitFileStatusModel::updateFile(Git::StatusFile *file)
+{
+	int row = rowOf(file);
+	if (row < 0) {
+		addFile(file);
+	} else if (!file->hasStatus(m_fileStatus)) {
+		removeFile(file);
+	} else {
+		emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+	}
+}
+
+void GitFileStatusModel::updateRows(int from)
+{
+	for (int row = from; row < m_files.size(); ++row) {
+		m_rows.insert(m_files[row]->path(), row);
+	}
+}
+
 #include "GitFileStatusModel.moc"
@@ -30,6 +30,11 @@ class GitFileStatusModel : public QAbstractTableModel
 	Q_OBJECT
 
 	public:
+		/**
+		 * @brief Constructs an empty model.
+		 *
+		 * The files will be loaded from the repo's status on reset().
+		 */
 		explicit GitFileStatusModel(Git::StatusFile::Status fileStatus, Git::Repo *repo, QObject *parent = 0);
 
 		int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -37,20 +42,41 @@ class GitFileStatusModel : public QAbstractTableModel
 		QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
 		Git::StatusFile::Status fileStatus() const;
 		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
-		QModelIndex mapToIndex(const Git::StatusFile &file) const;
+		QModelIndex mapToIndex(const QString &path) const;
 		const Git::StatusFile* mapToStatusFile(const QModelIndex &index) const;
 		int rowCount(const QModelIndex &parent = QModelIndex()) const;
 
 	public slots:
+		/**
+		 * @brief Removes all files from the model.
+		 *
+		 * Call this before the repo's status is reset, so no dangling files are shown.
+		 */
+		void clear();
 		void reset();
 
+	private slots:
+		void addFile(Git::StatusFile *file);
+		void removeFile(Git::StatusFile *file);
+		void updateFile(Git::StatusFile *file);
+
 	private:
 		void loadFiles();
+		/**
+		 * @brief Returns the row of @a file or -1 if it is not in the model.
+		 */
+		int rowOf(const Git::StatusFile *file) const;
+		/**
+		 * @brief Updates the rows of the files starting with row @a from.
+		 */
+		void updateRows(int from = 0);
 
 	private:
 		QList<Git::StatusFile*> m_files;
 		Git::StatusFile::Status m_fileStatus;
 		Git::Repo *m_repo;
+		/** Maps the paths of the files to their rows */
+		QHash<QString, int> m_rows;
 };
 
 #endif // GITFILESTATUSMODEL_H
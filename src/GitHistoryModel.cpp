@@ -18,6 +18,10 @@
 
 #include "GitHistoryModel.h"
 
+#include "HistoryLoader.h"
+
+#include <Git/ActorTable.h>
+#include <Git/Id.h>
 #include <Git/Ref.h>
 #include <Git/Repo.h>
 
@@ -26,19 +30,82 @@
 
 #include <QStringList>
 
+/** The number of commits loaded at once. */
+static const int CommitsPerPage = 100;
+
 
 
 GitHistoryModel::GitHistoryModel(Git::Repo &repo, QObject *parent)
 	: QAbstractTableModel(parent)
 	, m_branch(repo.currentHead().name())
+	, m_commitCounts()
 	, m_commits()
+	, m_loader(0)
+	, m_pendingIds()
 	, m_repo(repo)
 {
 	connect(&m_repo, SIGNAL(historyChanged()), this, SLOT(reset()));
+	// other branches may change without affecting the shown history
+	connect(&m_repo, SIGNAL(refAdded(QString,QString)), this, SLOT(refChanged(QString)));
+	connect(&m_repo, SIGNAL(refDeleted(QString,QString)), this, SLOT(refChanged(QString)));
+	connect(&m_repo, SIGNAL(refMoved(QString,QString,QString)), this, SLOT(refMoved(QString,QString,QString)));
 
 	setBranch(m_branch);
 }
 
+GitHistoryModel::~GitHistoryModel()
+{
+	cancelLoading();
+
+	// stale loaders have to finish before they get deleted with us
+	foreach (HistoryLoader *loader, findChildren<HistoryLoader*>()) {
+		loader->wait();
+	}
+}
+
+const QString& GitHistoryModel::branch()
+{
+	return m_branch;
+}
+
+void GitHistoryModel::appendCommits(const QStringList &ids, const QStringList &authors)
+{
+	// ignore batches from stale loaders that were already queued
+	if (sender() != m_loader) {
+		return;
+	}
+
+	foreach (const QString &author, authors) {
+		++m_commitCounts[author];
+	}
+	m_pendingIds << ids;
+
+	// show the first page as soon as possible
+	if (m_commits.size() < CommitsPerPage) {
+		fetchMore(QModelIndex());
+	}
+}
+
+bool GitHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+	if (parent.isValid()) {
+		return false;
+	}
+
+	return !m_pendingIds.isEmpty();
+}
+
+void GitHistoryModel::cancelLoading()
+{
+	if (!m_loader) {
+		return;
+	}
+
+	disconnect(m_loader, 0, this, 0);
+	m_loader->cancel();
+	m_loader = 0;
+}
+
 int GitHistoryModel::columnCount(const QModelIndex &parent) const
 {
 	Q_UNUSED(parent);
@@ -70,7 +137,7 @@ QVariant GitHistoryModel::data(const QModelIndex &index, int role) const
 		data = commit.authoredAt().toString();
 		break;
 	case 1: // author
-		data = commit.author();
+		data = m_repo.actors()->nameFor(commit.authorId());
 		break;
 	case 2: // summary
 		data = commit.summary();
@@ -92,11 +159,35 @@ QVariant GitHistoryModel::data(const QModelIndex &index, int role) const
 		} else {
 			return QVariant();
 		}
+	case Qt::ToolTipRole:
+		if (index.column() == 1) { // in author column
+			// the repo only knows about the commits the view has fetched
+			int commitCount = m_commitCounts.value(data);
+			return QVariant(i18np("%2 (1 commit)", "%2 (%1 commits)", commitCount, data));
+		} else {
+			return QVariant();
+		}
 	default:
 		return QVariant();
 	}
 }
 
+void GitHistoryModel::fetchMore(const QModelIndex &parent)
+{
+	if (!canFetchMore(parent)) {
+		return;
+	}
+
+	QStringList ids = m_pendingIds.mid(0, CommitsPerPage);
+	m_pendingIds.erase(m_pendingIds.begin(), m_pendingIds.begin() + ids.size());
+
+	beginInsertRows(QModelIndex(), m_commits.size(), m_commits.size() + ids.size() - 1);
+	foreach (const QString &id, ids) {
+		m_commits << m_repo.commit(m_repo.idFor(id));
+	}
+	endInsertRows();
+}
+
 QVariant GitHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
 	if (section > columnCount() || orientation != Qt::Horizontal) {
@@ -113,8 +204,18 @@ QVariant GitHistoryModel::headerData(int section, Qt::Orientation orientation, i
 
 void GitHistoryModel::loadCommits()
 {
-	m_commits = m_repo.commits(m_branch);
-	/** @todo change to m_repo.commits(m_branch, Git::NoLimit); */
+	cancelLoading();
+
+	m_commitCounts.clear();
+	m_commits.clear();
+	m_pendingIds.clear();
+
+	m_loader = new HistoryLoader(m_repo.workingDir(), m_branch, this);
+	connect(m_loader, SIGNAL(commitsLoaded(QStringList,QStringList)), this, SLOT(appendCommits(QStringList,QStringList)));
+	connect(m_loader, SIGNAL(finished()), m_loader, SLOT(deleteLater()));
+
+	// the view fetches further pages through fetchMore() as they arrive
+	m_loader->start();
 }
 
 Git::Commit GitHistoryModel::mapToCommit(const QModelIndex &index) const
@@ -126,6 +227,38 @@ Git::Commit GitHistoryModel::mapToCommit(const QModelIndex &index) const
 	return m_commits[index.row()];
 }
 
+void GitHistoryModel::refChanged(const QString &fullName)
+{
+	if (fullName != m_branch && fullName != Git::Ref::fullNameFor(m_branch, m_repo)) {
+		return;
+	}
+
+	reset();
+}
+
+void GitHistoryModel::refMoved(const QString &fullName, const QString &oldId, const QString &newId)
+{
+	if (fullName != m_branch && fullName != Git::Ref::fullNameFor(m_branch, m_repo)) {
+		return;
+	}
+
+	// a new commit on top of the shown one only adds a row
+	Git::Id tipId = m_repo.idFor(newId);
+	if (tipId.isValid() && !m_commits.isEmpty() && m_commits.first().id().toSha1String() == oldId) {
+		Git::Commit tip = m_repo.commit(tipId);
+		QList<Git::Commit> parents = tip.parents();
+		if (parents.size() == 1 && parents.first().id().toSha1String() == oldId) {
+			beginInsertRows(QModelIndex(), 0, 0);
+			++m_commitCounts[tip.author()];
+			m_commits.prepend(tip);
+			endInsertRows();
+			return;
+		}
+	}
+
+	reset();
+}
+
 void GitHistoryModel::reset()
 {
 	beginResetModel();
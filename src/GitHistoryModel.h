@@ -23,11 +23,17 @@
 
 #include "Git/Commit.h"
 
+#include <QHash>
+#include <QPointer>
+#include <QStringList>
+
 namespace Git {
 	class Commit;
 	class Repo;
 }
 
+class HistoryLoader;
+
 
 class GitHistoryModel : public QAbstractTableModel
 {
@@ -35,11 +41,14 @@ class GitHistoryModel : public QAbstractTableModel
 
 	public:
 		explicit GitHistoryModel(Git::Repo &repo, QObject *parent = 0);
+		~GitHistoryModel();
 
 		const QString& branch();
+		bool canFetchMore(const QModelIndex &parent) const;
 		int columnCount(const QModelIndex &parent = QModelIndex()) const;
 		const QString& columnName(int column) const;
 		QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+		void fetchMore(const QModelIndex &parent);
 		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
 		Git::Commit mapToCommit(const QModelIndex &index) const;
 		int rowCount(const QModelIndex &parent = QModelIndex()) const;
@@ -50,12 +59,25 @@ class GitHistoryModel : public QAbstractTableModel
 	protected slots:
 		void reset();
 
+	private slots:
+		void appendCommits(const QStringList &ids, const QStringList &authors);
+		/** @brief Reloads the commits if the shown branch has changed. */
+		void refChanged(const QString &fullName);
+		/** @brief Adds the new commit if the shown branch has moved on by one, otherwise reloads. */
+		void refMoved(const QString &fullName, const QString &oldId, const QString &newId);
+
 	private:
+		void cancelLoading();
 		void loadCommits();
 
 	private:
 		QString m_branch;
+		/** The number of commits per author on the branch, as far as it has been loaded. */
+		QHash<QString, int> m_commitCounts;
 		QList<Git::Commit> m_commits;
+		QPointer<HistoryLoader> m_loader;
+		/** Ids of commits that have been loaded but not yet fetched by the view. */
+		QStringList m_pendingIds;
 		Git::Repo &m_repo;
 };
 
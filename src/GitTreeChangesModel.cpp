@@ -0,0 +1,111 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GitTreeChangesModel.h"
+
+#include <KIcon>
+#include <KLocalizedString>
+
+
+
+GitTreeChangesModel::GitTreeChangesModel(QObject *parent)
+	: QAbstractTableModel(parent)
+	, m_changes()
+{
+}
+
+int GitTreeChangesModel::columnCount(const QModelIndex &parent) const
+{
+	Q_UNUSED(parent);
+
+	return 1;
+}
+
+QVariant GitTreeChangesModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid()) {
+		return QVariant();
+	}
+
+	const Git::TreeChange *change = mapToChange(index);
+
+	switch (role) {
+	case Qt::DisplayRole:
+		switch (change->type()) {
+		case Git::TreeChange::Renamed:
+			return QVariant(i18n("%1 (renamed from %2)", change->path, change->oldPath));
+		case Git::TreeChange::Copied:
+			return QVariant(i18n("%1 (copied from %2)", change->path, change->oldPath));
+		default:
+			return QVariant(change->path);
+		}
+	case Qt::DecorationRole: // Icon
+		switch (change->type()) {
+		case Git::TreeChange::Added:
+			return QVariant(KIcon("git-file-added"));
+		case Git::TreeChange::Deleted:
+			return QVariant(KIcon("git-file-deleted"));
+		case Git::TreeChange::Renamed:
+		case Git::TreeChange::Copied:
+			return QVariant(KIcon("git-file-moved"));
+		default:
+			return QVariant(KIcon("git-file-modified"));
+		}
+	default:
+		return QVariant();
+	}
+}
+
+QVariant GitTreeChangesModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (section > columnCount() || orientation != Qt::Horizontal) {
+		return QVariant();
+	}
+
+	switch (role) {
+	case Qt::DisplayRole:
+		return QVariant(i18n("Changed Files"));
+	default:
+		return QVariant();
+	}
+}
+
+const Git::TreeChange* GitTreeChangesModel::mapToChange(const QModelIndex &index) const
+{
+	if (!index.isValid()) {
+		return 0;
+	}
+
+	return &m_changes[index.row()];
+}
+
+int GitTreeChangesModel::rowCount(const QModelIndex &parent) const
+{
+	Q_UNUSED(parent);
+
+	return m_changes.size();
+}
+
+void GitTreeChangesModel::setChanges(const QList<Git::TreeChange> &changes)
+{
+	beginResetModel();
+	m_changes = changes;
+	endResetModel();
+}
+
+#include "GitTreeChangesModel.moc"
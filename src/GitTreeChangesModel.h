@@ -0,0 +1,51 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GITTREECHANGESMODEL_H
+#define GITTREECHANGESMODEL_H
+
+#include <QAbstractTableModel>
+
+#include "Git/TreeDiff.h"
+
+
+
+/**
+ * @brief Lists the files that differ between two trees.
+ *
+ * Only the paths are shown, so even very large comparisons can be listed quickly.
+ */
+class GitTreeChangesModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+	public:
+		explicit GitTreeChangesModel(QObject *parent = 0);
+
+		int columnCount(const QModelIndex &parent = QModelIndex()) const;
+		QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+		const Git::TreeChange* mapToChange(const QModelIndex &index) const;
+		int rowCount(const QModelIndex &parent = QModelIndex()) const;
+		void setChanges(const QList<Git::TreeChange> &changes);
+
+	private:
+		QList<Git::TreeChange> m_changes;
+};
+
+#endif // GITTREECHANGESMODEL_H
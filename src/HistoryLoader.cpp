@@ -0,0 +1,63 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "HistoryLoader.h"
+
+#include "Git/Commit.h"
+#include "Git/Ref.h"
+#include "Git/Repo.h"
+#include "Git/RevisionWalker.h"
+
+/** The number of commits reported at once. */
+static const int CommitsPerBatch = 500;
+
+
+
+HistoryLoader::HistoryLoader(const QString &workingDir, const QString &branch, QObject *parent)
+	: QThread(parent)
+	, m_branch(branch)
+	, m_cancelled(0)
+	, m_workingDir(workingDir)
+{
+}
+
+
+
+void HistoryLoader::cancel()
+{
+	m_cancelled.fetchAndStoreOrdered(1);
+}
+
+void HistoryLoader::run()
+{
+	Git::Repo repo(m_workingDir);
+	Git::RevisionWalker walker(repo.ref(m_branch));
+
+	while (!walker.atEnd() && m_cancelled == 0) {
+		QStringList ids;
+		QStringList authors;
+		foreach (Git::Commit commit, walker.next(CommitsPerBatch)) {
+			ids << commit.id().toSha1String();
+			authors << commit.author();
+		}
+
+		emit commitsLoaded(ids, authors);
+	}
+}
+
+#include "HistoryLoader.moc"
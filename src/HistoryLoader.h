@@ -0,0 +1,76 @@
+/*
+	Cocoon - A GUI for Git.
+	Copyright (C) 2009-2011  Riyad Preukschas <riyad@informatik.uni-bremen.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file
+ * @author Riyad Preukschas <riyad@informatik.uni-bremen.de>
+ * @brief Loads the history of a branch in the background.
+ */
+
+#ifndef HISTORYLOADER_H
+#define HISTORYLOADER_H
+
+#include <QThread>
+
+#include <QAtomicInt>
+#include <QStringList>
+
+
+
+/**
+ * @brief Loads the history of a branch in the background.
+ *
+ * It walks the history in its own thread using a private repo object for
+ * the same working directory and reports the commit ids in batches, newest
+ * first. Git objects are not shared between threads, so the receiver has to
+ * look the commits up in its own repo. The authors are reported along with
+ * them, so the receiver can count the commits of the whole branch without
+ * loading them.
+ *
+ * A stale load can be stopped with cancel(). It will finish after the
+ * current batch.
+ */
+class HistoryLoader : public QThread
+{
+	Q_OBJECT
+
+	public:
+		explicit HistoryLoader(const QString &workingDir, const QString &branch, QObject *parent = 0);
+
+	public slots:
+		void cancel();
+
+	signals:
+		/**
+		 * @brief Is emitted for every batch of commits that has been walked.
+		 *
+		 * @param ids The SHA1s of the commits in history order.
+		 * @param authors The authors of the commits in the same order.
+		 */
+		void commitsLoaded(const QStringList &ids, const QStringList &authors);
+
+	protected:
+		void run();
+
+	private:
+		QString m_branch;
+		QAtomicInt m_cancelled;
+		QString m_workingDir;
+};
+
+#endif // HISTORYLOADER_H
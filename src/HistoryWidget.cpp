@@ -65,15 +65,17 @@ void HistoryWidget::loadModels()
 	ui->branchComboBox->setModel(m_branchesModel);
 	ui->historyView->setModel(m_historyModel);
 
-	QModelIndex currentHistoryIndex = m_historyModel->index(0, 0);
-	ui->historyView->setCurrentIndex(currentHistoryIndex);
-	on_historyView_clicked(currentHistoryIndex);
-
-	showCurrentBranch();
+	// both models are loaded in the background
+	connect(m_branchesModel, SIGNAL(modelReset()), this, SLOT(showCurrentBranch()));
+	connect(m_historyModel, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(selectFirstCommit()));
 }
 
 void HistoryWidget::on_branchComboBox_currentIndexChanged(const QString &branchName)
 {
+	if (!m_historyModel || branchName.isEmpty() || branchName == m_historyModel->branch()) {
+		return;
+	}
+
 	m_historyModel->setBranch(branchName);
 }
 
@@ -82,6 +84,17 @@ void HistoryWidget::on_historyView_clicked(const QModelIndex &index)
 	ui->commitWidget->setCommit(m_historyModel->mapToCommit(index));
 }
 
+void HistoryWidget::selectFirstCommit()
+{
+	if (ui->historyView->currentIndex().isValid()) {
+		return;
+	}
+
+	QModelIndex currentHistoryIndex = m_historyModel->index(0, 0);
+	ui->historyView->setCurrentIndex(currentHistoryIndex);
+	on_historyView_clicked(currentHistoryIndex);
+}
+
 void HistoryWidget::setRepository(Git::Repo *repo)
 {
 	clear();
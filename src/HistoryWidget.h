@@ -59,11 +59,12 @@ class HistoryWidget : public QWidget
 	private:
 		void clear();
 		void loadModels();
-		void showCurrentBranch();
 
 	private slots:
 		void on_branchComboBox_currentIndexChanged(const QString&);
 		void on_historyView_clicked(const QModelIndex &index);
+		void selectFirstCommit();
+		void showCurrentBranch();
 
 	private:
 		GitBranchesModel *m_branchesModel;
@@ -27,15 +27,20 @@
 
 #include "GitFileStatusModel.h"
 
+#include <QCoreApplication>
 #include <QSortFilterProxyModel>
 #include <QMenu>
 #include <QModelIndex>
+#include <QtConcurrentRun>
 
 
 
 StageWidget::StageWidget(QWidget *parent)
 	: QWidget(parent)
+	, m_fileToSelect()
+	, m_fileToSelectStaged(false)
 	, m_repo(0)
+	, m_statusLoader(0)
 	, ui(new Ui::StageWidget)
 {
 	ui->setupUi(this);
@@ -74,6 +79,21 @@ void StageWidget::loadModels()
 
 	ui->fileStatusWidget->setRepository(m_repo);
 	ui->commitWidget->setRepository(m_repo);
+
+	connect(m_repo, SIGNAL(indexChanged()), this, SLOT(reloadStatus()), Qt::UniqueConnection);
+	connect(m_repo, SIGNAL(statusUpdated()), this, SLOT(statusUpdated()), Qt::UniqueConnection);
+	reloadStatus();
+}
+
+Git::Status* StageWidget::loadStatus(const QString &workingDir)
+{
+	Git::Repo repo(workingDir);
+
+	Git::Status *status = repo.status();
+	status->setParent(0);
+	status->moveToThread(QCoreApplication::instance()->thread());
+
+	return status;
 }
 
 void StageWidget::on_stagedChangesView_clicked(const QModelIndex &index)
@@ -116,15 +136,32 @@ void StageWidget::on_unstagedChangesView_doubleClicked(const QModelIndex &index)
 
 void StageWidget::reload()
 {
-	m_stagedFilesModel->reset();
-	m_unstagedFilesModel->reset();
 	ui->commitWidget->clear();
+	reloadStatus();
+}
+
+void StageWidget::reloadStatus()
+{
+	// the files of the old status will be gone
+	m_stagedFilesModel->clear();
+	m_unstagedFilesModel->clear();
 	ui->fileStatusWidget->clear();
+
+	m_statusLoader = new QFutureWatcher<Git::Status*>(this);
+	connect(m_statusLoader, SIGNAL(finished()), this, SLOT(statusLoaded()));
+	m_statusLoader->setFuture(QtConcurrent::run(&StageWidget::loadStatus, m_repo->workingDir()));
+}
+
+void StageWidget::selectFileAfterReload(const QString &path, bool staged)
+{
+	m_fileToSelect = path;
+	m_fileToSelectStaged = staged;
 }
 
 void StageWidget::setRepository(Git::Repo *repo)
 {
 	m_repo = repo;
+	m_fileToSelect.clear();
 	loadModels();
 }
 
@@ -143,33 +180,90 @@ void StageWidget::stageFile()
 	if (!indexes.isEmpty()) {
 		QModelIndex index = indexes.first();
 		const Git::StatusFile *statusFile = m_unstagedFilesModel->mapToStatusFile(m_unstagedFilesProxyModel->mapToSource(index));
-		m_repo->stageFiles(QStringList() << statusFile->path());
+		QString path = statusFile->path();
 
 		// set selection on staged file
-		QModelIndex newIndex = m_stagedFilesProxyModel->mapFromSource(m_stagedFilesModel->mapToIndex(*statusFile));
-		ui->stagedChangesView->setCurrentIndex(newIndex);
+		selectFileAfterReload(path, true);
+		m_repo->stageFiles(QStringList() << path);
+	}
+}
 
-		// update file status view
-		const Git::StatusFile *newStatusFile = m_stagedFilesModel->mapToStatusFile(m_stagedFilesProxyModel->mapToSource(newIndex));
-		ui->fileStatusWidget->setFile(*newStatusFile);
+void StageWidget::statusFileAboutToBeRemoved(Git::StatusFile *file)
+{
+	if (ui->fileStatusWidget->file() == file) {
+		ui->fileStatusWidget->clear();
 	}
 }
 
+void StageWidget::statusLoaded()
+{
+	QFutureWatcher<Git::Status*> *loader = static_cast<QFutureWatcher<Git::Status*>*>(sender());
+	loader->deleteLater();
+
+	// results of stale loads are of no use
+	if (loader != m_statusLoader) {
+		delete loader->result();
+		return;
+	}
+	m_statusLoader = 0;
+
+	m_repo->setStatus(loader->result());
+	connect(m_repo->status(), SIGNAL(fileAboutToBeRemoved(Git::StatusFile*)), this, SLOT(statusFileAboutToBeRemoved(Git::StatusFile*)));
+	m_stagedFilesModel->reset();
+	m_unstagedFilesModel->reset();
+	ui->commitWidget->reload();
+
+	selectPendingFile();
+}
+
+void StageWidget::statusUpdated()
+{
+	// a status still being loaded may have missed the change
+	if (m_statusLoader) {
+		reloadStatus();
+		return;
+	}
+
+	// the models have followed the changes already
+	ui->commitWidget->reload();
+	selectPendingFile();
+}
+
+void StageWidget::selectPendingFile()
+{
+	if (m_fileToSelect.isEmpty()) {
+		return;
+	}
+
+	GitFileStatusModel *model = m_fileToSelectStaged ? m_stagedFilesModel : m_unstagedFilesModel;
+	QSortFilterProxyModel *proxyModel = m_fileToSelectStaged ? m_stagedFilesProxyModel : m_unstagedFilesProxyModel;
+	QTreeView *view = m_fileToSelectStaged ? ui->stagedChangesView : ui->unstagedChangesView;
+
+	QModelIndex sourceIndex = model->mapToIndex(m_fileToSelect);
+	m_fileToSelect.clear();
+
+	// the file may be gone in the mean time
+	if (!sourceIndex.isValid()) {
+		return;
+	}
+
+	view->setCurrentIndex(proxyModel->mapFromSource(sourceIndex));
+
+	// update file status view
+	ui->fileStatusWidget->setFile(*model->mapToStatusFile(sourceIndex));
+}
+
 void StageWidget::unstageFile()
 {
 	QModelIndexList indexes = ui->stagedChangesView->selectionModel()->selectedIndexes();
 	if (!indexes.isEmpty()) {
 		QModelIndex index = indexes.first();
 		const Git::StatusFile *statusFile = m_stagedFilesModel->mapToStatusFile(m_stagedFilesProxyModel->mapToSource(index));
-		m_repo->unstageFiles(QStringList() << statusFile->path());
+		QString path = statusFile->path();
 
 		// set selection on unstaged file
-		QModelIndex newIndex = m_unstagedFilesProxyModel->mapFromSource(m_unstagedFilesModel->mapToIndex(*statusFile));
-		ui->unstagedChangesView->setCurrentIndex(newIndex);
-
-		// update file status view
-		const Git::StatusFile *newStatusFile = m_unstagedFilesModel->mapToStatusFile(m_unstagedFilesProxyModel->mapToSource(newIndex));
-		ui->fileStatusWidget->setFile(*newStatusFile);
+		selectFileAfterReload(path, false);
+		m_repo->unstageFiles(QStringList() << path);
 	}
 }
 
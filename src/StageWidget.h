@@ -27,8 +27,12 @@
 
 #include <QWidget>
 
+#include <QFutureWatcher>
+
 namespace Git {
 	class Repo;
+	class Status;
+	class StatusFile;
 }
 
 namespace Ui {
@@ -63,9 +67,30 @@ class StageWidget : public QWidget
 
 	private:
 		void loadModels();
+		/**
+		 * @brief Selects the file with the given path once the status has been loaded.
+		 */
+		void selectFileAfterReload(const QString &path, bool staged);
+		/**
+		 * @brief Selects the file remembered by selectFileAfterReload() if it is there.
+		 */
+		void selectPendingFile();
 		void setupActions();
 
+	// static
+		/**
+		 * @brief Constructs the status of the given working dir.
+		 *
+		 * It is run in a background thread and uses its own repo object.
+		 * The status is moved to the main thread before it is returned.
+		 */
+		static Git::Status* loadStatus(const QString &workingDir);
+
 	private slots:
+		void reloadStatus();
+		void statusFileAboutToBeRemoved(Git::StatusFile *file);
+		void statusLoaded();
+		void statusUpdated();
 		void on_stagedChangesView_clicked(const QModelIndex &index);
 		void on_stagedChangesView_customContextMenuRequested(const QPoint &pos);
 		void on_stagedChangesView_doubleClicked(const QModelIndex &index);
@@ -74,10 +99,13 @@ class StageWidget : public QWidget
 		void on_unstagedChangesView_doubleClicked(const QModelIndex &index);
 
 	private:
+		QString m_fileToSelect;
+		bool m_fileToSelectStaged;
 		Git::Repo *m_repo;
 		GitFileStatusModel    *m_stagedFilesModel;
 		QSortFilterProxyModel *m_stagedFilesProxyModel;
 		QMenu                 *m_stageWidgetContextMenu;
+		QFutureWatcher<Git::Status*> *m_statusLoader;
 		GitFileStatusModel    *m_unstagedFilesModel;
 		QSortFilterProxyModel *m_unstagedFilesProxyModel;
 		QMenu                 *m_unstageWidgetContextMenu;